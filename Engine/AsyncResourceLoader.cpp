@@ -0,0 +1,303 @@
+#include "AsyncResourceLoader.h"
+
+#include "GameManager.h"
+#include "Logger/StaticLogger.h"
+#include "Serializers/OBJ Serializer/ModelLoader.h"
+#include "Serializers/STB_image/ImageLoader.h"
+#include "Utils/JobSystem.h"
+#include "Utils/Profiler.h"
+#include "Utils/Timer.h"
+
+AsyncResourceLoader::AsyncResourceLoader(JobSystem& jobSystem, GameResources& resources)
+	:mJobSystem(jobSystem),
+	mResources(resources),
+	mQueue(std::make_shared<UploadQueue>()),
+	mUploadBudgetNanos(DEFAULT_RESOURCE_UPLOAD_BUDGET_NANOS)
+{
+}
+
+AsyncResourceLoader::~AsyncResourceLoader()
+{
+	// Wait for decode jobs still in flight, then abandon the uploads nobody is left to run.
+	// Every load ends up either counted as finished or queued for upload.
+	UploadQueue& queue = *mQueue;
+	std::unique_lock<std::mutex> lock(queue.Lock);
+	queue.Changed.wait(lock, [&queue]() { return queue.Pending == queue.Uploads.size(); });
+
+	queue.Uploads.clear();
+	queue.Pending = 0;
+}
+
+ResourceFuture<Texture> AsyncResourceLoader::loadTexture(const std::string& name, const std::string& path)
+{
+	Decode<Texture> decode = [path]()
+	{
+		PROFILE_SCOPE("Decode Texture");
+
+		// Shared so the upload step stays copyable.
+		std::shared_ptr<Image> image = std::make_shared<Image>();
+
+		if (!ImageLoader::loadImage(path, *image))
+		{
+			StaticLogger::instance.error("Could not load texture: {string}", path.c_str());
+			return Upload<Texture>();
+		}
+
+		return Upload<Texture>([image](ResourceSize& size)
+		{
+			std::unique_ptr<Texture> texture = std::make_unique<Texture>();
+			texture->loadFromImg(*image);
+
+			// Images are always decoded to four channels.
+			size = ResourceSize(sizeof(Texture), (uint64_t)image->width * image->height * 4);
+			return texture;
+		});
+	};
+
+	return load<Texture>(name, mResources.TextureResources, decode);
+}
+
+ResourceFuture<Mesh> AsyncResourceLoader::loadMesh(const std::string& name, const std::string& path)
+{
+	Decode<Mesh> decode = [path]()
+	{
+		PROFILE_SCOPE("Parse Mesh");
+
+		std::shared_ptr<IndexedModel> model = std::make_shared<IndexedModel>();
+
+		if (!ModelLoader::loadOBJ(path, *model))
+		{
+			StaticLogger::instance.error("Could not load mesh: {string}", path.c_str());
+			return Upload<Mesh>();
+		}
+
+		return Upload<Mesh>([model](ResourceSize& size)
+		{
+			std::unique_ptr<IndexedMesh> mesh = std::make_unique<IndexedMesh>();
+			mesh->loadFromModel(*model);
+
+			uint64_t floats = (uint64_t)model->positionsCount + model->uvsCount + model->normalsCount;
+			size = ResourceSize(sizeof(IndexedMesh), floats * sizeof(float) + (uint64_t)model->indexCount * sizeof(int));
+			return std::unique_ptr<Mesh>(std::move(mesh));
+		});
+	};
+
+	return load<Mesh>(name, mResources.MeshResources, decode);
+}
+
+ResourceFuture<ShaderProgram> AsyncResourceLoader::loadShader(const std::string& name, const std::string& vertexPath,
+	const std::string& fragmentPath, const ShaderFactory& create)
+{
+	Decode<ShaderProgram> decode = [vertexPath, fragmentPath, create]()
+	{
+		PROFILE_SCOPE("Read Shader");
+
+		std::shared_ptr<std::string> vertexSource = std::make_shared<std::string>();
+		std::shared_ptr<std::string> fragmentSource = std::make_shared<std::string>();
+
+		if (!Shader::readSource(vertexPath, *vertexSource) || !Shader::readSource(fragmentPath, *fragmentSource))
+		{
+			StaticLogger::instance.error("Could not load shader: {string}, {string}", vertexPath.c_str(), fragmentPath.c_str());
+			return Upload<ShaderProgram>();
+		}
+
+		return Upload<ShaderProgram>([vertexPath, fragmentPath, vertexSource, fragmentSource, create](ResourceSize& size)
+		{
+			std::unique_ptr<ShaderProgram> program = create();
+
+			if (program == nullptr || !program->loadShaderSources(*vertexSource, *fragmentSource, vertexPath, fragmentPath))
+			{
+				return std::unique_ptr<ShaderProgram>();
+			}
+
+			size = ResourceSize(sizeof(ShaderProgram) + vertexSource->size() + fragmentSource->size(), 0);
+			return program;
+		});
+	};
+
+	return load<ShaderProgram>(name, mResources.ShaderResources, decode);
+}
+
+template<typename T>
+ResourceFuture<T> AsyncResourceLoader::load(const std::string& name, ResourceManager<T>& manager, const Decode<T>& decode)
+{
+	typedef typename ResourceFuture<T>::State State;
+	std::shared_ptr<State> state = std::make_shared<State>(name, manager);
+	std::shared_ptr<UploadQueue> queue = mQueue;
+	ResourceManager<T>* resources = &manager;
+
+	{
+		std::lock_guard<std::mutex> guard(queue->Lock);
+		queue->Pending++;
+	}
+
+	mJobSystem.schedule([state, queue, resources, decode]()
+	{
+		Upload<T> upload = decode();
+
+		if (!upload)
+		{
+			state->Status.store(ResourceStatus::FAILED, std::memory_order_release);
+			finishLoad(*queue);
+			return;
+		}
+
+		queueUpload(*queue, [state, queue, resources, decode, upload]()
+		{
+			ResourceSize size;
+			std::unique_ptr<T> resource = upload(size);
+
+			if (resource == nullptr)
+			{
+				state->Status.store(ResourceStatus::FAILED, std::memory_order_release);
+				return;
+			}
+
+			// Once evicted, the resource is loaded again the same way. The reloader outlives this loader
+			// and the job system it was given, so it asks for the ones current when it runs.
+			typename ResourceManager<T>::Reloader reloader = [resources, decode](const ResourceHandle<T>& handle)
+			{
+				GameManager::getResourceLoader().reload<T>(*resources, handle, decode);
+			};
+
+			ResourceHandle<T> handle = resources->addRegistry(state->Name, std::move(resource), size, reloader);
+
+			if (handle.isNull())
+			{
+				state->Status.store(ResourceStatus::FAILED, std::memory_order_release);
+				return;
+			}
+
+			state->Handle = handle;
+			state->Status.store(ResourceStatus::READY, std::memory_order_release);
+		});
+	});
+
+	return ResourceFuture<T>(state);
+}
+
+template<typename T>
+void AsyncResourceLoader::reload(ResourceManager<T>& manager, const ResourceHandle<T>& handle, const Decode<T>& decode)
+{
+	std::shared_ptr<UploadQueue> queue = mQueue;
+	ResourceManager<T>* resources = &manager;
+
+	{
+		std::lock_guard<std::mutex> guard(queue->Lock);
+		queue->Pending++;
+	}
+
+	mJobSystem.schedule([queue, resources, handle, decode]()
+	{
+		Upload<T> upload = decode();
+
+		if (!upload)
+		{
+			// The resource stays evicted, its handle keeps resolving to null until a later reload succeeds.
+			resources->reloadFailed(handle);
+			finishLoad(*queue);
+			return;
+		}
+
+		queueUpload(*queue, [resources, handle, upload]()
+		{
+			ResourceSize size;
+			std::unique_ptr<T> resource = upload(size);
+
+			if (resource != nullptr)
+			{
+				resources->restore(handle, std::move(resource), size);
+			}
+			else
+			{
+				resources->reloadFailed(handle);
+			}
+		});
+	});
+}
+
+uint32_t AsyncResourceLoader::processUploads(uint64_t budgetNanos)
+{
+	PROFILE_SCOPE("Upload Resources");
+
+	UploadQueue& queue = *mQueue;
+	Timer budget;
+	uint32_t uploads = 0;
+
+	do
+	{
+		std::function<void()> upload;
+
+		{
+			std::lock_guard<std::mutex> guard(queue.Lock);
+
+			if (queue.Uploads.empty())
+			{
+				break;
+			}
+
+			upload = std::move(queue.Uploads.front());
+			queue.Uploads.pop_front();
+		}
+
+		upload();
+		finishLoad(queue);
+		uploads++;
+	} while (budget.nanoseconds() < budgetNanos);
+
+	return uploads;
+}
+
+void AsyncResourceLoader::finishLoading()
+{
+	PROFILE_SCOPE("Finish Loading Resources");
+
+	UploadQueue& queue = *mQueue;
+
+	while (true)
+	{
+		std::function<void()> upload;
+
+		{
+			std::unique_lock<std::mutex> lock(queue.Lock);
+			queue.Changed.wait(lock, [&queue]() { return !queue.Uploads.empty() || queue.Pending == 0; });
+
+			if (queue.Uploads.empty())
+			{
+				return;
+			}
+
+			upload = std::move(queue.Uploads.front());
+			queue.Uploads.pop_front();
+		}
+
+		upload();
+		finishLoad(queue);
+	}
+}
+
+uint32_t AsyncResourceLoader::getPendingCount() const
+{
+	std::lock_guard<std::mutex> guard(mQueue->Lock);
+	return mQueue->Pending;
+}
+
+void AsyncResourceLoader::queueUpload(UploadQueue& queue, std::function<void()> upload)
+{
+	{
+		std::lock_guard<std::mutex> guard(queue.Lock);
+		queue.Uploads.push_back(std::move(upload));
+	}
+
+	queue.Changed.notify_all();
+}
+
+void AsyncResourceLoader::finishLoad(UploadQueue& queue)
+{
+	{
+		std::lock_guard<std::mutex> guard(queue.Lock);
+		queue.Pending--;
+	}
+
+	queue.Changed.notify_all();
+}
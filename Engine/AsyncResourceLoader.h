@@ -0,0 +1,283 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "Render Engine/Mesh.h"
+#include "Render Engine/Shader.h"
+#include "Render Engine/Texture.h"
+#include "ResourceManager.h"
+
+class GameResources;
+class JobSystem;
+
+// Time the render thread spends uploading loaded resources each frame unless set otherwise.
+#define DEFAULT_RESOURCE_UPLOAD_BUDGET_NANOS 2000000
+
+/// <summary>
+/// Where an asynchronously loaded resource is in its life.
+/// </summary>
+enum class ResourceStatus
+{
+	LOADING,
+	READY,
+	FAILED
+};
+
+/// <summary>
+/// A resource that is being loaded in the background.
+/// Resolves once the render thread has uploaded it and added it to the game resources,
+/// after which it can also be looked up by name. Copies share the same load.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+template<typename T>
+class ResourceFuture
+{
+public:
+	/// <summary>
+	/// A future that is not attached to any load and reports it failed.
+	/// </summary>
+	ResourceFuture()
+	{}
+
+	ResourceStatus getStatus() const
+	{
+		if (mState == nullptr)
+		{
+			return ResourceStatus::FAILED;
+		}
+
+		return mState->Status.load(std::memory_order_acquire);
+	}
+
+	bool isReady() const
+	{
+		return getStatus() == ResourceStatus::READY;
+	}
+
+	/// <summary>
+	/// Returns true once the load has either succeeded or failed.
+	/// </summary>
+	/// <returns></returns>
+	bool isDone() const
+	{
+		return getStatus() != ResourceStatus::LOADING;
+	}
+
+	/// <summary>
+	/// Returns the resource, null until it is ready or while it is evicted.
+	/// The game resources own it.
+	/// </summary>
+	/// <returns></returns>
+	T* get() const
+	{
+		return isReady() ? mState->Manager->get(mState->Handle) : nullptr;
+	}
+
+	/// <summary>
+	/// Returns the resource's handle in the game resources, null until it is ready.
+	/// </summary>
+	/// <returns></returns>
+	ResourceHandle<T> getHandle() const
+	{
+		return isReady() ? mState->Handle : ResourceHandle<T>();
+	}
+
+	/// <summary>
+	/// Returns the name the resource is registered under.
+	/// </summary>
+	/// <returns></returns>
+	const std::string& getName() const
+	{
+		static const std::string empty;
+		return mState == nullptr ? empty : mState->Name;
+	}
+
+private:
+	friend class AsyncResourceLoader;
+
+	struct State
+	{
+		State(const std::string& name, ResourceManager<T>& manager)
+			:Name(name),
+			Status(ResourceStatus::LOADING),
+			Manager(&manager)
+		{}
+
+		std::string Name;
+		std::atomic<ResourceStatus> Status;
+		ResourceManager<T>* Manager;
+
+		// Written before the status becomes ready.
+		ResourceHandle<T> Handle;
+	};
+
+	ResourceFuture(const std::shared_ptr<State>& state)
+		:mState(state)
+	{}
+
+	std::shared_ptr<State> mState;
+};
+
+/// <summary>
+/// Loads textures, meshes and shaders without stalling the thread that asks for them.
+/// Files are read, images decoded and OBJ files parsed as jobs on the job system. Only the step that
+/// needs OpenGL is queued for the thread that owns the context, which runs a time-boxed batch of
+/// uploads every frame. Requests may come from any thread.
+/// Everything it loads can be evicted by its resource manager and is reloaded the same way when next asked for,
+/// through GameManager's loader at that time, so evicted resources stay reloadable after this loader is destroyed.
+/// </summary>
+class AsyncResourceLoader
+{
+public:
+	/// <summary>
+	/// Creates a shader program object. It must not load its shaders itself, the loader does that.
+	/// </summary>
+	typedef std::function<std::unique_ptr<ShaderProgram>()> ShaderFactory;
+
+	/// <param name="jobSystem">Runs the decode step.</param>
+	/// <param name="resources">Uploaded resources are registered here by name.</param>
+	AsyncResourceLoader(JobSystem& jobSystem, GameResources& resources);
+
+	/// <summary>
+	/// Blocks until no decode job is running, so the job system must still be alive.
+	/// Loads still waiting for their upload never finish.
+	/// </summary>
+	~AsyncResourceLoader();
+
+	AsyncResourceLoader(const AsyncResourceLoader&) = delete;
+	AsyncResourceLoader& operator=(const AsyncResourceLoader&) = delete;
+
+	/// <summary>
+	/// Decodes an image file in the background and uploads it as a texture.
+	/// </summary>
+	/// <param name="name"></param>
+	/// <param name="path"></param>
+	/// <returns></returns>
+	ResourceFuture<Texture> loadTexture(const std::string& name, const std::string& path);
+
+	/// <summary>
+	/// Parses an OBJ file in the background and uploads it as an indexed mesh.
+	/// </summary>
+	/// <param name="name"></param>
+	/// <param name="path"></param>
+	/// <returns></returns>
+	ResourceFuture<Mesh> loadMesh(const std::string& name, const std::string& path);
+
+	/// <summary>
+	/// Reads both shader sources in the background, then creates the program and compiles it.
+	/// </summary>
+	/// <param name="name"></param>
+	/// <param name="vertexPath"></param>
+	/// <param name="fragmentPath"></param>
+	/// <param name="create">Creates the program object, called on the thread that owns the context.</param>
+	/// <returns></returns>
+	ResourceFuture<ShaderProgram> loadShader(const std::string& name, const std::string& vertexPath,
+		const std::string& fragmentPath, const ShaderFactory& create);
+
+	/// <summary>
+	/// Runs queued uploads on the calling thread until the budget is spent.
+	/// At least one upload runs per call so a large resource cannot be starved.
+	/// The calling thread must own the OpenGL context.
+	/// </summary>
+	/// <param name="budgetNanos"></param>
+	/// <returns>The number of uploads that ran.</returns>
+	uint32_t processUploads(uint64_t budgetNanos);
+
+	/// <summary>
+	/// Runs uploads with the budget set through setUploadBudget.
+	/// Called by the render loop every frame.
+	/// </summary>
+	/// <returns></returns>
+	uint32_t processUploads()
+	{
+		return processUploads(mUploadBudgetNanos);
+	}
+
+	/// <summary>
+	/// Blocks until every requested load has finished, running uploads on the calling thread as they arrive.
+	/// The calling thread must own the OpenGL context. Used at startup, before the render thread exists.
+	/// </summary>
+	void finishLoading();
+
+	/// <summary>
+	/// Returns the number of loads that have not finished yet.
+	/// </summary>
+	/// <returns></returns>
+	uint32_t getPendingCount() const;
+
+	void setUploadBudget(uint64_t budgetNanos)
+	{
+		mUploadBudgetNanos = budgetNanos;
+	}
+
+	uint64_t getUploadBudget() const
+	{
+		return mUploadBudgetNanos;
+	}
+
+private:
+	/// <summary>
+	/// Shared with the decode jobs, so the loader can be destroyed while jobs are still running.
+	/// </summary>
+	struct UploadQueue
+	{
+		UploadQueue()
+			:Pending(0)
+		{}
+
+		std::mutex Lock;
+		std::condition_variable Changed;
+		std::deque<std::function<void()>> Uploads;
+		uint32_t Pending;
+	};
+
+	/// <summary>
+	/// Queues the upload step of a load. Called from a decode job.
+	/// </summary>
+	/// <param name="queue"></param>
+	/// <param name="upload"></param>
+	static void queueUpload(UploadQueue& queue, std::function<void()> upload);
+
+	/// <summary>
+	/// Counts a load as finished. Called once per load, whether it succeeded or not.
+	/// </summary>
+	/// <param name="queue"></param>
+	static void finishLoad(UploadQueue& queue);
+
+	/// <summary>
+	/// The step of a load that needs OpenGL. Creates the resource and reports how much memory it takes up.
+	/// </summary>
+	template<typename T>
+	using Upload = std::function<std::unique_ptr<T>(ResourceSize& size)>;
+
+	/// <summary>
+	/// The step of a load that runs on a worker. Returns the upload step, or an empty function if the load failed.
+	/// Kept by the resource manager to reload the resource after an eviction.
+	/// </summary>
+	template<typename T>
+	using Decode = std::function<Upload<T>()>;
+
+	/// <summary>
+	/// Schedules the decode step and queues the upload step, which registers the resource under its name.
+	/// </summary>
+	template<typename T>
+	ResourceFuture<T> load(const std::string& name, ResourceManager<T>& manager, const Decode<T>& decode);
+
+	/// <summary>
+	/// Loads an evicted resource again on this loader's workers and restores it into its slot.
+	/// </summary>
+	template<typename T>
+	void reload(ResourceManager<T>& manager, const ResourceHandle<T>& handle, const Decode<T>& decode);
+
+	JobSystem& mJobSystem;
+	GameResources& mResources;
+	std::shared_ptr<UploadQueue> mQueue;
+	uint64_t mUploadBudgetNanos;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Component.h"
+#include "Math/AABB.h"
+
+/// <summary>
+/// Gives an entity a box in its own local space so the scene's spatial index can find it.
+/// The index keeps the world space box up to date as the entity's transform changes.
+/// Static entities are expected to stay put and are kept in a tree that is rebuilt when they do move,
+/// everything else goes in a grid that is cheap to update every tick.
+/// </summary>
+class BoundsComponent : public IComponent
+{
+public:
+	BoundsComponent(const AABBf& localBounds = AABBf(Vector3f(-0.5f, -0.5f, -0.5f), Vector3f(0.5f, 0.5f, 0.5f)), bool isStatic = false)
+		:mLocalBounds(localBounds),
+		mStatic(isStatic),
+		mDirty(true)
+	{}
+
+	const AABBf& getLocalBounds() const
+	{
+		return mLocalBounds;
+	}
+
+	void setLocalBounds(const AABBf& bounds)
+	{
+		mLocalBounds = bounds;
+		mDirty = true;
+	}
+
+	bool isStatic() const
+	{
+		return mStatic;
+	}
+
+	void setStatic(bool isStatic)
+	{
+		mStatic = isStatic;
+		mDirty = true;
+	}
+
+private:
+	friend class SpatialIndex;
+
+	AABBf mLocalBounds;
+	bool mStatic;
+
+	// Set when the bounds or static flag change so the index refreshes the entity even if it did not move.
+	bool mDirty;
+};
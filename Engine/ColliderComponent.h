@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Component.h"
+
+// Layer bits every collider collides with unless told otherwise.
+#define COLLISION_LAYER_ALL 0xFFFFFFFF
+
+enum class ColliderShape : uint8_t
+{
+	SPHERE,
+	BOX
+};
+
+/// <summary>
+/// Collision shape of an entity, given in its local space and moved with its transform.
+/// Two colliders are tested when each one's layer is in the other's mask.
+/// Static colliders are never tested against each other.
+/// Continuous spheres are swept from where they were last tick, so fast bullets cannot pass through thin walls.
+/// </summary>
+class ColliderComponent : public IComponent
+{
+public:
+	ColliderComponent()
+		:mShape(ColliderShape::SPHERE),
+		mCenter(0, 0, 0),
+		mHalfExtents(0.5f, 0.5f, 0.5f),
+		mLayer(1),
+		mMask(COLLISION_LAYER_ALL),
+		mStatic(false),
+		mContinuous(false)
+	{}
+
+	static ColliderComponent sphere(float radius, const Vector3f& center = Vector3f(0, 0, 0))
+	{
+		ColliderComponent collider;
+		collider.mShape = ColliderShape::SPHERE;
+		collider.mCenter = center;
+		collider.mHalfExtents = Vector3f(radius, radius, radius);
+		return collider;
+	}
+
+	static ColliderComponent box(const Vector3f& halfExtents, const Vector3f& center = Vector3f(0, 0, 0))
+	{
+		ColliderComponent collider;
+		collider.mShape = ColliderShape::BOX;
+		collider.mCenter = center;
+		collider.mHalfExtents = halfExtents;
+		return collider;
+	}
+
+	ColliderShape getShape() const { return mShape; }
+	const Vector3f& getCenter() const { return mCenter; }
+	const Vector3f& getHalfExtents() const { return mHalfExtents; }
+
+	/// <summary>
+	/// Radius of a sphere collider.
+	/// </summary>
+	float getRadius() const { return mHalfExtents.x; }
+
+	/// <summary>
+	/// Sets the layer bits this collider is on and the layer bits it collides with.
+	/// </summary>
+	/// <param name="layer"></param>
+	/// <param name="mask"></param>
+	void setLayer(uint32_t layer, uint32_t mask = COLLISION_LAYER_ALL)
+	{
+		mLayer = layer;
+		mMask = mask;
+	}
+
+	uint32_t getLayer() const { return mLayer; }
+	uint32_t getMask() const { return mMask; }
+
+	void setStatic(bool isStatic) { mStatic = isStatic; }
+	bool isStatic() const { return mStatic; }
+
+	/// <summary>
+	/// Sweeps the collider along its movement each tick instead of testing where it ended up.
+	/// Only sphere colliders are swept.
+	/// </summary>
+	/// <param name="continuous"></param>
+	void setContinuous(bool continuous) { mContinuous = continuous; }
+	bool isContinuous() const { return mContinuous; }
+
+	bool canCollideWith(const ColliderComponent& other) const
+	{
+		return (mLayer & other.mMask) != 0 && (other.mLayer & mMask) != 0 && !(mStatic && other.mStatic);
+	}
+
+private:
+	ColliderShape mShape;
+	Vector3f mCenter;
+
+	// Radius in every component for spheres.
+	Vector3f mHalfExtents;
+
+	uint32_t mLayer;
+	uint32_t mMask;
+	bool mStatic;
+	bool mContinuous;
+};
@@ -0,0 +1,352 @@
+#include "CollisionWorld.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Entity.h"
+#include "Utils/Profiler.h"
+
+#define INVALID_BODY 0xFFFFFFFF
+
+void CollisionWorld::update(ComponentPool<ColliderComponent>& colliders, const std::vector<Entity*>& entities)
+{
+	mTick++;
+
+	{
+		PROFILE_SCOPE("Collision Gather");
+		gatherBodies(colliders, entities);
+	}
+
+	{
+		PROFILE_SCOPE("Broadphase");
+		findPairs();
+	}
+
+	{
+		PROFILE_SCOPE("Narrowphase");
+		testPairs();
+	}
+}
+
+void CollisionWorld::clear()
+{
+	mBodies.clear();
+	mBodyLookup.clear();
+	mHistory.clear();
+	mSortOrder.clear();
+	mPairs.clear();
+	mContacts.clear();
+	mPairCount = 0;
+}
+
+void CollisionWorld::gatherBodies(ComponentPool<ColliderComponent>& colliders, const std::vector<Entity*>& entities)
+{
+	for (size_t i = 0; i < mBodies.size(); ++i)
+	{
+		mBodyLookup[mBodies[i].Handle.Index] = INVALID_BODY;
+	}
+
+	mBodies.clear();
+
+	if (mBodyLookup.size() < entities.size())
+	{
+		mBodyLookup.resize(entities.size(), INVALID_BODY);
+	}
+
+	size_t count = colliders.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		EntityId id = colliders.getOwner(i);
+		Entity* entity = entities[id];
+
+		if (entity == nullptr)
+		{
+			continue;
+		}
+
+		const ColliderComponent& collider = colliders.at(i);
+		const Matrix44f& matrix = entity->getTransform()->getTransformationMatrix();
+
+		Body body;
+		body.Handle = entity->getHandle();
+		body.Collider = &collider;
+		body.Displacement = Vector3f(0, 0, 0);
+		body.Swept = false;
+		body.Sorted = false;
+
+		if (collider.getShape() == ColliderShape::SPHERE)
+		{
+			const Vector3f& local = collider.getCenter();
+			Vector3f center;
+			center.x = matrix.data[0][0] * local.x + matrix.data[1][0] * local.y + matrix.data[2][0] * local.z + matrix.data[3][0];
+			center.y = matrix.data[0][1] * local.x + matrix.data[1][1] * local.y + matrix.data[2][1] * local.z + matrix.data[3][1];
+			center.z = matrix.data[0][2] * local.x + matrix.data[1][2] * local.y + matrix.data[2][2] * local.z + matrix.data[3][2];
+
+			// Spheres stay spheres, so take the largest scale of the three axes.
+			float scale = 0;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				Vector3f column(matrix.data[axis][0], matrix.data[axis][1], matrix.data[axis][2]);
+				scale = std::max(scale, column * column);
+			}
+
+			body.Sphere = Spheref(center, collider.getRadius() * std::sqrt(scale));
+			body.Bounds = body.Sphere.getBounds();
+
+			if (collider.isContinuous())
+			{
+				if (id >= mHistory.size())
+				{
+					mHistory.resize((size_t)id + 1);
+				}
+
+				SweepHistory& history = mHistory[id];
+
+				// Only sweep from a position this same entity had last tick.
+				if (history.Handle == body.Handle && history.Tick == mTick - 1)
+				{
+					body.Displacement = center - history.Center;
+					body.Swept = body.Displacement * body.Displacement > 0.0f;
+					body.Bounds.merge(Spheref(history.Center, body.Sphere.Radius).getBounds());
+				}
+
+				history.Handle = body.Handle;
+				history.Center = center;
+				history.Tick = mTick;
+			}
+		}
+		else
+		{
+			body.Box = OBBf::fromTransform(AABBf::fromCenter(collider.getCenter(), collider.getHalfExtents()), matrix);
+			body.Bounds = body.Box.getBounds();
+		}
+
+		mBodyLookup[id] = (uint32_t)mBodies.size();
+		mBodies.push_back(body);
+	}
+}
+
+void CollisionWorld::findPairs()
+{
+	mSweep.clear();
+	mPairs.clear();
+
+	// Start from last tick's order so the sort below only fixes up what moved past a neighbour.
+	for (size_t i = 0; i < mSortOrder.size(); ++i)
+	{
+		EntityId id = mSortOrder[i];
+
+		if (id >= mBodyLookup.size() || mBodyLookup[id] == INVALID_BODY)
+		{
+			continue;
+		}
+
+		uint32_t index = mBodyLookup[id];
+		Body& body = mBodies[index];
+
+		if (!body.Sorted)
+		{
+			mSweep.push_back({ body.Bounds.Min.x, body.Bounds.Max.x, index });
+			body.Sorted = true;
+		}
+	}
+
+	for (uint32_t i = 0; i < (uint32_t)mBodies.size(); ++i)
+	{
+		if (!mBodies[i].Sorted)
+		{
+			mSweep.push_back({ mBodies[i].Bounds.Min.x, mBodies[i].Bounds.Max.x, i });
+		}
+	}
+
+	// Insertion sort: close to linear on an almost sorted list.
+	for (size_t i = 1; i < mSweep.size(); ++i)
+	{
+		SweepEntry entry = mSweep[i];
+		size_t j = i;
+
+		while (j > 0 && mSweep[j - 1].Min > entry.Min)
+		{
+			mSweep[j] = mSweep[j - 1];
+			--j;
+		}
+
+		mSweep[j] = entry;
+	}
+
+	mSortOrder.resize(mSweep.size());
+
+	for (size_t i = 0; i < mSweep.size(); ++i)
+	{
+		mSortOrder[i] = mBodies[mSweep[i].Body].Handle.Index;
+	}
+
+	size_t count = mSweep.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		const SweepEntry& entry = mSweep[i];
+		const Body& a = mBodies[entry.Body];
+
+		for (size_t j = i + 1; j < count && mSweep[j].Min <= entry.Max; ++j)
+		{
+			const Body& b = mBodies[mSweep[j].Body];
+
+			if (a.Collider->canCollideWith(*b.Collider) && a.Bounds.intersects(b.Bounds))
+			{
+				mPairs.push_back({ entry.Body, mSweep[j].Body });
+			}
+		}
+	}
+
+	mPairCount = mPairs.size();
+}
+
+void CollisionWorld::testPairs()
+{
+	mContacts.clear();
+	mSpherePairs.clear();
+	mSpherePairBodies.clear();
+	mSphereBoxes.clear();
+	mSphereBoxBodies.clear();
+
+	for (size_t i = 0; i < mPairs.size(); ++i)
+	{
+		const Pair& pair = mPairs[i];
+		const Body& a = mBodies[pair.A];
+		const Body& b = mBodies[pair.B];
+
+		if (a.Swept || b.Swept)
+		{
+			testSwept(pair);
+			continue;
+		}
+
+		bool aSphere = a.Collider->getShape() == ColliderShape::SPHERE;
+		bool bSphere = b.Collider->getShape() == ColliderShape::SPHERE;
+
+		if (aSphere && bSphere)
+		{
+			mSpherePairs.push(a.Sphere, b.Sphere);
+			mSpherePairBodies.push_back(pair);
+		}
+		else if (aSphere)
+		{
+			mSphereBoxes.push(a.Sphere, b.Box);
+			mSphereBoxBodies.push_back(pair);
+		}
+		else if (bSphere)
+		{
+			mSphereBoxes.push(b.Sphere, a.Box);
+			mSphereBoxBodies.push_back({ pair.B, pair.A });
+		}
+		else
+		{
+			Vector3f normal;
+			float depth;
+
+			if (a.Box.intersects(b.Box, normal, depth))
+			{
+				addContact(pair.A, pair.B, normal, b.Box.closestPoint(a.Box.Center), depth);
+			}
+		}
+	}
+
+	BatchCollision::testSpheres(mSpherePairs, mResults);
+
+	for (size_t i = 0; i < mSpherePairBodies.size(); ++i)
+	{
+		if (mResults.Hit[i])
+		{
+			const Pair& pair = mSpherePairBodies[i];
+			const Spheref& sphere = mBodies[pair.A].Sphere;
+			Vector3f normal(mResults.NormalX[i], mResults.NormalY[i], mResults.NormalZ[i]);
+			float depth = mResults.Depth[i];
+
+			addContact(pair.A, pair.B, normal, sphere.Center + normal * (sphere.Radius - depth * 0.5f), depth);
+		}
+	}
+
+	BatchCollision::testSphereBoxes(mSphereBoxes, mResults);
+
+	for (size_t i = 0; i < mSphereBoxBodies.size(); ++i)
+	{
+		if (mResults.Hit[i])
+		{
+			const Pair& pair = mSphereBoxBodies[i];
+			const Spheref& sphere = mBodies[pair.A].Sphere;
+			Vector3f normal(mResults.NormalX[i], mResults.NormalY[i], mResults.NormalZ[i]);
+			float depth = mResults.Depth[i];
+
+			addContact(pair.A, pair.B, normal, sphere.Center + normal * (sphere.Radius - depth), depth);
+		}
+	}
+
+	// The sweep order changes with movement, sort so the list does not.
+	std::sort(mContacts.begin(), mContacts.end(), [](const Contact& a, const Contact& b)
+	{
+		return a.A.Index != b.A.Index ? a.A.Index < b.A.Index : a.B.Index < b.B.Index;
+	});
+}
+
+void CollisionWorld::testSwept(const Pair& pair)
+{
+	uint32_t moverIndex = mBodies[pair.A].Swept ? pair.A : pair.B;
+	uint32_t otherIndex = (moverIndex == pair.A) ? pair.B : pair.A;
+	const Body& mover = mBodies[moverIndex];
+	const Body& other = mBodies[otherIndex];
+
+	Vector3f start = mover.Sphere.Center - mover.Displacement;
+	float time;
+	Vector3f normal;
+
+	if (other.Collider->getShape() == ColliderShape::BOX)
+	{
+		if (!other.Box.sweepSphere(start, mover.Displacement, mover.Sphere.Radius, time, normal))
+		{
+			return;
+		}
+
+		// The box gives the face normal pointing back at the sphere.
+		normal = normal * -1.0f;
+	}
+	else
+	{
+		// Both may be moving, sweep in the other's frame.
+		Vector3f otherStart = other.Sphere.Center - other.Displacement;
+		Vector3f relative = mover.Displacement - other.Displacement;
+
+		if (!Spheref(start, mover.Sphere.Radius).sweep(relative, Spheref(otherStart, other.Sphere.Radius), time))
+		{
+			return;
+		}
+
+		Vector3f offset = (otherStart + other.Displacement * time) - (start + mover.Displacement * time);
+		float length = std::sqrt(offset * offset);
+		normal = (length > 0.0f) ? offset * (1.0f / length) : Vector3f(0, 1, 0);
+	}
+
+	// The swept collider is always A.
+	Contact contact;
+	contact.A = mover.Handle;
+	contact.B = other.Handle;
+	contact.Normal = normal;
+	contact.Point = start + mover.Displacement * time;
+	contact.Depth = 0.0f;
+	contact.Time = time;
+	mContacts.push_back(contact);
+}
+
+void CollisionWorld::addContact(uint32_t a, uint32_t b, const Vector3f& normal, const Vector3f& point, float depth)
+{
+	// Overlaps have no preferred order, put the lower entity id first so the list is stable between ticks.
+	bool swap = mBodies[a].Handle.Index > mBodies[b].Handle.Index;
+
+	Contact contact;
+	contact.A = mBodies[swap ? b : a].Handle;
+	contact.B = mBodies[swap ? a : b].Handle;
+	contact.Normal = swap ? normal * -1.0f : normal;
+	contact.Point = point;
+	contact.Depth = depth;
+	contact.Time = 1.0f;
+	mContacts.push_back(contact);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ColliderComponent.h"
+#include "ComponentStorage.h"
+#include "EntityHandle.h"
+#include "Math/BatchCollision.h"
+
+class Entity;
+
+/// <summary>
+/// Two colliders touching at the end of a tick, or a continuous collider hitting something during it.
+/// </summary>
+struct Contact
+{
+	EntityHandle A;
+	EntityHandle B;
+
+	/// <summary>
+	/// Unit direction from A towards B. Moving A back along it separates them.
+	/// </summary>
+	Vector3f Normal;
+
+	/// <summary>
+	/// Roughly where they touch. For a swept hit, the center of A when it hit.
+	/// </summary>
+	Vector3f Point;
+
+	/// <summary>
+	/// How far they overlap along the normal. 0 for a swept hit.
+	/// </summary>
+	float Depth;
+
+	/// <summary>
+	/// Fraction of the tick at which a swept collider first hit, 1 for overlaps found at the end of the tick.
+	/// </summary>
+	float Time;
+};
+
+/// <summary>
+/// Finds every pair of touching colliders once per tick and hands them out as one list.
+/// The broadphase sorts collider bounds along the x axis and sweeps for overlaps. The order is kept
+/// between ticks, so with little movement the sort is close to linear.
+/// The narrowphase groups candidate pairs by shape and tests sphere pairs and sphere box pairs
+/// in batches with BatchCollision. Box pairs use a separating axis test, and continuous spheres
+/// are swept from last tick's position.
+/// </summary>
+class CollisionWorld
+{
+public:
+	CollisionWorld()
+		:mTick(0),
+		mPairCount(0)
+	{}
+
+	/// <summary>
+	/// Replaces the contact list with this tick's contacts.
+	/// Called by the scene after world transforms have been updated.
+	/// </summary>
+	/// <param name="colliders"></param>
+	/// <param name="entities">Entity lookup table indexed by entity id.</param>
+	void update(ComponentPool<ColliderComponent>& colliders, const std::vector<Entity*>& entities);
+
+	/// <summary>
+	/// Contacts found by the last update, sorted by entity id.
+	/// Overlaps list the lower entity id as A, swept hits list the swept collider as A.
+	/// </summary>
+	/// <returns></returns>
+	const std::vector<Contact>& getContacts() const
+	{
+		return mContacts;
+	}
+
+	/// <summary>
+	/// Number of pairs the broadphase passed to the narrowphase in the last update.
+	/// </summary>
+	size_t getPairCount() const
+	{
+		return mPairCount;
+	}
+
+	void clear();
+
+private:
+	/// <summary>
+	/// A collider placed in the world for this tick.
+	/// </summary>
+	struct Body
+	{
+		EntityHandle Handle;
+		const ColliderComponent* Collider;
+		Spheref Sphere;
+		OBBf Box;
+		AABBf Bounds;
+
+		// Movement of a continuous sphere over this tick. Zero for everything else.
+		Vector3f Displacement;
+		bool Swept;
+		bool Sorted;
+	};
+
+	/// <summary>
+	/// Where a continuous sphere was at the end of a tick.
+	/// </summary>
+	struct SweepHistory
+	{
+		SweepHistory()
+			:Tick(0)
+		{}
+
+		EntityHandle Handle;
+		Vector3f Center;
+		uint64_t Tick;
+	};
+
+	struct SweepEntry
+	{
+		float Min;
+		float Max;
+		uint32_t Body;
+	};
+
+	struct Pair
+	{
+		uint32_t A;
+		uint32_t B;
+	};
+
+	void gatherBodies(ComponentPool<ColliderComponent>& colliders, const std::vector<Entity*>& entities);
+	void findPairs();
+	void testPairs();
+
+	void addContact(uint32_t a, uint32_t b, const Vector3f& normal, const Vector3f& point, float depth);
+
+	/// <summary>
+	/// Sweeps a continuous sphere against another body. Boxes are treated as still.
+	/// </summary>
+	void testSwept(const Pair& pair);
+
+	uint64_t mTick;
+	size_t mPairCount;
+
+	std::vector<Body> mBodies;
+
+	// Body index of each entity id this tick.
+	std::vector<uint32_t> mBodyLookup;
+
+	// Indexed by entity id.
+	std::vector<SweepHistory> mHistory;
+
+	// Entity ids in last tick's sweep order.
+	std::vector<EntityId> mSortOrder;
+
+	std::vector<SweepEntry> mSweep;
+	std::vector<Pair> mPairs;
+
+	SpherePairSoA mSpherePairs;
+	std::vector<Pair> mSpherePairBodies;
+	SphereBoxSoA mSphereBoxes;
+	std::vector<Pair> mSphereBoxBodies;
+	ContactSoA mResults;
+
+	std::vector<Contact> mContacts;
+};
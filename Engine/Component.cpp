@@ -1,16 +1,36 @@
+#include <algorithm>
+
 #include "Component.h"
 #include "Entity.h"
 #include "Scene.h"
 
-TransformComponent::TransformComponent(Vector3f position,
-	Vector3f scale, Quaternionf rotation)
-	:Position(position),
-	Scale(scale),
-	Rotation(rotation)
+TransformState TransformState::interpolate(const TransformState& from, const TransformState& to, float alpha)
 {
+	return TransformState(from.Position + (to.Position - from.Position) * alpha,
+		Quaternionf::slerp(from.Rotation, to.Rotation, alpha),
+		from.Scale + (to.Scale - from.Scale) * alpha);
 }
 
-const Matrix44f& TransformComponent::calculateTransformationMatrix()
+TransformState TransformState::combine(const TransformState& parent, const TransformState& local)
+{
+	Vector3f scaled(parent.Scale.x * local.Position.x,
+		parent.Scale.y * local.Position.y,
+		parent.Scale.z * local.Position.z);
+
+	// Rotate by the parent's rotation: v + 2w(q x v) + 2q x (q x v).
+	Vector3f axis(parent.Rotation.x, parent.Rotation.y, parent.Rotation.z);
+	Vector3f twiceCross = (axis % scaled) * 2.0f;
+	Vector3f rotated = scaled + twiceCross * parent.Rotation.w + axis % twiceCross;
+
+	// Quaternion products compose in the opposite order to the matrices they produce.
+	Quaternionf localRotation(local.Rotation);
+
+	return TransformState(parent.Position + rotated,
+		localRotation * parent.Rotation,
+		Vector3f(parent.Scale.x * local.Scale.x, parent.Scale.y * local.Scale.y, parent.Scale.z * local.Scale.z));
+}
+
+Matrix44f TransformState::toMatrix() const
 {
 	Matrix44f translation;
 	Matrix44f rotation(this->Rotation.toMatrix());
@@ -19,24 +39,129 @@ const Matrix44f& TransformComponent::calculateTransformationMatrix()
 	translation.translate(this->Position);
 	scale.scale(this->Scale);
 
-	mTransformationMatrix = translation * rotation * scale;
+	return translation * rotation * scale;
+}
+
+TransformComponent::TransformComponent(Vector3f position,
+	Vector3f scale, Quaternionf rotation)
+	:mLocal(position, rotation, scale),
+	mWorld(position, rotation, scale),
+	mPreviousState(position, rotation, scale),
+	mParent(nullptr),
+	mOwner(nullptr),
+	mLocalDirty(true),
+	mWorldChanged(false)
+{
+	mTransformationMatrix = mWorld.toMatrix();
+}
+
+TransformComponent::~TransformComponent()
+{
+	setParent(nullptr);
+
+	for (size_t i = 0; i < mChildren.size(); ++i)
+	{
+		mChildren[i]->mParent = nullptr;
+		mChildren[i]->mLocalDirty = true;
+	}
+}
+
+bool TransformComponent::setParent(TransformComponent* parent)
+{
+	if (parent == mParent)
+	{
+		return true;
+	}
+
+	for (TransformComponent* ancestor = parent; ancestor != nullptr; ancestor = ancestor->mParent)
+	{
+		if (ancestor == this)
+		{
+			return false;
+		}
+	}
+
+	if (mParent != nullptr)
+	{
+		std::vector<TransformComponent*>& siblings = mParent->mChildren;
+		siblings.erase(std::remove(siblings.begin(), siblings.end(), this), siblings.end());
+	}
+
+	mParent = parent;
+
+	if (mParent != nullptr)
+	{
+		mParent->mChildren.push_back(this);
+	}
+
+	mLocalDirty = true;
+	return true;
+}
+
+void TransformComponent::computeWorldTransform()
+{
+	mWorld = (mParent != nullptr) ? TransformState::combine(mParent->mWorld, mLocal) : mLocal;
+	mTransformationMatrix = mWorld.toMatrix();
+}
+
+const Matrix44f& TransformComponent::calculateTransformationMatrix()
+{
+	if (mParent != nullptr)
+	{
+		mParent->calculateTransformationMatrix();
+	}
+
+	// Leave the dirty flag for the transform pass so it still reports the move.
+	computeWorldTransform();
 	return mTransformationMatrix;
 }
 
-void TransformComponent::lookAt(const Vector3f& point)
+bool TransformComponent::updateWorldState(bool parentChanged)
 {
-	Vector3f forward(Position - point);
-	forward.normalize();
+	mWorldChanged = mLocalDirty || parentChanged;
 
-	Vector3f right = forward % Vector3f(0, 1, 0);
-	Vector3f up = right % forward;
+	if (mWorldChanged)
+	{
+		mWorld = (mParent != nullptr) ? TransformState::combine(mParent->mWorld, mLocal) : mLocal;
+		mLocalDirty = false;
+	}
+
+	return mWorldChanged;
+}
+
+Matrix44f TransformComponent::calculateInterpolatedTransformationMatrix(float alpha) const
+{
+	return TransformState::interpolate(mPreviousState, mWorld, alpha).toMatrix();
+}
 
-	Rotation.lookRotation(forward, up);
+void TransformComponent::storePreviousState()
+{
+	mPreviousState = mWorld;
+}
+
+Vector3f TransformComponent::getInterpolatedPosition(float alpha) const
+{
+	return mPreviousState.Position + (mWorld.Position - mPreviousState.Position) * alpha;
+}
+
+Quaternionf TransformComponent::getInterpolatedRotation(float alpha) const
+{
+	return Quaternionf::slerp(mPreviousState.Rotation, mWorld.Rotation, alpha);
+}
+
+Vector3f TransformComponent::getInterpolatedScale(float alpha) const
+{
+	return mPreviousState.Scale + (mWorld.Scale - mPreviousState.Scale) * alpha;
+}
+
+void TransformComponent::lookAt(const Vector3f& point)
+{
+	setRotation(getLookAtRotation(point));
 }
 
 Quaternionf TransformComponent::getLookAtRotation(const Vector3f& point)
 {
-	Vector3f forward(Position - point);
+	Vector3f forward(mLocal.Position - point);
 	forward.normalize();
 
 	Vector3f right = forward % Vector3f(0, 1, 0);
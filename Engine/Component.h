@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "Math/Math.h"
 
 class Entity;
@@ -23,9 +24,55 @@ protected:
 private:
 };
 
+/// <summary>
+/// A plain copy of a transform's position, rotation and scale.
+/// Used to hand transforms to the render thread and to blend between update ticks.
+/// </summary>
+struct TransformState
+{
+	TransformState(const Vector3f& position = Vector3f(),
+		const Quaternionf& rotation = Quaternionf(),
+		const Vector3f& scale = Vector3f(1, 1, 1))
+		:Position(position),
+		Rotation(rotation),
+		Scale(scale)
+	{}
+
+	/// <summary>
+	/// Blends two states. Position and scale are lerped, rotation is slerped.
+	/// </summary>
+	/// <param name="from"></param>
+	/// <param name="to"></param>
+	/// <param name="alpha">0 gives from, 1 gives to.</param>
+	/// <returns></returns>
+	static TransformState interpolate(const TransformState& from, const TransformState& to, float alpha);
+
+	/// <summary>
+	/// Places a local state inside its parent's world state.
+	/// Non-uniform parent scale is applied along the child's axes, so shear is not represented.
+	/// </summary>
+	/// <param name="parent"></param>
+	/// <param name="local"></param>
+	/// <returns></returns>
+	static TransformState combine(const TransformState& parent, const TransformState& local);
+
+	/// <summary>
+	/// Builds the translation * rotation * scale matrix for this state.
+	/// </summary>
+	/// <returns></returns>
+	Matrix44f toMatrix() const;
+
+	Vector3f Position;
+	Quaternionf Rotation;
+	Vector3f Scale;
+};
+
 /// <summary>
 /// Contains information about the transform of an entity.
 /// Does not appear on the object as a true component for update optimization.
+/// Position, rotation and scale are relative to the parent transform, if there is one.
+/// The world transform is only recomputed by the scene's transform pass when the local values
+/// or an ancestor have changed, so static entities cost nothing per tick.
 /// </summary>
 class TransformComponent : public IComponent
 {
@@ -34,28 +81,149 @@ public:
 		Vector3f scale = Vector3f(1, 1, 1),
 		Quaternionf rotation = Quaternionf());
 
-	const Matrix44f& getTransformationMatrix()
+	virtual ~TransformComponent();
+
+	const Vector3f& getPosition() const { return mLocal.Position; }
+	const Quaternionf& getRotation() const { return mLocal.Rotation; }
+	const Vector3f& getScale() const { return mLocal.Scale; }
+
+	void setPosition(const Vector3f& position)
+	{
+		mLocal.Position = position;
+		mLocalDirty = true;
+	}
+
+	void setRotation(const Quaternionf& rotation)
+	{
+		mLocal.Rotation = rotation;
+		mLocalDirty = true;
+	}
+
+	void setScale(const Vector3f& scale)
+	{
+		mLocal.Scale = scale;
+		mLocalDirty = true;
+	}
+
+	void translate(const Vector3f& offset)
+	{
+		mLocal.Position += offset;
+		mLocalDirty = true;
+	}
+
+	const TransformState& getLocalState() const
+	{
+		return mLocal;
+	}
+
+	/// <summary>
+	/// Attaches this transform to a parent, or detaches it when parent is nullptr.
+	/// The local values are kept, so the world transform moves with the new parent.
+	/// </summary>
+	/// <param name="parent"></param>
+	/// <returns>False if the parent is a descendant of this transform.</returns>
+	bool setParent(TransformComponent* parent);
+
+	TransformComponent* getParent() const { return mParent; }
+	const std::vector<TransformComponent*>& getChildren() const { return mChildren; }
+	Entity* getOwner() const { return mOwner; }
+
+	/// <summary>
+	/// Returns the world matrix as of the last transform pass.
+	/// </summary>
+	/// <returns></returns>
+	const Matrix44f& getTransformationMatrix() const
 	{
 		return mTransformationMatrix;
 	}
 
+	/// <summary>
+	/// Recomputes the world transform right away from the local values and the parent chain.
+	/// Only needed when the result is wanted before the scene's transform pass has run.
+	/// </summary>
+	/// <returns></returns>
 	const Matrix44f& calculateTransformationMatrix();
 
 	/// <summary>
-	/// Points the transform towards a specific point.
+	/// Called once per tick by the scene's transform pass, parents before children.
+	/// Recomputes the world position, rotation and scale if the local values or the parent changed.
+	/// The scene builds the matrices of every moved transform afterwards in one batch.
+	/// </summary>
+	/// <param name="parentChanged"></param>
+	/// <returns>True if the world transform changed.</returns>
+	bool updateWorldState(bool parentChanged);
+
+	/// <summary>
+	/// True if the world transform changed in the last transform pass.
+	/// </summary>
+	/// <returns></returns>
+	bool hasMoved() const
+	{
+		return mWorldChanged;
+	}
+
+	/// <summary>
+	/// Calculates the world matrix blended between the previous and the current tick.
+	/// </summary>
+	/// <param name="alpha">0 gives the previous tick, 1 gives the current tick.</param>
+	/// <returns></returns>
+	Matrix44f calculateInterpolatedTransformationMatrix(float alpha) const;
+
+	/// <summary>
+	/// Saves the current world transform as the previous tick's state.
+	/// Called by the engine at the start of every update tick.
+	/// </summary>
+	void storePreviousState();
+
+	/// <summary>
+	/// Returns the world position and rotation blended between the previous and current tick.
+	/// </summary>
+	/// <param name="alpha"></param>
+	/// <returns></returns>
+	Vector3f getInterpolatedPosition(float alpha) const;
+	Quaternionf getInterpolatedRotation(float alpha) const;
+	Vector3f getInterpolatedScale(float alpha) const;
+
+	/// <summary>
+	/// Returns the world transform as of the last transform pass, and as of the previous tick.
+	/// </summary>
+	/// <returns></returns>
+	const TransformState& getState() const
+	{
+		return mWorld;
+	}
+
+	const TransformState& getPreviousState() const
+	{
+		return mPreviousState;
+	}
+
+	/// <summary>
+	/// Points the transform towards a specific point in the parent's space.
 	/// </summary>
 	/// <param name="point"></param>
 	void lookAt(const Vector3f& point);
 	
 	Quaternionf getLookAtRotation(const Vector3f& point);
 
-	Vector3f Position;
-	Vector3f Scale;
-	Quaternionf Rotation;
-
 protected:
+	void computeWorldTransform();
+
+	TransformState mLocal;
+	TransformState mWorld;
+	TransformState mPreviousState;
 	Matrix44f mTransformationMatrix;
+
+	TransformComponent* mParent;
+	std::vector<TransformComponent*> mChildren;
+	Entity* mOwner;
+
+	bool mLocalDirty;
+	bool mWorldChanged;
+
 private:
+	friend class Entity;
+	friend class Scene;
 };
 
 /// <summary>
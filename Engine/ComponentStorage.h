@@ -0,0 +1,394 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#include "Component.h"
+#include "EntityHandle.h"
+#include "Logger/StaticLogger.h"
+#include "Utils/Profiler.h"
+
+class Entity;
+class Scene;
+
+/// <summary>
+/// Small integer identifying a component type. Assigned once per type the first time it is used.
+/// </summary>
+typedef uint32_t ComponentTypeId;
+
+/// <summary>
+/// One bit per component type, set when an entity owns a component of that type.
+/// </summary>
+typedef uint64_t ComponentMask;
+
+#define MAX_COMPONENT_TYPES 64
+
+/// <summary>
+/// Hands out a dense id per component type so pools can live in a flat array.
+/// Ids are assigned at run time the first time a type is used, so the MAX_COMPONENT_TYPES limit
+/// cannot be checked by the compiler. Going past it aborts, as the type would not fit in the mask.
+/// </summary>
+class ComponentTypes
+{
+public:
+	template<typename T>
+	static ComponentTypeId getId()
+	{
+		static const ComponentTypeId id = nextId(typeid(T).name());
+		return id;
+	}
+
+	template<typename T>
+	static ComponentMask getMask()
+	{
+		return (ComponentMask)1 << getId<T>();
+	}
+
+private:
+	static ComponentTypeId nextId(const char* typeName)
+	{
+		static std::atomic<ComponentTypeId> counter(0);
+		ComponentTypeId id = counter.fetch_add(1, std::memory_order_relaxed);
+
+		if (id >= MAX_COMPONENT_TYPES)
+		{
+			StaticLogger::instance.critical("Too many component types, {string} does not fit in the component mask", typeName);
+			std::abort();
+		}
+
+		return id;
+	}
+};
+
+/// <summary>
+/// Type erased view of a component pool so the storage can manage pools of any type.
+/// </summary>
+class IComponentPool
+{
+public:
+	IComponentPool(const std::string& name)
+		:mName(name),
+		mProfileName(Profiler::internName(name))
+	{}
+
+	virtual ~IComponentPool() {}
+
+	virtual bool contains(EntityId entity) const = 0;
+	virtual IComponent* getComponent(EntityId entity) = 0;
+	virtual bool remove(EntityId entity) = 0;
+	virtual size_t size() const = 0;
+
+	/// <summary>
+	/// Updates every component in the pool in storage order.
+	/// </summary>
+	/// <param name="scene"></param>
+	/// <param name="entities">Entity lookup table indexed by entity id.</param>
+	virtual void updateAll(Scene* scene, const std::vector<Entity*>& entities) = 0;
+
+	const std::string& getName() const { return mName; }
+
+	void setName(const std::string& name)
+	{
+		mName = name;
+		mProfileName = Profiler::internName(name);
+	}
+
+	/// <summary>
+	/// The name as a string that outlives the pool, for profiler markers.
+	/// </summary>
+	const char* getProfileName() const { return mProfileName; }
+
+protected:
+	std::string mName;
+	const char* mProfileName;
+};
+
+/// <summary>
+/// Sparse set holding every component of one type in a single dense array.
+/// The sparse array maps an entity id to its slot in the dense array, so lookups are two array
+/// indexes and iteration walks contiguous memory. Removal swaps the last component into the gap.
+/// Pointers to components are invalidated whenever a component of the same type is added or removed.
+/// </summary>
+template<typename T>
+class ComponentPool : public IComponentPool
+{
+	static_assert(std::is_base_of<IComponent, T>::value, "Component types must derive from IComponent");
+
+public:
+	ComponentPool(const std::string& name)
+		:IComponentPool(name)
+	{}
+
+	/// <summary>
+	/// Constructs a component for the entity in place.
+	/// Returns nullptr if the entity already has a component of this type.
+	/// </summary>
+	template<typename... Args>
+	T* add(EntityId entity, Args&&... args)
+	{
+		if (contains(entity))
+		{
+			return nullptr;
+		}
+
+		if (entity >= mSparse.size())
+		{
+			mSparse.resize((size_t)entity + 1, INVALID_INDEX);
+		}
+
+		mSparse[entity] = (uint32_t)mDense.size();
+		mDense.emplace_back(std::forward<Args>(args)...);
+		mOwners.push_back(entity);
+
+		return &mDense.back();
+	}
+
+	/// <summary>
+	/// Removes the entity's component by moving the last component into its slot.
+	/// </summary>
+	bool remove(EntityId entity)
+	{
+		if (!contains(entity))
+		{
+			return false;
+		}
+
+		uint32_t index = mSparse[entity];
+		uint32_t last = (uint32_t)mDense.size() - 1;
+
+		if (index != last)
+		{
+			mDense[index] = std::move(mDense[last]);
+			mOwners[index] = mOwners[last];
+			mSparse[mOwners[index]] = index;
+		}
+
+		mDense.pop_back();
+		mOwners.pop_back();
+		mSparse[entity] = INVALID_INDEX;
+
+		return true;
+	}
+
+	T* get(EntityId entity)
+	{
+		if (!contains(entity))
+		{
+			return nullptr;
+		}
+
+		return &mDense[mSparse[entity]];
+	}
+
+	bool contains(EntityId entity) const
+	{
+		return entity < mSparse.size() && mSparse[entity] != INVALID_INDEX;
+	}
+
+	IComponent* getComponent(EntityId entity)
+	{
+		return get(entity);
+	}
+
+	size_t size() const
+	{
+		return mDense.size();
+	}
+
+	/// <summary>
+	/// Dense access for systems. Component i belongs to getOwner(i).
+	/// </summary>
+	T& at(size_t index) { return mDense[index]; }
+	EntityId getOwner(size_t index) const { return mOwners[index]; }
+
+	typename std::vector<T>::iterator begin() { return mDense.begin(); }
+	typename std::vector<T>::iterator end() { return mDense.end(); }
+
+	void updateAll(Scene* scene, const std::vector<Entity*>& entities)
+	{
+		size_t count = mDense.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			mDense[i].update(entities[mOwners[i]], scene);
+		}
+	}
+
+private:
+	static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+	std::vector<T> mDense;
+	std::vector<EntityId> mOwners;
+	std::vector<uint32_t> mSparse;
+};
+
+/// <summary>
+/// Owns one component pool per component type used in a scene.
+/// Pools are indexed by component type id and every entity has a mask of the types it owns,
+/// so checking for a component is a bit test and fetching it is two array indexes.
+/// </summary>
+class ComponentStorage
+{
+public:
+	ComponentStorage() {}
+	~ComponentStorage() {}
+
+	/// <summary>
+	/// Returns the pool for a component type, creating it the first time the type is used.
+	/// Look the pool up once per pass rather than once per entity.
+	/// </summary>
+	template<typename T>
+	ComponentPool<T>& getPool()
+	{
+		ComponentTypeId id = ComponentTypes::getId<T>();
+
+		if (id < mPools.size() && mPools[id] != nullptr)
+		{
+			return *static_cast<ComponentPool<T>*>(mPools[id].get());
+		}
+
+		if (id >= mPools.size())
+		{
+			mPools.resize((size_t)id + 1);
+		}
+
+		mPools[id] = std::make_unique<ComponentPool<T>>(typeid(T).name());
+		mPoolsByName[mPools[id]->getName()] = mPools[id].get();
+		mUpdateOrder.push_back(mPools[id].get());
+
+		return *static_cast<ComponentPool<T>*>(mPools[id].get());
+	}
+
+	template<typename T, typename... Args>
+	T* add(EntityId entity, Args&&... args)
+	{
+		T* component = getPool<T>().add(entity, std::forward<Args>(args)...);
+
+		if (component != nullptr)
+		{
+			getMask(entity) |= ComponentTypes::getMask<T>();
+		}
+
+		return component;
+	}
+
+	/// <summary>
+	/// Returns the entity's component of type T, or nullptr if it has none.
+	/// </summary>
+	template<typename T>
+	T* get(EntityId entity)
+	{
+		if (!has<T>(entity))
+		{
+			return nullptr;
+		}
+
+		return static_cast<ComponentPool<T>*>(mPools[ComponentTypes::getId<T>()].get())->get(entity);
+	}
+
+	template<typename T>
+	bool has(EntityId entity) const
+	{
+		return entity < mMasks.size() && (mMasks[entity] & ComponentTypes::getMask<T>()) != 0;
+	}
+
+	template<typename T>
+	bool remove(EntityId entity)
+	{
+		if (!has<T>(entity))
+		{
+			return false;
+		}
+
+		mMasks[entity] &= ~ComponentTypes::getMask<T>();
+		return mPools[ComponentTypes::getId<T>()]->remove(entity);
+	}
+
+	ComponentMask getComponentMask(EntityId entity) const
+	{
+		return entity < mMasks.size() ? mMasks[entity] : 0;
+	}
+
+	/// <summary>
+	/// Gives a component type a readable name for string based lookups from tools.
+	/// </summary>
+	template<typename T>
+	void registerName(const std::string& name)
+	{
+		ComponentPool<T>& pool = getPool<T>();
+
+		mPoolsByName.erase(pool.getName());
+		pool.setName(name);
+		mPoolsByName[name] = &pool;
+	}
+
+	/// <summary>
+	/// Looks up a component by its registered type name. Slow path intended for tools.
+	/// </summary>
+	IComponent* getComponent(const std::string& name, EntityId entity)
+	{
+		auto found = mPoolsByName.find(name);
+
+		if (found == mPoolsByName.end())
+		{
+			return nullptr;
+		}
+
+		return found->second->getComponent(entity);
+	}
+
+	/// <summary>
+	/// Removes every component owned by the entity.
+	/// </summary>
+	void removeAll(EntityId entity)
+	{
+		ComponentMask mask = getComponentMask(entity);
+
+		for (ComponentTypeId id = 0; mask != 0; ++id, mask >>= 1)
+		{
+			if ((mask & 1) != 0)
+			{
+				mPools[id]->remove(entity);
+			}
+		}
+
+		if (entity < mMasks.size())
+		{
+			mMasks[entity] = 0;
+		}
+	}
+
+	/// <summary>
+	/// Updates every pool, one component type at a time, in the order the types were first used.
+	/// </summary>
+	void updateAll(Scene* scene, const std::vector<Entity*>& entities)
+	{
+		for (size_t i = 0; i < mUpdateOrder.size(); ++i)
+		{
+			PROFILE_SCOPE(mUpdateOrder[i]->getProfileName());
+			mUpdateOrder[i]->updateAll(scene, entities);
+		}
+	}
+
+private:
+	ComponentMask& getMask(EntityId entity)
+	{
+		if (entity >= mMasks.size())
+		{
+			mMasks.resize((size_t)entity + 1, 0);
+		}
+
+		return mMasks[entity];
+	}
+
+	std::vector<std::unique_ptr<IComponentPool>> mPools;
+	std::vector<IComponentPool*> mUpdateOrder;
+	std::vector<ComponentMask> mMasks;
+	std::map<std::string, IComponentPool*> mPoolsByName;
+};
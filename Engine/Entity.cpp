@@ -1,70 +1,149 @@
 #include "Entity.h"
+#include "RenderPacket.h"
+#include "Scene.h"
 #include "Logger/StaticLogger.h"
+#include "Utils/ObjectPool.h"
 
-void Entity::updateComponents(Scene* scene)
+/// <summary>
+/// Stored in the ALLOCATION_HEADER_SIZE bytes in front of every entity.
+/// </summary>
+struct EntityAllocationHeader
 {
-	for (auto i = mComponents.begin(); i != mComponents.end(); ++i)
+	PoolAllocator* Pool;
+};
+
+IComponent* Entity::getComponent(const std::string& name)
+{
+	IComponent* component = nullptr;
+
+	if (mComponentStorage != nullptr)
 	{
-		i->second->update(this, scene);
+		component = mComponentStorage->getComponent(name, mId);
 	}
-}
 
-bool Entity::addComponent(const std::string& name, std::unique_ptr<IComponent> component)
-{
-	if (mComponents.find(name) == mComponents.end())
+	if (component == nullptr)
 	{
-		//component->init(this);
-		mComponents[name] = std::move(component);
-		return true;
+		StaticLogger::instance.error("Could not find component: {string}", name.c_str());
 	}
 
-	StaticLogger::instance.error("Failed to add component: {string}", name.c_str());
+	return component;
+}
 
-	return false;
+Entity::Entity(const std::string& tag)
+	:mTag(TagRegistry::intern(tag)),
+	mTransform(),
+	mId(INVALID_ENTITY_ID),
+	mGeneration(0),
+	mScene(nullptr),
+	mComponentStorage(nullptr),
+	mSceneIndex(0),
+	mTagIndex(0)
+{
+	mTransform.mOwner = this;
 }
 
-IComponent* ObjectWithComponents::getComponent(const std::string& name)
+Entity::~Entity()
 {
-	std::map<std::string, std::unique_ptr<IComponent>>::iterator value =
-		mComponents.find(name);
 
-	if (value == mComponents.end())
+}
+
+void* Entity::operator new(size_t size)
+{
+	unsigned char* memory = static_cast<unsigned char*>(::operator new(size + ALLOCATION_HEADER_SIZE));
+	reinterpret_cast<EntityAllocationHeader*>(memory)->Pool = nullptr;
+	return memory + ALLOCATION_HEADER_SIZE;
+}
+
+void* Entity::operator new(size_t size, PoolAllocator& pool)
+{
+	if (size + ALLOCATION_HEADER_SIZE > pool.getSlotSize())
 	{
-		StaticLogger::instance.error("Could not find component: {string}", name.c_str());
-		return nullptr;
+		StaticLogger::instance.error("Entity of {int} bytes does not fit its pool's {int} byte slots, using the heap", (int)size, (int)pool.getSlotSize());
+		return operator new(size);
 	}
 
-	return value->second.get();
+	unsigned char* memory = static_cast<unsigned char*>(pool.allocate());
+	reinterpret_cast<EntityAllocationHeader*>(memory)->Pool = &pool;
+	return memory + ALLOCATION_HEADER_SIZE;
 }
 
-Entity::Entity(const std::string& tag)
-	:mTag(tag),
-	mTransform(std::make_unique<TransformComponent>())
+void Entity::operator delete(void* memory)
+{
+	if (memory == nullptr)
+	{
+		return;
+	}
+
+	unsigned char* start = static_cast<unsigned char*>(memory) - ALLOCATION_HEADER_SIZE;
+	PoolAllocator* pool = reinterpret_cast<EntityAllocationHeader*>(start)->Pool;
+
+	if (pool != nullptr)
+	{
+		pool->deallocate(start);
+	}
+	else
+	{
+		::operator delete(start);
+	}
+}
+
+void Entity::operator delete(void* memory, PoolAllocator& /*pool*/)
 {
+	// Only called when a pooled entity's constructor throws. The header already names the pool,
+	// or null if the entity did not fit and came from the heap, so the regular delete handles both.
+	operator delete(memory);
 }
 
-Entity::~Entity()
+void Entity::setTag(const std::string& tag)
 {
+	TagId newTag = TagRegistry::intern(tag);
 
+	if (newTag == mTag)
+	{
+		return;
+	}
+
+	TagId oldTag = mTag;
+	mTag = newTag;
+
+	if (mScene != nullptr)
+	{
+		mScene->onTagChanged(this, oldTag);
+	}
 }
 
-void Entity::init(Scene* scene)
+bool Entity::setParent(Entity* parent)
 {
-	mTransform->init(this, scene);
+	if (parent != nullptr && parent->mScene != mScene)
+	{
+		StaticLogger::instance.error("Cannot parent {string} to an entity in another scene", getTag().c_str());
+		return false;
+	}
+
+	if (!mTransform.setParent((parent != nullptr) ? parent->getTransform() : nullptr))
+	{
+		StaticLogger::instance.error("Cannot parent {string} to one of its own descendants", getTag().c_str());
+		return false;
+	}
 
-	for (auto component = mComponents.begin(); component != mComponents.end(); ++component)
+	if (mScene != nullptr)
 	{
-		component->second->init(this, scene);
+		mScene->onHierarchyChanged();
 	}
+
+	return true;
 }
 
-void Entity::update(Scene* scene)
+void Entity::init(Scene* scene)
 {
-	updateComponents(scene);
+	// Anything set up before the entity entered the scene should not be interpolated from.
+	mTransform.calculateTransformationMatrix();
+	mTransform.storePreviousState();
+	mTransform.init(this, scene);
 }
 
-RenderableEntity::RenderableEntity(Mesh* mesh, 
-	Texture* texture, 
+RenderableEntity::RenderableEntity(const ResourceRef<Mesh>& mesh, 
+	const ResourceRef<Texture>& texture, 
 	const std::string& tag)
 	:Entity(tag),
 	mMesh(mesh),
@@ -78,10 +157,31 @@ RenderableEntity::~RenderableEntity()
 
 void RenderableEntity::render()
 {
+	Mesh* mesh = mMesh.get();
+	Texture* texture = mTexture.get();
+
+	// Either may still be loading.
+	if (mesh == nullptr || texture == nullptr)
+	{
+		return;
+	}
+
 	// Bind the texture to slot 0.
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, mTexture->getDiffuseID());
+	texture->bind(0);
 
 	// Render the mesth.
-	mMesh->render();
+	mesh->render();
 }
+
+void RenderableEntity::extractRenderData(RenderPacket& packet)
+{
+	RenderItem item;
+	item.Previous = mTransform.getPreviousState();
+	item.Current = mTransform.getState();
+	item.Model = mTransform.getTransformationMatrix();
+	item.Moving = mTransform.hasMoved();
+	item.Geometry = mMesh.getHandle();
+	item.Diffuse = mTexture.getHandle();
+
+	packet.Items.push_back(item);
+}
\ No newline at end of file
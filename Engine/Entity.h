@@ -1,30 +1,24 @@
 #pragma once
 
-#include <map>
+#include <cstddef>
 #include <string>
 
 #include "Component.h"
+#include "ComponentStorage.h"
+#include "TagRegistry.h"
+#include "ResourceManager.h"
+#include "Logger/StaticLogger.h"
 #include "Render Engine/Mesh.h"
 #include "Render Engine/Texture.h"
 #include "Serializers/OBJ Serializer/ModelLoader.h"
 
-/// <summary>
-/// Class to 
-/// <author>Bryce Young 1/25/2022</author>
-/// </summary>
-class ObjectWithComponents
-{
-public:
-	IComponent* getComponent(const std::string& name);
-
-protected:
-	std::map<std::string, std::unique_ptr<IComponent>> mComponents;
-};
+struct RenderPacket;
+class PoolAllocator;
 
 /// <summary>
 /// Class to represent an entity.
 /// </summary>
-class Entity : public ObjectWithComponents
+class Entity
 {
 public:
 	/// <summary>
@@ -34,26 +28,177 @@ public:
 	Entity(const std::string& tag = "untagged");
 	virtual ~Entity();
 
-	std::string getTag() { return mTag; }
-	void setTag(const std::string& tag) { this->mTag = tag; }
+	/// <summary>
+	/// Bytes in front of every entity recording the pool it was allocated from, if any.
+	/// </summary>
+	static constexpr size_t ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+
+	/// <summary>
+	/// Entities remember where their memory came from, so deleting one returns it to its pool,
+	/// and the scene can free pooled and heap allocated entities the same way.
+	/// Use EntityPool to allocate from a pool.
+	/// </summary>
+	static void* operator new(size_t size);
+	static void* operator new(size_t size, PoolAllocator& pool);
+	static void operator delete(void* memory);
+	static void operator delete(void* memory, PoolAllocator& pool);
+
+	const std::string& getTag() const { return TagRegistry::getName(mTag); }
+	TagId getTagId() const { return mTag; }
+
+	/// <summary>
+	/// Changes the entity's tag and moves it to the new tag's bucket in the scene's tag index.
+	/// </summary>
+	/// <param name="tag"></param>
+	void setTag(const std::string& tag);
+
+	TransformComponent* getTransform() { return &mTransform; }
+
+	/// <summary>
+	/// Attaches this entity's transform to another entity's, or detaches it when parent is nullptr.
+	/// Both entities must be in the same scene, or both still outside of one.
+	/// Destroying a parent destroys its children.
+	/// </summary>
+	/// <param name="parent"></param>
+	/// <returns>False if the parent is in another scene or is a descendant of this entity.</returns>
+	bool setParent(Entity* parent);
+
+	Entity* getParent()
+	{
+		return (mTransform.getParent() != nullptr) ? mTransform.getParent()->getOwner() : nullptr;
+	}
+
+	/// <summary>
+	/// The entity's id within its scene. Components are stored by the scene against this id.
+	/// </summary>
+	/// <returns></returns>
+	EntityId getId() const { return mId; }
+	Scene* getScene() { return mScene; }
+
+	/// <summary>
+	/// Returns a handle that stops resolving once this entity is destroyed.
+	/// Hold handles rather than pointers to entities you do not own.
+	/// </summary>
+	/// <returns></returns>
+	EntityHandle getHandle() const { return EntityHandle(mId, mGeneration); }
 
-	TransformComponent* getTransform() { return mTransform.get(); }
+	/// <summary>
+	/// Constructs a component of type T in the scene's pool for that type and initializes it.
+	/// The entity must already have been added to a scene.
+	/// The returned pointer is invalidated when another component of the same type is added or removed.
+	/// </summary>
+	/// <typeparam name="T"></typeparam>
+	/// <param name="args">Forwarded to T's constructor.</param>
+	/// <returns>The new component, or nullptr if the entity already has one.</returns>
+	template<typename T, typename... Args>
+	T* addComponent(Args&&... args)
+	{
+		if (mComponentStorage == nullptr)
+		{
+			StaticLogger::instance.error("Entity must be added to a scene before adding components: {string}", getTag().c_str());
+			return nullptr;
+		}
+
+		T* component = mComponentStorage->add<T>(mId, std::forward<Args>(args)...);
+
+		if (component == nullptr)
+		{
+			StaticLogger::instance.error("Failed to add component: {string}", typeid(T).name());
+			return nullptr;
+		}
+
+		component->init(this, mScene);
+		return component;
+	}
 
-	bool addComponent(const std::string& name, std::unique_ptr<IComponent> component);
-	void updateComponents(Scene* scene);
+	/// <summary>
+	/// Returns the entity's component of type T, or nullptr if it has none.
+	/// A mask test and an array index, cheap enough for per tick game code. Does not log on a miss.
+	/// </summary>
+	/// <typeparam name="T"></typeparam>
+	/// <returns></returns>
+	template<typename T>
+	T* getComponent()
+	{
+		if (mComponentStorage == nullptr)
+		{
+			return nullptr;
+		}
+
+		return mComponentStorage->get<T>(mId);
+	}
+
+	template<typename T>
+	bool hasComponent() const
+	{
+		return mComponentStorage != nullptr && mComponentStorage->has<T>(mId);
+	}
+
+	template<typename T>
+	bool removeComponent()
+	{
+		if (mComponentStorage == nullptr)
+		{
+			return false;
+		}
+
+		return mComponentStorage->remove<T>(mId);
+	}
+
+	/// <summary>
+	/// Looks up a component by the name registered with ComponentStorage::registerName.
+	/// Slow path for tools, game code should use getComponent&lt;T&gt;().
+	/// </summary>
+	/// <param name="name"></param>
+	/// <returns></returns>
+	IComponent* getComponent(const std::string& name);
 
 	virtual void init(Scene* scene);
-	void update(Scene* scene);
 	virtual void render() {} 
 
+	/// <summary>
+	/// Copies whatever the render thread needs to draw this entity into the packet.
+	/// Called on the update thread at the end of every tick.
+	/// </summary>
+	/// <param name="packet"></param>
+	virtual void extractRenderData(RenderPacket& /*packet*/) {}
+
 protected:
-	std::string mTag;
-	std::unique_ptr<TransformComponent> mTransform;
+	TagId mTag;
+
+	// Stored inline so creating an entity is a single allocation.
+	TransformComponent mTransform;
+
+private:
+	friend class Scene;
+
+	/// <summary>
+	/// Called by the scene when the entity is added to or removed from it.
+	/// </summary>
+	void attachToScene(Scene* scene, ComponentStorage* componentStorage, EntityHandle handle, uint32_t sceneIndex)
+	{
+		mScene = scene;
+		mComponentStorage = componentStorage;
+		mId = handle.Index;
+		mGeneration = handle.Generation;
+		mSceneIndex = sceneIndex;
+	}
+
+	EntityId mId;
+	uint32_t mGeneration;
+	Scene* mScene;
+	ComponentStorage* mComponentStorage;
+
+	/// <summary>
+	/// Positions in the scene's entity list and tag bucket, kept so removal is O(1).
+	/// </summary>
+	uint32_t mSceneIndex;
+	uint32_t mTagIndex;
 };
 
 /// <summary>
 /// Represents an entity which can be rendered onto the screen.
-/// The renderable entity does not own the mesh.
+/// The renderable entity does not own the mesh, it holds references that keep the mesh and texture from being evicted.
 /// </summary>
 class RenderableEntity : public Entity
 {
@@ -63,8 +208,8 @@ public:
 	/// </summary>
 	/// <param name="mesh"></param>
 	/// <param name="tag"></param>
-	RenderableEntity(Mesh* mesh, 
-		Texture* texture, 
+	RenderableEntity(const ResourceRef<Mesh>& mesh, 
+		const ResourceRef<Texture>& texture, 
 		const std::string& tag = "untagged");
 
 	virtual ~RenderableEntity();
@@ -74,14 +219,20 @@ public:
 	/// </summary>
 	virtual void render();
 
-	Mesh* getMesh() { return mMesh; }
-	void setMesh(Mesh* mesh) { this->mMesh = mesh; }
+	/// <summary>
+	/// Adds this entity's mesh, texture and transform to the packet.
+	/// </summary>
+	/// <param name="packet"></param>
+	virtual void extractRenderData(RenderPacket& packet);
+
+	const ResourceRef<Mesh>& getMesh() { return mMesh; }
+	void setMesh(const ResourceRef<Mesh>& mesh) { this->mMesh = mesh; }
 
-	Texture* getTexture() { return mTexture; }
-	void setTexture(Texture* texture) { this->mTexture = texture; }
+	const ResourceRef<Texture>& getTexture() { return mTexture; }
+	void setTexture(const ResourceRef<Texture>& texture) { this->mTexture = texture; }
 
 protected:
-	Mesh* mMesh;
-	Texture* mTexture;
+	ResourceRef<Mesh> mMesh;
+	ResourceRef<Texture> mTexture;
 private:
 };
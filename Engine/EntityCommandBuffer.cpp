@@ -0,0 +1,52 @@
+#include "EntityCommandBuffer.h"
+#include "Scene.h"
+
+void EntityCommandBuffer::setJobSystem(JobSystem* jobSystem)
+{
+	mJobSystem = jobSystem;
+	mThreadCommands.resize(jobSystem != nullptr ? jobSystem->getThreadCount() : 1);
+}
+
+void EntityCommandBuffer::spawn(std::unique_ptr<Entity> entity)
+{
+	getThreadCommands().Spawns.push_back(std::move(entity));
+}
+
+void EntityCommandBuffer::destroy(EntityHandle entity)
+{
+	getThreadCommands().Destroys.push_back(entity);
+}
+
+void EntityCommandBuffer::flush(Scene& scene)
+{
+	for (size_t i = 0; i < mThreadCommands.size(); ++i)
+	{
+		std::vector<std::unique_ptr<Entity>>& spawns = mThreadCommands[i].Spawns;
+
+		for (size_t j = 0; j < spawns.size(); ++j)
+		{
+			scene.addEntity(std::move(spawns[j]));
+		}
+
+		spawns.clear();
+	}
+
+	for (size_t i = 0; i < mThreadCommands.size(); ++i)
+	{
+		std::vector<EntityHandle>& destroys = mThreadCommands[i].Destroys;
+
+		// Handles to entities destroyed earlier in the flush no longer resolve.
+		for (size_t j = 0; j < destroys.size(); ++j)
+		{
+			scene.destroyEntity(destroys[j]);
+		}
+
+		destroys.clear();
+	}
+}
+
+EntityCommandBuffer::ThreadCommands& EntityCommandBuffer::getThreadCommands()
+{
+	uint32_t index = (mJobSystem != nullptr) ? mJobSystem->getThreadIndex() : 0;
+	return mThreadCommands[index];
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Utils/JobSystem.h"
+#include "EntityHandle.h"
+
+class Entity;
+class Scene;
+
+/// <summary>
+/// Records entity spawns and destroys during a tick so they can be applied in one batch at a sync point.
+/// Each job system thread records into its own lists, so systems running on workers never contend.
+/// Threads that are not workers share one list, so only the update thread should record from outside a job.
+/// </summary>
+class EntityCommandBuffer
+{
+public:
+	EntityCommandBuffer()
+		:mJobSystem(nullptr),
+		mThreadCommands(1)
+	{}
+
+	~EntityCommandBuffer() {}
+
+	/// <summary>
+	/// Sizes the per-thread lists for a job system. Must not be called while commands are being recorded.
+	/// </summary>
+	/// <param name="jobSystem"></param>
+	void setJobSystem(JobSystem* jobSystem);
+
+	/// <summary>
+	/// Adds the entity to the scene at the next sync point.
+	/// </summary>
+	/// <param name="entity"></param>
+	void spawn(std::unique_ptr<Entity> entity);
+
+	/// <summary>
+	/// Removes the entity from the scene at the next sync point if the handle still refers to it.
+	/// Destroying it more than once in a tick is allowed, only the first destroy resolves.
+	/// Destroys are recorded as handles rather than pointers so an entity destroyed in an earlier tick,
+	/// whose memory may already be gone, is never touched.
+	/// </summary>
+	/// <param name="entity"></param>
+	void destroy(EntityHandle entity);
+
+	/// <summary>
+	/// Applies every recorded command to the scene, spawns first. Update thread only.
+	/// </summary>
+	/// <param name="scene"></param>
+	void flush(Scene& scene);
+
+private:
+	struct ThreadCommands
+	{
+		std::vector<std::unique_ptr<Entity>> Spawns;
+		std::vector<EntityHandle> Destroys;
+	};
+
+	ThreadCommands& getThreadCommands();
+
+	JobSystem* mJobSystem;
+	std::vector<ThreadCommands> mThreadCommands;
+};
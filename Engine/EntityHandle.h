@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// Identifies an entity within a scene. Ids are reused once an entity is destroyed.
+/// </summary>
+typedef uint32_t EntityId;
+
+#define INVALID_ENTITY_ID 0xFFFFFFFF
+
+/// <summary>
+/// A reference to an entity that can be held across ticks and threads.
+/// The generation is bumped every time an entity id is reused, so a handle to a destroyed entity
+/// resolves to nullptr instead of to whatever entity took its slot.
+/// Resolve with Scene::getEntity on the update thread.
+/// </summary>
+struct EntityHandle
+{
+	EntityHandle()
+		:Index(INVALID_ENTITY_ID),
+		Generation(0)
+	{}
+
+	EntityHandle(EntityId index, uint32_t generation)
+		:Index(index),
+		Generation(generation)
+	{}
+
+	bool isNull() const
+	{
+		return Index == INVALID_ENTITY_ID;
+	}
+
+	bool operator==(const EntityHandle& other) const
+	{
+		return Index == other.Index && Generation == other.Generation;
+	}
+
+	bool operator!=(const EntityHandle& other) const
+	{
+		return !(*this == other);
+	}
+
+	EntityId Index;
+	uint32_t Generation;
+};
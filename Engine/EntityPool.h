@@ -0,0 +1,72 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "Entity.h"
+#include "Utils/ObjectPool.h"
+
+/// <summary>
+/// Lets a scene own pools of different entity types and report on them together.
+/// </summary>
+class IEntityPool
+{
+public:
+	IEntityPool(const std::string& name)
+		:mName(name)
+	{}
+
+	virtual ~IEntityPool() {}
+
+	const std::string& getName() const
+	{
+		return mName;
+	}
+
+	virtual ObjectPoolStats getStats() const = 0;
+
+private:
+	std::string mName;
+};
+
+/// <summary>
+/// Preallocated slots for one entity type that is spawned and destroyed often, such as bullets.
+/// Acquire an entity, spawn it like any other, and destroy it through the scene: once the scene frees it,
+/// its slot goes back to this pool instead of to the heap. Dropping an acquired entity without
+/// spawning it also returns its slot. Acquiring is safe from any thread.
+/// Create pools through Scene::createEntityPool so they outlive every entity taken from them.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+template<typename T>
+class EntityPool : public IEntityPool
+{
+	static_assert(std::is_base_of<Entity, T>::value, "EntityPool only holds entities");
+
+public:
+	/// <param name="name">Shown in pool statistics.</param>
+	/// <param name="capacity">Entities allocated up front.</param>
+	/// <param name="growBy">Entities added each time the pool runs out. Defaults to the initial capacity.</param>
+	EntityPool(const std::string& name, size_t capacity, size_t growBy = 0)
+		:IEntityPool(name),
+		mAllocator(sizeof(T) + Entity::ALLOCATION_HEADER_SIZE, growBy > 0 ? growBy : capacity, capacity)
+	{}
+
+	/// <summary>
+	/// Constructs an entity in a free slot, growing the pool if there is none.
+	/// </summary>
+	template<typename... Args>
+	std::unique_ptr<T> acquire(Args&&... args)
+	{
+		return std::unique_ptr<T>(new (mAllocator) T(std::forward<Args>(args)...));
+	}
+
+	virtual ObjectPoolStats getStats() const
+	{
+		return mAllocator.getStats();
+	}
+
+private:
+	PoolAllocator mAllocator;
+};
@@ -1,13 +1,17 @@
 #include "GameManager.h"
 
-#include "Keyboard.h"
-#include "Mouse.h"
+#include "InputManager.h"
 
 #include "Serializers/JSON Serializer/JsonSerializer.h"
 #include "Logger/StaticLogger.h"
+#include "RenderPacketRecorder.h"
 #include "Render Engine/Camera.h"
 #include "Math/Math.h"
+#include "Utils/AssetCache.h"
+#include "Utils/AssetPack.h"
+#include "Utils/FrameArena.h"
 
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -18,7 +22,6 @@
 
 #if defined(__linux__)
 #define OS_LINUX
-#error Operating System Unsupported
 #endif
 
 #if defined(__APPLE__) || defined(__MACH__)
@@ -28,18 +31,47 @@
 
 #include <cassert>
 
+#ifdef OS_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// Default number of update ticks per second.
+#define DEFAULT_UPDATE_RATE 60
+
+// Below this much remaining time the update loop yields instead of sleeping.
+#define UPDATE_SLEEP_MARGIN_NANOS 2000000
+
+// Render frames longer than this count as spikes unless set otherwise: one and a half frames at 60hz.
+#define DEFAULT_RENDER_SPIKE_NANOS 25000000
+
 GameManager::constructor GameManager::cons;
 Platform GameManager::platform;
 std::string GameManager::resFolder = "";
 GameResources GameManager::Resources;
 
-GameManager::GameTime GameManager::mRenderTime;
-GameManager::GameTime GameManager::mUpdateTime;
+GameManager::GameTime GameManager::mRenderTime(DEFAULT_RENDER_SPIKE_NANOS);
+GameManager::GameTime GameManager::mUpdateTime(1000000000 / DEFAULT_UPDATE_RATE);
 
 std::thread GameManager::mMainWindowRenderThread;
 
 GameWindow* GameManager::mMainWindow = nullptr;
 std::unique_ptr<Scene> GameManager::mScene = nullptr;
+std::unique_ptr<JobSystem> GameManager::mJobSystem = nullptr;
+std::unique_ptr<AsyncResourceLoader> GameManager::mResourceLoader = nullptr;
+
+Timer GameManager::mEngineClock;
+uint32_t GameManager::mUpdateRate = DEFAULT_UPDATE_RATE;
+uint64_t GameManager::mUpdateTickNanos = 1000000000 / DEFAULT_UPDATE_RATE;
+float GameManager::mUpdateTickSeconds = 1.0f / DEFAULT_UPDATE_RATE;
+std::atomic<uint64_t> GameManager::mLastTickNanos(0);
+bool GameManager::mUpdateSpikeThresholdSet = false;
+bool GameManager::mHeadless = false;
+std::atomic<bool> GameManager::mStopRequested(false);
+GameManager::RunFiles GameManager::mRunFiles;
 
 GameManager::constructor::constructor() 
 {
@@ -50,55 +82,218 @@ GameManager::constructor::~constructor()
 {
 }
 
-void GameManager::createWindow(const WindowConfig& windowConfig) 
+void GameManager::startHeadless(const HeadlessConfig& config)
 {
-    // Init glfw and create window.
-    if(!glfwInit()) 
-    {
-        StaticLogger::instance.critical("Could not initialize [^'window]");
+    mHeadless = true;
+    mStopRequested.store(false);
+
+    RunFiles files = mRunFiles.overriddenBy(config.files);
+
+    // A run meant to last as long as its replay would never end without one.
+    if(!beginRun(files) && !files.inputReplayPath.empty() && config.tickCount == 0 && config.durationSeconds <= 0) {
+        StaticLogger::instance.error("Headless run has no input to replay and no limit, not running it");
+        endRun(files);
+        mHeadless = false;
+        return;
+    }
+
+    // No window, no GL: only the scene and its entities are initialized.
+    init();
+
+    if(config.realTime) {
+        setFineSleep(true);
+    }
+
+    mEngineClock.reset();
+    mLastTickNanos.store(0);
+
+    executeHeadlessLoop(config);
+
+    shutdownJobSystem();
+    endRun(files);
+
+    if(config.realTime) {
+        setFineSleep(false);
+    }
+
+    mHeadless = false;
+}
+
+void GameManager::shutdownJobSystem()
+{
+    // The loader waits for its decode jobs, so it has to go before the workers are joined.
+    mResourceLoader.reset();
+
+    if(mScene != nullptr) {
+        mScene->setJobSystem(nullptr);
     }
-    else 
-    {
-        bool fullScreen = windowConfig.fullscreen;
-        int flags = 0;
-        flags |= (fullScreen)? (int)WindowCreateFlags::WINDOW_FULL_SCREEN : 0;
 
-        mMainWindow = new GameWindow(windowConfig.width, windowConfig.height, windowConfig.xPos, windowConfig.yPos, windowConfig.centered, windowConfig.gameName, flags);
-        GLenum err = glewInit();
+    mJobSystem.reset();
+}
+
+bool GameManager::beginRun(const RunFiles& files)
+{
+    if(!files.profileTracePath.empty()) {
+        Profiler::clear();
+        Profiler::setEnabled(true);
+    }
 
-        if(err != 0) {
-            StaticLogger::instance.critical("Could not initialize [^'OpenGL]: {string}", glewGetErrorString(err));
+    // Both need the update rate, which the settings have set by now.
+    if(!files.inputReplayPath.empty()) {
+        if(!files.inputRecordPath.empty()) {
+            StaticLogger::instance.warning("Both recording and replaying input, only replaying {string}", files.inputReplayPath.c_str());
+        }
+
+        return InputManager::startReplay(files.inputReplayPath);
+    }
+
+    if(!files.inputRecordPath.empty()) {
+        return InputManager::startRecording(files.inputRecordPath);
+    }
+
+    return true;
+}
+
+void GameManager::endRun(const RunFiles& files)
+{
+    InputManager::stop();
+
+    if(!files.profileTracePath.empty()) {
+        Profiler::setEnabled(false);
+
+        if(Profiler::exportChromeTrace(files.profileTracePath)) {
+            StaticLogger::instance.trace("Wrote profile trace to {string}", files.profileTracePath.c_str());
         }
         else {
-            StaticLogger::instance.trace("Initialized [^'graphics instance] on [^'main thread]");
+            StaticLogger::instance.error("Could not write profile trace: {string}", files.profileTracePath.c_str());
         }
     }
+
+    if(!files.frameStatsPath.empty() && writeFrameStatsCsv(files.frameStatsPath)) {
+        StaticLogger::instance.trace("Wrote frame stats to {string}", files.frameStatsPath.c_str());
+    }
+
+    if(!files.frameHistogramPath.empty() && writeFrameHistogramCsv(files.frameHistogramPath)) {
+        StaticLogger::instance.trace("Wrote frame histograms to {string}", files.frameHistogramPath.c_str());
+    }
 }
 
-void GameManager::start()
+void GameManager::setFineSleep(bool enabled)
 {
-    // Init: load resources.
-    init();
+#ifdef OS_WINDOWS
+    // Sleep granularity defaults to ~15ms on windows which is coarser than a tick.
+    if(enabled) {
+        timeBeginPeriod(1);
+    }
+    else {
+        timeEndPeriod(1);
+    }
+#else
+    (void)enabled;
+#endif
+}
+
+void GameManager::setUpdateRate(uint32_t ticksPerSecond)
+{
+    if(ticksPerSecond == 0) {
+        StaticLogger::instance.warning("Update rate must be greater than zero, keeping {int} ticks per second", mUpdateRate);
+        return;
+    }
 
-    glClearColor(.0f, 1, 1, 1);
+    mUpdateRate = ticksPerSecond;
+    mUpdateTickNanos = 1000000000 / ticksPerSecond;
+    mUpdateTickSeconds = 1.0f / ticksPerSecond;
+
+    // A tick is a spike when it no longer fits in its time slot.
+    if(!mUpdateSpikeThresholdSet) {
+        mUpdateTime.getFrameTimes().setSpikeThreshold(mUpdateTickNanos);
+    }
+}
+
+void GameManager::setUpdateSpikeThreshold(uint64_t thresholdNanos)
+{
+    mUpdateSpikeThresholdSet = true;
+    mUpdateTime.getFrameTimes().setSpikeThreshold(thresholdNanos);
+}
+
+void GameManager::setRenderSpikeThreshold(uint64_t thresholdNanos)
+{
+    mRenderTime.getFrameTimes().setSpikeThreshold(thresholdNanos);
+}
+
+void GameManager::resetFrameStats()
+{
+    mUpdateTime.getFrameTimes().reset();
+    mRenderTime.getFrameTimes().reset();
+}
+
+bool GameManager::writeFrameStatsCsv(const std::string& path)
+{
+    std::ofstream output(path, std::ios::out | std::ios::trunc);
 
-    // Spawn the render thread and move GL context to new thread.
-    Framebuffer::unBind(mMainWindow->getWidth(), mMainWindow->getHeight());
-    glfwMakeContextCurrent(nullptr);
-    mMainWindowRenderThread = std::thread(executeRenderLoop);
-    mMainWindowRenderThread.detach();
+    if(!output.is_open()) {
+        StaticLogger::instance.warning("Could not open frame stats file: {string}", path.c_str());
+        return false;
+    }
+
+    const char* names[] = { "update", "render" };
+    GameTime* loops[] = { &mUpdateTime, &mRenderTime };
+
+    output << "loop,frames,mean_ms,p50_ms,p95_ms,p99_ms,max_ms,spikes,spike_threshold_ms\n";
+
+    for(int i = 0; i < 2; ++i) {
+        FrameStats stats = loops[i]->getFrameTimes().getStats();
+
+        output << names[i] << ',' << stats.frames << ','
+            << stats.meanNanos / 1e6 << ',' << stats.p50Nanos / 1e6 << ','
+            << stats.p95Nanos / 1e6 << ',' << stats.p99Nanos / 1e6 << ','
+            << stats.maxNanos / 1e6 << ',' << stats.spikes << ','
+            << stats.spikeThresholdNanos / 1e6 << '\n';
+    }
+
+    return output.good();
+}
+
+bool GameManager::writeFrameHistogramCsv(const std::string& path)
+{
+    std::ofstream output(path, std::ios::out | std::ios::trunc);
+
+    if(!output.is_open()) {
+        StaticLogger::instance.warning("Could not open frame histogram file: {string}", path.c_str());
+        return false;
+    }
+
+    output << "loop,lower_ms,upper_ms,frames\n";
+    mUpdateTime.getFrameTimes().writeCsv(output, "update");
+    mRenderTime.getFrameTimes().writeCsv(output, "render");
+
+    return output.good();
+}
+
+float GameManager::getInterpolationAlpha()
+{
+    return getInterpolationAlpha(mLastTickNanos.load(std::memory_order_acquire));
+}
+
+float GameManager::getInterpolationAlpha(uint64_t tickNanos)
+{
+    uint64_t nowNanos = mEngineClock.nanoseconds();
+
+    if(nowNanos <= tickNanos) {
+        return 0.0f;
+    }
 
-    executeUpdateLoop();
+    float alpha = (float)(nowNanos - tickNanos) / (float)mUpdateTickNanos;
+    return (alpha > 1.0f)? 1.0f : alpha;
 }
 
-void GameManager::createWindow(const std::string& settingsPath) {
+GameManager::WindowConfig GameManager::loadSettings(const std::string& settingsPath) {
     WindowConfig windowConf(800, 600);
     JsonFile file(settingsPath);
 
     if(!file.isLoadSuccessful()) {
         StaticLogger::instance.warning("Settings file provided but failed to load: {s}", settingsPath.c_str());
-        createWindow(windowConf);
-        return;
+        return windowConf;
     }
 
     JsonObject* head = file.getHead()->objectValue;
@@ -108,6 +303,16 @@ void GameManager::createWindow(const std::string& settingsPath) {
     //check for window preferences
     JsonValue* windowSettings = head->lookupNode("window");
     JsonValue* resPath = head->lookupNode("respath");
+    JsonValue* assetPack = head->lookupNode("assetpack");
+    JsonValue* assetCache = head->lookupNode("assetcache");
+    JsonValue* tickRate = head->lookupNode("tickrate");
+    JsonValue* textureBudget = head->lookupNode("texturebudgetmb");
+    JsonValue* meshBudget = head->lookupNode("meshbudgetmb");
+    JsonValue* profileTrace = head->lookupNode("profiletrace");
+    JsonValue* frameStats = head->lookupNode("framestats");
+    JsonValue* frameHistogram = head->lookupNode("framehistogram");
+    JsonValue* recordInput = head->lookupNode("recordinput");
+    JsonValue* replayInput = head->lookupNode("replayinput");
 
     //load required window settings
     if(windowSettings == nullptr || windowSettings->type != JsonValueType::Object) {
@@ -204,7 +409,115 @@ void GameManager::createWindow(const std::string& settingsPath) {
         }
     }
 
-    createWindow(windowConf);
+    // Mount the asset pack after the res path is known, it lives in the res folder.
+    if(assetPack != nullptr) {
+        if(assetPack->type == JsonValueType::String) {
+            mountAssetPack(assetPack->stringValue);
+        }
+        else {
+            StaticLogger::instance.warning("assetpack attribute provided, but is not of type string");
+        }
+    }
+
+    // Cooked assets are kept beside the res folder rather than in it, so they never end up in a pack.
+    // Like the res path, the folder is relative to the working directory, the game's own folder.
+    if(assetCache != nullptr) {
+        if(assetCache->type == JsonValueType::String) {
+            if(!AssetCache::setFolder(assetCache->stringValue)) {
+                StaticLogger::instance.error("Could not create asset cache folder: {string}", assetCache->stringValue.c_str());
+            }
+        }
+        else {
+            StaticLogger::instance.warning("assetcache attribute provided, but is not of type string");
+        }
+    }
+
+    // Load the update tick rate.
+    if(tickRate != nullptr) {
+        if(tickRate->type == JsonValueType::Number) {
+            setUpdateRate((uint32_t)tickRate->numberValue);
+        }
+        else {
+            StaticLogger::instance.warning("tickrate attribute provided, but is not of type number");
+        }
+    }
+
+    // Load the resource memory budgets.
+    if(textureBudget != nullptr) {
+        if(textureBudget->type == JsonValueType::Number) {
+            Resources.TextureResources.setMemoryBudget((uint64_t)(textureBudget->numberValue * 1048576));
+        }
+        else {
+            StaticLogger::instance.warning("texturebudgetmb attribute provided, but is not of type number");
+        }
+    }
+
+    if(meshBudget != nullptr) {
+        if(meshBudget->type == JsonValueType::Number) {
+            Resources.MeshResources.setMemoryBudget((uint64_t)(meshBudget->numberValue * 1048576));
+        }
+        else {
+            StaticLogger::instance.warning("meshbudgetmb attribute provided, but is not of type number");
+        }
+    }
+
+    // Files the run reads or writes, relative to the working directory like the asset cache.
+    if(profileTrace != nullptr) {
+        if(profileTrace->type == JsonValueType::String) {
+            mRunFiles.profileTracePath = profileTrace->stringValue;
+        }
+        else {
+            StaticLogger::instance.warning("profiletrace attribute provided, but is not of type string");
+        }
+    }
+
+    if(frameStats != nullptr) {
+        if(frameStats->type == JsonValueType::String) {
+            mRunFiles.frameStatsPath = frameStats->stringValue;
+        }
+        else {
+            StaticLogger::instance.warning("framestats attribute provided, but is not of type string");
+        }
+    }
+
+    if(frameHistogram != nullptr) {
+        if(frameHistogram->type == JsonValueType::String) {
+            mRunFiles.frameHistogramPath = frameHistogram->stringValue;
+        }
+        else {
+            StaticLogger::instance.warning("framehistogram attribute provided, but is not of type string");
+        }
+    }
+
+    if(recordInput != nullptr) {
+        if(recordInput->type == JsonValueType::String) {
+            mRunFiles.inputRecordPath = recordInput->stringValue;
+        }
+        else {
+            StaticLogger::instance.warning("recordinput attribute provided, but is not of type string");
+        }
+    }
+
+    if(replayInput != nullptr) {
+        if(replayInput->type == JsonValueType::String) {
+            mRunFiles.inputReplayPath = replayInput->stringValue;
+        }
+        else {
+            StaticLogger::instance.warning("replayinput attribute provided, but is not of type string");
+        }
+    }
+
+    return windowConf;
+}
+
+bool GameManager::mountAssetPack(const std::string& packName) {
+    if(!AssetFiles::mount(resPath(packName), resFolder)) {
+        StaticLogger::instance.error("Could not mount asset pack: {string}", resPath(packName).c_str());
+        return false;
+    }
+
+    StaticLogger::instance.trace("Mounted asset pack {string}", resPath(packName).c_str());
+    return true;
 }
 
 void GameManager::initializePlatform() {
@@ -222,61 +535,115 @@ void GameManager::initializePlatform() {
     #endif
 }
 
-void GameManager::executeUpdateLoop()
+void GameManager::executeHeadlessLoop(const HeadlessConfig& config)
 {
+    Profiler::setThreadName("Update");
+    RenderPacketRecorder recorder;
+
+    if(!config.recordPath.empty()) {
+        recorder.open(config.recordPath);
+    }
+
+    uint64_t durationNanos = (config.durationSeconds > 0)? (uint64_t)(config.durationSeconds * 1e9) : 0;
+
+    // With no limit set, a run that replays input ends with the replay.
+    bool untilReplayEnds = config.tickCount == 0 && durationNanos == 0 && InputManager::isReplaying();
+    uint64_t tickNanos = 0;
+    uint64_t ticks = 0;
+
+    StaticLogger::instance.trace("Running [^'headless] at {int} ticks per second", mUpdateRate);
     mUpdateTime.start();
 
-    while (!mMainWindow->isClosing())
+    while(!mStopRequested.load(std::memory_order_relaxed))
     {
-        mMainWindow->pollEvents();
-        update();
+        if(config.tickCount != 0 && ticks >= config.tickCount) {
+            break;
+        }
 
-        mUpdateTime.addFrame(1000000000);
-    }
-}
+        if(durationNanos != 0 && tickNanos >= durationNanos) {
+            break;
+        }
 
-void GameManager::executeRenderLoop() 
-{
-    mMainWindow->setAsCurrent();
-    glfwSwapInterval(1);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+        // Stop before a tick the recording does not cover, not on the tick after it.
+        if(untilReplayEnds && (!InputManager::isReplaying() || InputManager::isReplayExhausted())) {
+            break;
+        }
 
-    // Right after init, start the gametime.
-    mRenderTime.start();
+        // Engine time advances by exactly one tick, independent of how long the tick took.
+        tickNanos += mUpdateTickNanos;
 
-    while(!mMainWindow->isClosing()) 
-    {
-        render();
-        mMainWindow->swapBuffers();
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if(config.realTime) {
+            uint64_t nowNanos;
 
-        // Add a frame and output the FPS if applicable.
-        if(mRenderTime.addFrame(1000000000)) 
-        {
-            StaticLogger::instance.trace("FPS: {int}", mRenderTime.getFPS());
+            while((nowNanos = mEngineClock.nanoseconds()) < tickNanos) {
+                waitForNextTick(tickNanos - nowNanos);
+            }
         }
+
+        Timer tickTimer;
+        update(tickNanos);
+        uint64_t workNanos = tickTimer.nanoseconds();
+
+        mLastTickNanos.store(tickNanos, std::memory_order_release);
+        ticks++;
+
+        // Take the render thread's place so retired entities are released and the packet can be recorded.
+        recorder.record(mScene->consumeRenderPacket());
+
+        if(mUpdateTime.addFrame(1000000000, workNanos)) {
+            reportSpikes(mUpdateTime, "update ticks");
+        }
+    }
+
+    double wallSeconds = mEngineClock.nanoseconds() / 1e9;
+    StaticLogger::instance.trace("Headless run finished: {long} ticks, {.2float} engine seconds in {.2float} seconds",
+        ticks, tickNanos / 1e9, wallSeconds);
+
+    if(recorder.isOpen()) {
+        StaticLogger::instance.trace("Recorded {long} render packets to {string}", recorder.getRecordedCount(), config.recordPath.c_str());
+    }
+}
+
+void GameManager::reportSpikes(GameTime& time, const char* frameName)
+{
+    if(time.getSpikes() != 0) {
+        StaticLogger::instance.warning("{int} {string} over {.2float} ms in the last second", time.getSpikes(), frameName,
+            time.getFrameTimes().getSpikeThreshold() / 1e6);
     }
+}
 
-    StaticLogger::instance.trace("Closing window");
+void GameManager::waitForNextTick(uint64_t nanosUntilTick)
+{
+    if (nanosUntilTick > UPDATE_SLEEP_MARGIN_NANOS)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(nanosUntilTick - UPDATE_SLEEP_MARGIN_NANOS));
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
 }
 
 void GameManager::init() 
 {
+    // The job system of a previous run is gone by now, a new one starts on first use.
+    mScene->setJobSystem(&getJobSystem());
     mScene->init();
 }
 
-void GameManager::update()
+void GameManager::update(uint64_t tickNanos)
 {
+    PROFILE_SCOPE("Update");
+
+    // The previous tick's scratch memory stays valid while this one is built.
+    FrameArena::beginFrame();
+    InputManager::beginTick();
+
+    mScene->storePreviousTransforms();
     mScene->update();
-	Keyboard::update();
-	Mouse::update();
-}
+    mScene->publishRenderPacket(tickNanos);
 
-void GameManager::render() 
-{
-	mScene->render();
+    InputManager::endTick();
 }
 
 //return program runtime given requested timeunit
@@ -307,12 +674,16 @@ float GameManager::getProgramRuntime(TimeUnit unit) {
 
 void GameManager::closeProgram()
 {
-	mMainWindow->close();
+	// The update loop closes the window once it sees the flag, which in turn ends the render loop.
+	mStopRequested.store(true);
 }
 
 void GameManager::GameTime::start()
 {
 	deltaTime.reset();
+	frameTimes.reset();
 	totalNanos = 0;
 	elapsedNanosThisSecond = 0;
+	spikesThisSecond = 0;
+	previousSpikes = 0;
 }
@@ -2,12 +2,15 @@
 #include <string>
 #include <thread>
 #include <map>
+#include <atomic>
 
-#include "lib/glew/include/GL/glew.h"
-#include "GLFW/glfw3.h"
 #include "Utils/Timer.h"
+#include "Utils/FrameTimeHistogram.h"
+#include "Utils/JobSystem.h"
+#include "Utils/Profiler.h"
 #include "Scene.h"
 #include "ResourceManager.h"
+#include "AsyncResourceLoader.h"
 #include "GameWindow.h"
 
 #include "Render Engine/Mesh.h"
@@ -34,10 +37,38 @@ public:
 
 	virtual ~GameResources() {}
 
+	/// <summary>
+	/// Evicts unreferenced textures, meshes and shaders from any manager that is over its memory budget.
+	/// Called by the render thread once per frame.
+	/// </summary>
+	/// <returns>The number of resources evicted.</returns>
+	uint32_t evictUnused()
+	{
+		return TextureResources.evictUnused() + MeshResources.evictUnused() + ShaderResources.evictUnused();
+	}
+
+	/// <summary>
+	/// Logs how much memory each kind of resource takes up and how often residency has changed.
+	/// </summary>
+	void logResidency()
+	{
+		logResidency(TextureResources.getResourceTypeName(), TextureResources.getStats());
+		logResidency(MeshResources.getResourceTypeName(), MeshResources.getStats());
+		logResidency(ShaderResources.getResourceTypeName(), ShaderResources.getStats());
+	}
+
 	ResourceManager<Texture> TextureResources;
 	ResourceManager<ShaderProgram> ShaderResources;
 	ResourceManager<Mesh> MeshResources;
 	ResourceManager<Framebuffer> FramebufferResources;
+
+private:
+	void logResidency(const std::string& name, const ResidencyStats& stats)
+	{
+		StaticLogger::instance.trace("{string}: {int}/{int} resident, {.2float} MB CPU, {.2float} MB GPU, budget {.2float} MB, {long} evictions, {long} reloads",
+			name.c_str(), stats.Resident, stats.Registered, stats.CpuBytes / 1048576.0, stats.GpuBytes / 1048576.0,
+			stats.BudgetBytes / 1048576.0, stats.Evictions, stats.Reloads);
+	}
 };
 
 /// <summary>
@@ -57,6 +88,13 @@ public:
 	virtual void loadMeshes(ResourceManager<Mesh>& meshResources) = 0;
 	virtual void loadFramebuffers(ResourceManager<Framebuffer>& framebufferResources) = 0;
 
+	/// <summary>
+	/// Requests resources that can be decoded in the background.
+	/// Called after the other load functions. Loading returns once every request has been uploaded.
+	/// </summary>
+	/// <param name="loader"></param>
+	virtual void queueResources(AsyncResourceLoader& /*loader*/) {}
+
 protected:
 
 };
@@ -130,12 +168,108 @@ public:
 		bool vSync;
 	};
 
+	/**
+	 * Files a run reads its input from or writes its measurements to. Each one is off while its path is empty
+	 * Filled from the settings file, a headless run can override any of them through its config
+	 * @param profileTracePath enables the profiler for the run and writes a Chrome trace here when it ends
+	 * @param frameStatsPath the update and render frame time percentiles are written here when the run ends
+	 * @param frameHistogramPath the update and render frame time histograms are written here when the run ends
+	 * @param inputRecordPath every tick's input is recorded here for the run
+	 * @param inputReplayPath the run replays the input recorded here instead of taking live input, taking precedence over recording
+	 * */
+	struct RunFiles
+	{
+		std::string profileTracePath;
+		std::string frameStatsPath;
+		std::string frameHistogramPath;
+		std::string inputRecordPath;
+		std::string inputReplayPath;
+
+		/**
+		 * Returns these files with every path that overrides sets replaced
+		 * */
+		RunFiles overriddenBy(const RunFiles& overrides) const
+		{
+			RunFiles files = *this;
+
+			if(!overrides.profileTracePath.empty()) {
+				files.profileTracePath = overrides.profileTracePath;
+			}
+
+			if(!overrides.frameStatsPath.empty()) {
+				files.frameStatsPath = overrides.frameStatsPath;
+			}
+
+			if(!overrides.frameHistogramPath.empty()) {
+				files.frameHistogramPath = overrides.frameHistogramPath;
+			}
+
+			if(!overrides.inputRecordPath.empty()) {
+				files.inputRecordPath = overrides.inputRecordPath;
+			}
+
+			if(!overrides.inputReplayPath.empty()) {
+				files.inputReplayPath = overrides.inputReplayPath;
+			}
+
+			return files;
+		}
+	};
+
+	/**
+	 * Settings for running the engine without a window or graphics context
+	 * The run ends after tickCount ticks or durationSeconds of engine time, whichever comes first
+	 * Leave both at 0 to run until closeProgram is called, or until the input replay ends if one was started
+	 * @param tickCount number of update ticks to run, 0 for no limit
+	 * @param durationSeconds engine time to simulate, 0 for no limit
+	 * @param realTime pace ticks against the wall clock instead of running them back to back
+	 * @param recordPath if not empty, every render packet is summarized to this CSV file
+	 * files overrides the run files set through the settings
+	 * */
+	struct HeadlessConfig
+	{
+		HeadlessConfig(uint64_t tickCount = 0, double durationSeconds = 0, bool realTime = false, const std::string& recordPath = "")
+			:tickCount(tickCount),
+			durationSeconds(durationSeconds),
+			realTime(realTime),
+			recordPath(recordPath)
+		{
+		}
+
+		uint64_t tickCount;
+		double durationSeconds;
+		bool realTime;
+		std::string recordPath;
+		RunFiles files;
+	};
+
 	/**
 	 * Creates a window and initializes graphics
 	 * @param settingsPath path to settings JSON
 	 * */
 	static void createWindow(const std::string& settingsPath);
 
+	/**
+	 * Applies the engine settings from a settings JSON file: res path, asset pack, asset cache, tick rate and resource budgets
+	 * Used by createWindow, and directly by a headless run, which has no window to create
+	 * @param settingsPath path to settings JSON
+	 * @return the window settings found in the file, or defaults
+	 * */
+	static WindowConfig loadSettings(const std::string& settingsPath);
+
+	/**
+	 * Sets the files the next run uses, replacing those read from the settings
+	 * */
+	static void setRunFiles(const RunFiles& files)
+	{
+		mRunFiles = files;
+	}
+
+	static const RunFiles& getRunFiles()
+	{
+		return mRunFiles;
+	}
+
 	/**
 	 * Creates a window based on a window config
 	 * */
@@ -143,6 +277,7 @@ public:
 
 	/// <summary>
 	/// Returns the window in which the game is being rendered.
+	/// Null when running headless.
 	/// </summary>
 	/// <returns></returns>
 	static GameWindow* getGameWindow()
@@ -151,7 +286,8 @@ public:
 	}
 
 	/**
-	 * Closes the main window and terminates the program
+	 * Stops the update loop after the current tick and closes the main window, which ends the program
+	 * When running headless there is no window and startHeadless returns
 	 * */
 	void closeProgram();
 
@@ -171,6 +307,13 @@ public:
 		resFolder = resPath;
 	}
 
+	/**
+	 * Mounts an asset pack built from the res folder. @param packName is relative to the res folder
+	 * From then on files under the res folder are read from the pack, and from disk only if the pack does not have them
+	 * Also done by createWindow when the settings file names an "assetpack"
+	 * */
+	static bool mountAssetPack(const std::string& packName);
+
 	/**
 	 * Returns info about the platform
 	 * */
@@ -190,13 +333,105 @@ public:
 
 	/// <summary>
 	/// Returns the elapsed time since last update.
+	/// The update loop runs at a fixed rate, so this is always the length of one tick.
 	/// </summary>
 	/// <returns></returns>
 	static float getUpdateDeltaTime()
 	{
-		return mUpdateTime.getDelta();
+		return mUpdateTickSeconds;
+	}
+
+	/// <summary>
+	/// Sets the number of simulation ticks per second.
+	/// </summary>
+	/// <param name="ticksPerSecond"></param>
+	static void setUpdateRate(uint32_t ticksPerSecond);
+
+	/// <summary>
+	/// Returns the number of simulation ticks per second.
+	/// </summary>
+	/// <returns></returns>
+	static uint32_t getUpdateRate()
+	{
+		return mUpdateRate;
+	}
+
+	/// <summary>
+	/// Returns the time since the engine started running, the time base of update ticks and input events.
+	/// </summary>
+	/// <returns></returns>
+	static uint64_t getEngineTimeNanos()
+	{
+		return mEngineClock.nanoseconds();
 	}
 
+	/// <summary>
+	/// Returns how far the current frame is between the previous and the latest update tick.
+	/// 0 is the previous tick, 1 is the latest tick. Used by the render thread to blend transforms.
+	/// </summary>
+	/// <returns></returns>
+	static float getInterpolationAlpha();
+
+	/// <summary>
+	/// Returns how far the current frame is past a specific tick, measured in ticks and clamped to 1.
+	/// Pass the tick time stored in a render packet to blend that packet's transforms.
+	/// </summary>
+	/// <param name="tickNanos"></param>
+	/// <returns></returns>
+	static float getInterpolationAlpha(uint64_t tickNanos);
+
+	/// <summary>
+	/// Returns frame time percentiles for the update loop since it started or since the last reset.
+	/// Update frames measure the work done in a tick, not the time spent waiting for the next one.
+	/// </summary>
+	/// <returns></returns>
+	static FrameStats getUpdateFrameStats()
+	{
+		return mUpdateTime.getFrameTimes().getStats();
+	}
+
+	/// <summary>
+	/// Returns frame time percentiles for the render loop since it started or since the last reset.
+	/// Render frames measure the time between presented frames, which is what the player sees.
+	/// </summary>
+	/// <returns></returns>
+	static FrameStats getRenderFrameStats()
+	{
+		return mRenderTime.getFrameTimes().getStats();
+	}
+
+	/// <summary>
+	/// Update ticks taking longer than this count as spikes. Defaults to the length of a tick.
+	/// </summary>
+	/// <param name="thresholdNanos">0 disables update spike detection.</param>
+	static void setUpdateSpikeThreshold(uint64_t thresholdNanos);
+
+	/// <summary>
+	/// Render frames taking longer than this count as spikes.
+	/// </summary>
+	/// <param name="thresholdNanos">0 disables render spike detection.</param>
+	static void setRenderSpikeThreshold(uint64_t thresholdNanos);
+
+	/// <summary>
+	/// Drops the frame times recorded so far, e.g. once loading has finished and a measured run begins.
+	/// </summary>
+	static void resetFrameStats();
+
+	/// <summary>
+	/// Writes the update and render frame stats as CSV, one row per loop, times in milliseconds.
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns>False if the file could not be written.</returns>
+	static bool writeFrameStatsCsv(const std::string& path);
+
+	/// <summary>
+	/// Writes the non empty histogram buckets of both loops as CSV, one row per bucket, times in milliseconds.
+	/// Lets runs be compared beyond the percentiles.
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns>False if the file could not be written.</returns>
+	static bool writeFrameHistogramCsv(const std::string& path);
+
 	/// <summary>
 	/// Sets the current scene.
 	/// </summary>
@@ -204,6 +439,7 @@ public:
 	static void setScene(std::unique_ptr<Scene> scene)
 	{
 		mScene = std::move(scene);
+		mScene->setJobSystem(&getJobSystem());
 	}
 
 	/// <summary>
@@ -215,16 +451,71 @@ public:
 		return mScene.get();
 	}
 
+	/// <summary>
+	/// Returns the engine's job system, starting its worker threads on first use.
+	/// Jobs may be scheduled from the update thread or from other jobs.
+	/// </summary>
+	/// <returns></returns>
+	static JobSystem& getJobSystem()
+	{
+		if (mJobSystem == nullptr)
+		{
+			mJobSystem = std::make_unique<JobSystem>();
+		}
+
+		return *mJobSystem;
+	}
+
+	/// <summary>
+	/// Returns the loader for resources decoded on the job system and uploaded by the render thread.
+	/// Requests made while the game runs are uploaded a few at a time at the start of each frame.
+	/// </summary>
+	/// <returns></returns>
+	static AsyncResourceLoader& getResourceLoader()
+	{
+		if (mResourceLoader == nullptr)
+		{
+			mResourceLoader = std::make_unique<AsyncResourceLoader>(getJobSystem(), Resources);
+		}
+
+		return *mResourceLoader;
+	}
+
 	/// <summary>
 	/// Loads all global resources.
 	/// </summary>
 	/// <param name="loader"></param>
 	static void loadResources(IGlobalResourceLoader& loader)
 	{
-		loader.loadFramebuffers(Resources.FramebufferResources);
-		loader.loadShaders(Resources.ShaderResources);
-		loader.loadTextures(Resources.TextureResources);
-		loader.loadMeshes(Resources.MeshResources);
+		PROFILE_SCOPE("Load Resources");
+
+		{
+			PROFILE_SCOPE("Load Framebuffers");
+			loader.loadFramebuffers(Resources.FramebufferResources);
+		}
+
+		{
+			PROFILE_SCOPE("Load Shaders");
+			loader.loadShaders(Resources.ShaderResources);
+		}
+
+		{
+			PROFILE_SCOPE("Load Textures");
+			loader.loadTextures(Resources.TextureResources);
+		}
+
+		{
+			PROFILE_SCOPE("Load Meshes");
+			loader.loadMeshes(Resources.MeshResources);
+		}
+
+		{
+			PROFILE_SCOPE("Queue Resources");
+			loader.queueResources(getResourceLoader());
+		}
+
+		// The graphics context is still on this thread, so it does the uploads as decoding finishes.
+		getResourceLoader().finishLoading();
 	}
 
 	/// <summary>
@@ -235,6 +526,23 @@ public:
 	/// </summary>
 	static void start();
 
+	/// <summary>
+	/// Runs the update loop without a window, a graphics context or a render thread.
+	/// The render pipeline is never initialized. Render packets are consumed on the update
+	/// thread after every tick and optionally recorded. Use for servers, simulations and benchmarks.
+	/// </summary>
+	/// <param name="config"></param>
+	static void startHeadless(const HeadlessConfig& config);
+
+	/// <summary>
+	/// Returns true while the engine is running through startHeadless.
+	/// </summary>
+	/// <returns></returns>
+	static bool isHeadless()
+	{
+		return mHeadless;
+	}
+
 	/// <summary>
 	/// Returns the program runtime.
 	/// </summary>
@@ -254,13 +562,62 @@ private:
 	/// </summary>
 	static void executeUpdateLoop();
 
+	/// <summary>
+	/// Performs update on the calling thread until the headless config's limits are hit.
+	/// </summary>
+	/// <param name="config"></param>
+	static void executeHeadlessLoop(const HeadlessConfig& config);
+
 	/// <summary>
 	/// Initializes the engine with platform information and other init necessities.
 	/// </summary>
 	static void initializePlatform();
 
+	/// <summary>
+	/// Asks the OS for sleeps fine enough to wait for a tick, while a run is in progress.
+	/// </summary>
+	/// <param name="enabled"></param>
+	static void setFineSleep(bool enabled);
+
+	/// <summary>
+	/// Joins the job system's workers at the end of a run, after the resource loader that uses them.
+	/// The scene lets go of the job system first, init hands it the next run's.
+	/// </summary>
+	static void shutdownJobSystem();
+
+	/// <summary>
+	/// Starts whatever the run's files ask for. Called by start and startHeadless before the scene is initialized,
+	/// so an input recording or replay covers the first tick.
+	/// </summary>
+	/// <param name="files"></param>
+	/// <returns>False if an input recording or replay was asked for but could not be started.</returns>
+	static bool beginRun(const RunFiles& files);
+
+	/// <summary>
+	/// Stops what beginRun started and writes the run's results. Called once the job system is gone,
+	/// so nothing is still recording.
+	/// </summary>
+	/// <param name="files"></param>
+	static void endRun(const RunFiles& files);
+
+	/// <summary>
+	/// Gives the remaining time before the next update tick back to the OS.
+	/// Sleeps for most of the wait and yields for the rest to keep the tick on time.
+	/// </summary>
+	/// <param name="nanosUntilTick"></param>
+	static void waitForNextTick(uint64_t nanosUntilTick);
+
+	class GameTime;
+
+	/// <summary>
+	/// Logs how many spikes a loop had during the last second, if any.
+	/// </summary>
+	/// <param name="time"></param>
+	/// <param name="frameName">What the loop's frames are called in the message.</param>
+	static void reportSpikes(GameTime& time, const char* frameName);
+
 	static void init();
-	static void update();
+	static void update(uint64_t tickNanos);
 	static void render();
 
 	/// <summary>
@@ -290,7 +647,11 @@ private:
 	class GameTime 
 	{
 	public:
-		GameTime() : totalNanos(0), elapsedNanosThisSecond(0), delta(0) 
+		/**
+		 * @param spikeThresholdNanos frames longer than this count as spikes, 0 disables spike detection
+		 * */
+		GameTime(uint64_t spikeThresholdNanos = 0)
+			: frameTimes(spikeThresholdNanos), totalNanos(0), elapsedNanosThisSecond(0), delta(0), spikesThisSecond(0), previousSpikes(0)
 		{
 		}
 
@@ -302,8 +663,18 @@ private:
 
 		/**
 		 * Adds a frame. If there is a rollover in the FPS, the function returns true
+		 * The time since the previous frame goes into the frame time histogram
 		 * */
 		inline bool addFrame(uint64_t rollOverRateNanos)
+		{
+			return addFrame(rollOverRateNanos, deltaTime.nanoseconds());
+		}
+
+		/**
+		 * Adds a frame, recording frameNanos in the frame time histogram instead of the time since the previous frame
+		 * Used by the update loop, where most of the time between ticks is spent waiting
+		 * */
+		inline bool addFrame(uint64_t rollOverRateNanos, uint64_t frameNanos)
 		{
 
 			bool ret = false;
@@ -312,10 +683,16 @@ private:
 			this->elapsedNanosThisSecond += elapsed;
 			this->frameCount++;
 
+			if (frameTimes.record(frameNanos)) {
+				this->spikesThisSecond++;
+			}
+
 			//check for elapsed time overflow
 			if (this->elapsedNanosThisSecond >= rollOverRateNanos) {
 				this->previousFPS = frameCount;
+				this->previousSpikes = spikesThisSecond;
 				this->frameCount = 0;
+				this->spikesThisSecond = 0;
 				this->elapsedNanosThisSecond = 0;
 				ret = true;
 			}
@@ -366,17 +743,58 @@ private:
 			return delta;
 		}
 
+		/**
+		 * Number of spikes in the last full rollover period
+		 * */
+		inline uint32_t getSpikes()
+		{
+			return previousSpikes;
+		}
+
+		inline FrameTimeHistogram& getFrameTimes()
+		{
+			return frameTimes;
+		}
+
 	private:
 		Timer deltaTime;
+		FrameTimeHistogram frameTimes;
 
 		uint64_t totalNanos;
 		uint64_t elapsedNanosThisSecond;
 		int frameCount = 0;
 		int previousFPS = 0;
 		float delta;
+		uint32_t spikesThisSecond;
+		uint32_t previousSpikes;
 	};
 
 	static GameTime mRenderTime;
 	static GameTime mUpdateTime;
 	static std::unique_ptr<Scene> mScene;
+	static std::unique_ptr<JobSystem> mJobSystem;
+	static std::unique_ptr<AsyncResourceLoader> mResourceLoader;
+
+	/// <summary>
+	/// Fixed update tick state. The engine clock is shared by the update and render threads
+	/// so the render thread can tell how far it is past the latest tick.
+	/// </summary>
+	static Timer mEngineClock;
+	static uint32_t mUpdateRate;
+	static uint64_t mUpdateTickNanos;
+	static float mUpdateTickSeconds;
+	static std::atomic<uint64_t> mLastTickNanos;
+
+	/// <summary>
+	/// Set once setUpdateSpikeThreshold is called, after which changing the update rate keeps the threshold.
+	/// </summary>
+	static bool mUpdateSpikeThresholdSet;
+
+	/// <summary>
+	/// Raised by closeProgram. Both update loops stop once they see it.
+	/// </summary>
+	static std::atomic<bool> mStopRequested;
+	static bool mHeadless;
+
+	static RunFiles mRunFiles;
 };
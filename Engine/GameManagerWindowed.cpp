@@ -0,0 +1,169 @@
+#include "GameManager.h"
+
+#include "Logger/StaticLogger.h"
+#include "Utils/FrameArena.h"
+
+#include "lib/glew/include/GL/glew.h"
+#include "GLFW/glfw3.h"
+
+// Everything GameManager does with a window or a graphics context lives here,
+// so GameManager.cpp, which a headless run is built from, needs neither the GL nor the GLFW headers.
+
+// The most time the update loop will try to catch up on in one go.
+// Anything beyond this is dropped so a long stall cannot snowball into more stalls.
+#define MAX_UPDATE_CATCHUP_NANOS 250000000
+
+void GameManager::createWindow(const WindowConfig& windowConfig) 
+{
+    // Init glfw and create window.
+    if(!glfwInit()) 
+    {
+        StaticLogger::instance.critical("Could not initialize [^'window]");
+    }
+    else 
+    {
+        bool fullScreen = windowConfig.fullscreen;
+        int flags = 0;
+        flags |= (fullScreen)? (int)WindowCreateFlags::WINDOW_FULL_SCREEN : 0;
+
+        mMainWindow = new GameWindow(windowConfig.width, windowConfig.height, windowConfig.xPos, windowConfig.yPos, windowConfig.centered, windowConfig.gameName, flags);
+        GLenum err = glewInit();
+
+        if(err != 0) {
+            StaticLogger::instance.critical("Could not initialize [^'OpenGL]: {string}", glewGetErrorString(err));
+        }
+        else {
+            StaticLogger::instance.trace("Initialized [^'graphics instance] on [^'main thread]");
+        }
+    }
+}
+
+void GameManager::createWindow(const std::string& settingsPath)
+{
+    createWindow(loadSettings(settingsPath));
+}
+
+void GameManager::start()
+{
+    RunFiles files = mRunFiles;
+    beginRun(files);
+
+    // Init: load resources.
+    init();
+    mScene->initRenderPipeline();
+
+    glClearColor(.0f, 1, 1, 1);
+    setFineSleep(true);
+
+    mStopRequested.store(false);
+    mEngineClock.reset();
+    mLastTickNanos.store(0);
+
+    // Create the loader before the render thread starts polling it.
+    getResourceLoader();
+
+    // Spawn the render thread and move GL context to new thread.
+    Framebuffer::unBind(mMainWindow->getWidth(), mMainWindow->getHeight());
+    glfwMakeContextCurrent(nullptr);
+    mMainWindowRenderThread = std::thread(executeRenderLoop);
+
+    executeUpdateLoop();
+
+    // The update loop closed the window, so the render loop is on its way out.
+    // Nothing below may be torn down while it can still render a frame.
+    mMainWindowRenderThread.join();
+
+    // Join the workers here rather than during static destruction.
+    shutdownJobSystem();
+    endRun(files);
+    setFineSleep(false);
+}
+
+void GameManager::executeUpdateLoop()
+{
+    Profiler::setThreadName("Update");
+    mUpdateTime.start();
+
+    uint64_t previousNanos = mEngineClock.nanoseconds();
+    uint64_t accumulatedNanos = 0;
+
+    while (!mStopRequested.load(std::memory_order_relaxed) && !mMainWindow->isClosing())
+    {
+        uint64_t nowNanos = mEngineClock.nanoseconds();
+        accumulatedNanos += nowNanos - previousNanos;
+        previousNanos = nowNanos;
+
+        if (accumulatedNanos > MAX_UPDATE_CATCHUP_NANOS)
+        {
+            accumulatedNanos = MAX_UPDATE_CATCHUP_NANOS;
+        }
+
+        mMainWindow->pollEvents();
+
+        // Run as many fixed ticks as the elapsed time covers.
+        while (accumulatedNanos >= mUpdateTickNanos)
+        {
+            accumulatedNanos -= mUpdateTickNanos;
+
+            Timer tickTimer;
+            update(nowNanos - accumulatedNanos);
+
+            if(mUpdateTime.addFrame(1000000000, tickTimer.nanoseconds()))
+            {
+                reportSpikes(mUpdateTime, "update ticks");
+            }
+        }
+
+        // The latest tick represents the world as it was accumulatedNanos ago.
+        mLastTickNanos.store(nowNanos - accumulatedNanos, std::memory_order_release);
+
+        waitForNextTick(mUpdateTickNanos - accumulatedNanos);
+    }
+
+    // Stopped by closeProgram: closing the window ends the render loop as well.
+    mMainWindow->close();
+}
+
+void GameManager::executeRenderLoop() 
+{
+    Profiler::setThreadName("Render");
+    mMainWindow->setAsCurrent();
+    glfwSwapInterval(1);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glCullFace(GL_BACK);
+
+    // Right after init, start the gametime.
+    mRenderTime.start();
+
+    while(!mMainWindow->isClosing()) 
+    {
+        render();
+
+        {
+            PROFILE_SCOPE("Swap Buffers");
+            mMainWindow->swapBuffers();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+
+        // Add a frame and output the FPS if applicable.
+        if(mRenderTime.addFrame(1000000000)) 
+        {
+            StaticLogger::instance.trace("FPS: {int}", mRenderTime.getFPS());
+            reportSpikes(mRenderTime, "frames");
+        }
+    }
+
+    StaticLogger::instance.trace("Closing window");
+}
+
+void GameManager::render() 
+{
+	PROFILE_SCOPE("Render");
+	FrameArena::beginFrame();
+
+	// Resources requested while the game runs become usable a few at a time.
+	mResourceLoader->processUploads();
+	Resources.evictUnused();
+	mScene->render();
+}
@@ -1,8 +1,10 @@
 #include "GameWindow.h"
 
+#include "../lib/glew/include/GL/glew.h"
+#include "GLFW/glfw3.h"
+
 #include "../Logger/StaticLogger.h"
-#include "Mouse.h"
-#include "Keyboard.h"
+#include "InputManager.h"
 
 constexpr int mini(int x, int y)
 {
@@ -58,31 +60,49 @@ void windowErrorCallback(int error, const char* msg) {
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods){
+    InputEvent event = {};
+    event.Code = key;
+
     if(action == GLFW_RELEASE){
-        Keyboard::releaseKey(key);
+        event.Type = InputEventType::KEY_RELEASE;
+        InputManager::submit(event);
     }
     else if(action == GLFW_PRESS){
-        Keyboard::pressKey(key);
+        event.Type = InputEventType::KEY_PRESS;
+        InputManager::submit(event);
     }
     else if(action == GLFW_REPEAT){
     }
 }
 
 void mousebutton_callback(GLFWwindow* window, int button, int action, int mods) {
+    InputEvent event = {};
+    event.Code = button;
+
     if(action == GLFW_PRESS) {
-        Mouse::pressButton(button);
+        event.Type = InputEventType::BUTTON_PRESS;
+        InputManager::submit(event);
     }
     else if(action == GLFW_RELEASE) {
-        Mouse::releaseButton(button);
+        event.Type = InputEventType::BUTTON_RELEASE;
+        InputManager::submit(event);
     }
 }
 
 void mousepos_callback(GLFWwindow* window, double x, double y) {
-    Mouse::updatePos(x, y);
+    InputEvent event = {};
+    event.Type = InputEventType::CURSOR_MOVE;
+    event.X = x;
+    event.Y = y;
+    InputManager::submit(event);
 }
 
 void mousescroll_callback(GLFWwindow* window, double x, double y) {
-    Mouse::updateScroll(x, y);
+    InputEvent event = {};
+    event.Type = InputEventType::SCROLL;
+    event.X = x;
+    event.Y = y;
+    InputManager::submit(event);
 }
 
 GameWindow::GameWindow(int width, int height, int posx, int posy, bool centered, const std::string& title, int flags) 
@@ -94,6 +114,7 @@ GameWindow::GameWindow(int width, int height, int posx, int posy, bool centered,
         glfwSetKeyCallback(window, key_callback);
         glfwSetMouseButtonCallback(window, mousebutton_callback);
         glfwSetCursorPosCallback(window, mousepos_callback);
+        glfwSetScrollCallback(window, mousescroll_callback);
     }
     else {
         StaticLogger::instance.critical("Window initialization failed :/\n");
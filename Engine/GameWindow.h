@@ -1,10 +1,10 @@
 #pragma once
 
-#include "../lib/glew/include/GL/glew.h"
-#include "GLFW/glfw3.h"
 #include <string>
 
+// Only GameWindow.cpp talks to GLFW, everything else sees the window through this class.
 struct GLFWwindow;
+struct GLFWmonitor;
 
 /**
  * error codes for window creation
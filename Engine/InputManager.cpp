@@ -0,0 +1,153 @@
+#include "InputManager.h"
+
+#include "GameManager.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+#include "Logger/StaticLogger.h"
+
+SpscQueue<InputEvent, INPUT_QUEUE_CAPACITY> InputManager::mQueue;
+std::atomic<uint64_t> InputManager::mDropped(0);
+uint64_t InputManager::mReportedDrops = 0;
+InputRecorder InputManager::mRecorder;
+std::vector<InputEvent> InputManager::mTickEvents;
+
+void InputManager::submit(InputEvent event)
+{
+	event.TimeNanos = GameManager::getEngineTimeNanos();
+
+	if (!mQueue.push(event))
+	{
+		mDropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void InputManager::apply(const InputEvent& event)
+{
+	switch (event.Type)
+	{
+	case InputEventType::KEY_PRESS:
+		Keyboard::pressKey(event.Code);
+		break;
+	case InputEventType::KEY_RELEASE:
+		Keyboard::releaseKey(event.Code);
+		break;
+	case InputEventType::BUTTON_PRESS:
+		Mouse::pressButton(event.Code);
+		break;
+	case InputEventType::BUTTON_RELEASE:
+		Mouse::releaseButton(event.Code);
+		break;
+	case InputEventType::CURSOR_MOVE:
+		Mouse::updatePos(event.X, event.Y);
+		break;
+	case InputEventType::SCROLL:
+		Mouse::updateScroll(event.X, event.Y);
+		break;
+	}
+}
+
+void InputManager::beginTick()
+{
+	InputEvent event;
+	mTickEvents.clear();
+
+	while (mQueue.pop(event))
+	{
+		mTickEvents.push_back(event);
+	}
+
+	if (mRecorder.isReplaying())
+	{
+		// The recording is the only source of input during a replay.
+		mRecorder.replayTick(mTickEvents);
+	}
+	else if (mRecorder.isRecording())
+	{
+		mRecorder.recordTick(mTickEvents);
+	}
+
+	uint64_t dropped = mDropped.load(std::memory_order_relaxed);
+	if (dropped != mReportedDrops)
+	{
+		StaticLogger::instance.warning("Input queue full, {long} events dropped", dropped - mReportedDrops);
+		mReportedDrops = dropped;
+	}
+
+	for (size_t i = 0; i < mTickEvents.size(); ++i)
+	{
+		apply(mTickEvents[i]);
+	}
+}
+
+void InputManager::endTick()
+{
+	Keyboard::update();
+	Mouse::update();
+}
+
+bool InputManager::startRecording(const std::string& path)
+{
+	InputSnapshot start;
+
+	for (int key = 0; key < KEY_COUNT; ++key)
+	{
+		if (Keyboard::isKeyDown(key))
+		{
+			start.Keys.push_back(key);
+		}
+	}
+
+	for (int button = 0; button < BUTTON_COUNT; ++button)
+	{
+		if (Mouse::isButtonDown(button))
+		{
+			start.Buttons.push_back(button);
+		}
+	}
+
+	start.CursorX = Mouse::getPosX();
+	start.CursorY = Mouse::getPosY();
+	start.CursorDX = Mouse::getPosDX();
+	start.CursorDY = Mouse::getPosDY();
+	start.ScrollX = Mouse::getScrollX();
+	start.ScrollY = Mouse::getScrollY();
+	start.ScrollDX = Mouse::getScrollDX();
+	start.ScrollDY = Mouse::getScrollDY();
+
+	return mRecorder.startRecording(path, GameManager::getUpdateRate(), start);
+}
+
+bool InputManager::startReplay(const std::string& path)
+{
+	InputSnapshot start;
+
+	if (!mRecorder.startReplay(path, GameManager::getUpdateRate(), start))
+	{
+		return false;
+	}
+
+	// Restores what was held without any presses or moves, the recording was
+	// started between ticks so the first tick saw none either.
+	Keyboard::reset();
+	Mouse::reset();
+
+	for (size_t i = 0; i < start.Keys.size(); ++i)
+	{
+		Keyboard::holdKey(start.Keys[i]);
+	}
+
+	for (size_t i = 0; i < start.Buttons.size(); ++i)
+	{
+		Mouse::holdButton(start.Buttons[i]);
+	}
+
+	Mouse::setPos(start.CursorX, start.CursorY, start.CursorDX, start.CursorDY);
+	Mouse::setScroll(start.ScrollX, start.ScrollY, start.ScrollDX, start.ScrollDY);
+	return true;
+}
+
+void InputManager::stop()
+{
+	mRecorder.stop();
+}
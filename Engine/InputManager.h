@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "InputRecorder.h"
+#include "Utils/SpscQueue.h"
+
+// Live events that can wait for the next tick. Events beyond this are dropped and counted.
+#define INPUT_QUEUE_CAPACITY 1024
+
+/// <summary>
+/// Single entry point for input. The window's callbacks submit events here and the update loop
+/// brackets every tick with beginTick/endTick, so input can be recorded per tick and replayed
+/// later in place of the window.
+/// Submitted events go through a lock-free queue and are only applied to the Keyboard and Mouse
+/// tables when the update thread drains it, so the tables are never written while a tick reads them.
+/// </summary>
+class InputManager
+{
+public:
+	/// <summary>
+	/// Hands a live input event to the engine, stamped with the engine time.
+	/// Must always be called from the same thread, the one polling the window.
+	/// </summary>
+	/// <param name="event"></param>
+	static void submit(InputEvent event);
+
+	/// <summary>
+	/// Applies an event to the Keyboard and Mouse state tables.
+	/// </summary>
+	/// <param name="event"></param>
+	static void apply(const InputEvent& event);
+
+	/// <summary>
+	/// Called by the update loop before a tick runs. Drains the events received since the last tick
+	/// and applies them in the order they arrived, writing them out when recording. When replaying,
+	/// applies the recorded events for this tick instead and discards live ones.
+	/// </summary>
+	static void beginTick();
+
+	/// <summary>
+	/// Returns the events applied at the start of the current tick in the order they happened.
+	/// The Keyboard and Mouse tables only keep the net result of a tick, use this when
+	/// the order or timing of input within a tick matters.
+	/// </summary>
+	/// <returns></returns>
+	static const std::vector<InputEvent>& getTickEvents()
+	{
+		return mTickEvents;
+	}
+
+	/// <summary>
+	/// Returns the number of live events dropped because the queue was full.
+	/// </summary>
+	/// <returns></returns>
+	static uint64_t getDroppedCount()
+	{
+		return mDropped.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Called by the update loop after a tick runs. Clears the per-tick pressed and released states.
+	/// </summary>
+	static void endTick();
+
+	/// <summary>
+	/// Starts writing every tick's input to a file, after the keys, buttons, cursor and scroll held right now.
+	/// Stops any recording or replay in progress.
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns>False if the file could not be opened.</returns>
+	static bool startRecording(const std::string& path);
+
+	/// <summary>
+	/// Starts feeding a recorded session back, one tick at a time, starting with the next tick.
+	/// The Keyboard and Mouse tables are set to the state held when recording started, without any
+	/// presses, releases or moves for the first tick to see. Live input is ignored until the replay ends.
+	/// Stops any recording or replay in progress.
+	/// Combined with the fixed update tick, a replay drives the simulation exactly as the recorded session did,
+	/// as long as it starts from the same scene state and runs at the same tick rate.
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns>False if the file could not be read.</returns>
+	static bool startReplay(const std::string& path);
+
+	/// <summary>
+	/// Finishes a recording or abandons a replay.
+	/// </summary>
+	static void stop();
+
+	static bool isRecording()
+	{
+		return mRecorder.isRecording();
+	}
+
+	static bool isReplaying()
+	{
+		return mRecorder.isReplaying();
+	}
+
+	/// <summary>
+	/// Returns the number of ticks in the replay being played.
+	/// </summary>
+	/// <returns></returns>
+	static uint64_t getReplayLength()
+	{
+		return mRecorder.getReplayLength();
+	}
+
+	/// <summary>
+	/// Returns true when a replay is playing but has no recorded ticks left.
+	/// </summary>
+	/// <returns></returns>
+	static bool isReplayExhausted()
+	{
+		return mRecorder.isReplayExhausted();
+	}
+
+private:
+	static SpscQueue<InputEvent, INPUT_QUEUE_CAPACITY> mQueue;
+	static std::atomic<uint64_t> mDropped;
+	static uint64_t mReportedDrops;
+
+	static InputRecorder mRecorder;
+
+	// Events applied this tick.
+	static std::vector<InputEvent> mTickEvents;
+};
@@ -0,0 +1,331 @@
+#include "InputRecorder.h"
+
+#include <cstring>
+
+#include "Logger/StaticLogger.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+// Identifies an input recording and the layout it was written with.
+#define INPUT_RECORDING_MAGIC "TKIR"
+#define INPUT_RECORDING_VERSION 2
+
+// Stored in place of a tick number to mark the end of the recording.
+#define INPUT_RECORDING_END 0xFFFFFFFFFFFFFFFFull
+
+// Size of the end marker followed by the tick count.
+#define INPUT_RECORDING_FOOTER_SIZE 16
+
+// Size of the smallest stored event: a key or button event.
+#define INPUT_RECORDING_MIN_EVENT_SIZE 13
+
+namespace
+{
+	template<typename T>
+	void writeValue(std::ofstream& output, T value)
+	{
+		output.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	bool readValue(std::ifstream& input, T& value)
+	{
+		input.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return (bool)input;
+	}
+
+	bool isPointerEvent(InputEventType type)
+	{
+		return type == InputEventType::CURSOR_MOVE || type == InputEventType::SCROLL;
+	}
+}
+
+bool InputRecorder::startRecording(const std::string& path, uint32_t updateRate, const InputSnapshot& start)
+{
+	stop();
+	mOutput.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!mOutput.is_open())
+	{
+		StaticLogger::instance.warning("Could not open input recording: {string}", path.c_str());
+		return false;
+	}
+
+	mOutput.write(INPUT_RECORDING_MAGIC, 4);
+	writeValue<uint32_t>(mOutput, INPUT_RECORDING_VERSION);
+	writeValue<uint32_t>(mOutput, updateRate);
+
+	writeValue<uint32_t>(mOutput, (uint32_t)start.Keys.size());
+	for (size_t i = 0; i < start.Keys.size(); ++i)
+	{
+		writeValue<int32_t>(mOutput, start.Keys[i]);
+	}
+
+	writeValue<uint32_t>(mOutput, (uint32_t)start.Buttons.size());
+	for (size_t i = 0; i < start.Buttons.size(); ++i)
+	{
+		writeValue<int32_t>(mOutput, start.Buttons[i]);
+	}
+
+	writeValue<double>(mOutput, start.CursorX);
+	writeValue<double>(mOutput, start.CursorY);
+	writeValue<double>(mOutput, start.CursorDX);
+	writeValue<double>(mOutput, start.CursorDY);
+	writeValue<double>(mOutput, start.ScrollX);
+	writeValue<double>(mOutput, start.ScrollY);
+	writeValue<double>(mOutput, start.ScrollDX);
+	writeValue<double>(mOutput, start.ScrollDY);
+
+	mMode = Mode::RECORDING;
+	mPath = path;
+	mTick = 0;
+
+	StaticLogger::instance.trace("Recording input to {string}", path.c_str());
+	return true;
+}
+
+bool InputRecorder::startReplay(const std::string& path, uint32_t updateRate, InputSnapshot& start)
+{
+	stop();
+	mInput.open(path, std::ios::in | std::ios::binary);
+
+	if (!mInput.is_open())
+	{
+		StaticLogger::instance.warning("Could not open input recording: {string}", path.c_str());
+		return false;
+	}
+
+	char magic[4];
+	uint32_t version = 0;
+	uint32_t recordedRate = 0;
+
+	mInput.read(magic, 4);
+
+	if (!mInput || memcmp(magic, INPUT_RECORDING_MAGIC, 4) != 0
+		|| !readValue(mInput, version) || version != INPUT_RECORDING_VERSION
+		|| !readValue(mInput, recordedRate))
+	{
+		StaticLogger::instance.warning("Not a supported input recording: {string}", path.c_str());
+		mInput.close();
+		return false;
+	}
+
+	if (recordedRate != updateRate)
+	{
+		StaticLogger::instance.warning("Input recording was made at {int} ticks per second, replaying at {int}", recordedRate, updateRate);
+	}
+
+	// The tick count lives in the footer.
+	std::streampos header = mInput.tellg();
+	mInput.seekg(-(std::streamoff)INPUT_RECORDING_FOOTER_SIZE, std::ios::end);
+	mDataEnd = (std::streamoff)mInput.tellg();
+
+	uint64_t endMarker = 0;
+
+	if (!mInput || mDataEnd < (std::streamoff)header
+		|| !readValue(mInput, endMarker) || endMarker != INPUT_RECORDING_END
+		|| !readValue(mInput, mReplayLength))
+	{
+		StaticLogger::instance.warning("Input recording is truncated: {string}", path.c_str());
+		mInput.close();
+		return false;
+	}
+
+	mInput.seekg(header);
+
+	if (!readSnapshot(start) || (std::streamoff)mInput.tellg() > mDataEnd)
+	{
+		StaticLogger::instance.warning("Input recording has an invalid starting state: {string}", path.c_str());
+		mInput.close();
+		return false;
+	}
+
+	mMode = Mode::REPLAYING;
+	mPath = path;
+	mTick = 0;
+	readNextTick();
+
+	StaticLogger::instance.trace("Replaying {long} ticks of input from {string}", mReplayLength, path.c_str());
+	return true;
+}
+
+void InputRecorder::recordTick(const std::vector<InputEvent>& events)
+{
+	if (mMode != Mode::RECORDING)
+	{
+		return;
+	}
+
+	if (!events.empty())
+	{
+		writeValue<uint64_t>(mOutput, mTick);
+		writeValue<uint32_t>(mOutput, (uint32_t)events.size());
+
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			const InputEvent& event = events[i];
+
+			writeValue<uint8_t>(mOutput, (uint8_t)event.Type);
+			writeValue<uint64_t>(mOutput, event.TimeNanos);
+
+			if (isPointerEvent(event.Type))
+			{
+				writeValue<double>(mOutput, event.X);
+				writeValue<double>(mOutput, event.Y);
+			}
+			else
+			{
+				writeValue<int32_t>(mOutput, event.Code);
+			}
+		}
+	}
+
+	mTick++;
+}
+
+bool InputRecorder::replayTick(std::vector<InputEvent>& events)
+{
+	events.clear();
+
+	if (mMode != Mode::REPLAYING)
+	{
+		return false;
+	}
+
+	if (mTick >= mReplayLength)
+	{
+		StaticLogger::instance.trace("Input replay finished after {long} ticks", mTick);
+		stop();
+		return false;
+	}
+
+	if (mHasNextTick && mNextTick == mTick)
+	{
+		uint32_t count = 0;
+		bool valid = readValue(mInput, count);
+
+		// Never trust the count further than the bytes actually left before the footer.
+		std::streamoff remaining = mDataEnd - (std::streamoff)mInput.tellg();
+		valid = valid && remaining >= 0
+			&& (uint64_t)count <= (uint64_t)remaining / INPUT_RECORDING_MIN_EVENT_SIZE;
+
+		if (valid)
+		{
+			events.resize(count);
+
+			for (uint32_t i = 0; valid && i < count; ++i)
+			{
+				valid = readEvent(events[i]);
+			}
+		}
+
+		if (!valid)
+		{
+			StaticLogger::instance.warning("Input recording is corrupt at tick {long}: {string}", mTick, mPath.c_str());
+			events.clear();
+			stop();
+			return false;
+		}
+
+		readNextTick();
+	}
+
+	mTick++;
+	return true;
+}
+
+void InputRecorder::stop()
+{
+	if (mMode == Mode::RECORDING)
+	{
+		writeValue<uint64_t>(mOutput, INPUT_RECORDING_END);
+		writeValue<uint64_t>(mOutput, mTick);
+		mOutput.close();
+
+		StaticLogger::instance.trace("Recorded {long} ticks of input to {string}", mTick, mPath.c_str());
+	}
+	else if (mMode == Mode::REPLAYING)
+	{
+		mInput.close();
+	}
+
+	mMode = Mode::IDLE;
+}
+
+void InputRecorder::readNextTick()
+{
+	uint64_t tick = INPUT_RECORDING_END;
+	mHasNextTick = readValue(mInput, tick) && tick != INPUT_RECORDING_END;
+	mNextTick = tick;
+}
+
+bool InputRecorder::readEvent(InputEvent& event)
+{
+	uint8_t type = 0;
+
+	if (!readValue(mInput, type) || !readValue(mInput, event.TimeNanos)
+		|| type > (uint8_t)InputEventType::SCROLL)
+	{
+		return false;
+	}
+
+	event.Type = (InputEventType)type;
+	event.Code = 0;
+	event.X = 0;
+	event.Y = 0;
+
+	if (isPointerEvent(event.Type))
+	{
+		return readValue(mInput, event.X) && readValue(mInput, event.Y);
+	}
+
+	if (!readValue(mInput, event.Code))
+	{
+		return false;
+	}
+
+	if (event.Type == InputEventType::KEY_PRESS || event.Type == InputEventType::KEY_RELEASE)
+	{
+		return event.Code >= 0 && event.Code < KEY_COUNT;
+	}
+
+	return event.Code >= 0 && event.Code < BUTTON_COUNT;
+}
+
+bool InputRecorder::readSnapshot(InputSnapshot& snapshot)
+{
+	uint32_t count = 0;
+
+	if (!readValue(mInput, count) || count > KEY_COUNT)
+	{
+		return false;
+	}
+
+	snapshot.Keys.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (!readValue(mInput, snapshot.Keys[i]) || snapshot.Keys[i] < 0 || snapshot.Keys[i] >= KEY_COUNT)
+		{
+			return false;
+		}
+	}
+
+	if (!readValue(mInput, count) || count > BUTTON_COUNT)
+	{
+		return false;
+	}
+
+	snapshot.Buttons.resize(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (!readValue(mInput, snapshot.Buttons[i]) || snapshot.Buttons[i] < 0 || snapshot.Buttons[i] >= BUTTON_COUNT)
+		{
+			return false;
+		}
+	}
+
+	return readValue(mInput, snapshot.CursorX) && readValue(mInput, snapshot.CursorY)
+		&& readValue(mInput, snapshot.CursorDX) && readValue(mInput, snapshot.CursorDY)
+		&& readValue(mInput, snapshot.ScrollX) && readValue(mInput, snapshot.ScrollY)
+		&& readValue(mInput, snapshot.ScrollDX) && readValue(mInput, snapshot.ScrollDY);
+}
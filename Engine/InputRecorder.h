@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Kinds of input the engine reacts to.
+/// </summary>
+enum class InputEventType : uint8_t
+{
+	KEY_PRESS,
+	KEY_RELEASE,
+	BUTTON_PRESS,
+	BUTTON_RELEASE,
+	CURSOR_MOVE,
+	SCROLL
+};
+
+/// <summary>
+/// One input event. Keys and buttons use Code, cursor and scroll events use X and Y.
+/// </summary>
+struct InputEvent
+{
+	InputEventType Type;
+	int32_t Code;
+	double X;
+	double Y;
+
+	/// <summary>
+	/// Engine time at which the event was received.
+	/// </summary>
+	uint64_t TimeNanos;
+};
+
+/// <summary>
+/// Keyboard and mouse state held when a recording starts. Restored before a replay's first tick
+/// as it was, without registering presses or moves, so the replay sees the same edges and deltas.
+/// </summary>
+struct InputSnapshot
+{
+	InputSnapshot()
+		:CursorX(0), CursorY(0), CursorDX(0), CursorDY(0),
+		ScrollX(0), ScrollY(0), ScrollDX(0), ScrollDY(0)
+	{}
+
+	// Keys and buttons held down.
+	std::vector<int32_t> Keys;
+	std::vector<int32_t> Buttons;
+
+	// Positions along with the movement of the last move, which stays visible until the next one.
+	double CursorX;
+	double CursorY;
+	double CursorDX;
+	double CursorDY;
+	double ScrollX;
+	double ScrollY;
+	double ScrollDX;
+	double ScrollDY;
+};
+
+/// <summary>
+/// Reads and writes per tick input to a compact binary file.
+/// The header is followed by the snapshot of the input held when recording started: the key count
+/// and keys, the button count and buttons, then the cursor and scroll values.
+/// Only ticks that received input are stored: each as its tick number relative to the start of the
+/// recording, the event count, then the events. Key and button events take 13 bytes, cursor and
+/// scroll events 25. The file ends with a marker and the total number of ticks recorded.
+/// </summary>
+class InputRecorder
+{
+public:
+	InputRecorder()
+		:mMode(Mode::IDLE),
+		mTick(0),
+		mReplayLength(0),
+		mDataEnd(0),
+		mNextTick(0),
+		mHasNextTick(false)
+	{}
+
+	~InputRecorder()
+	{
+		stop();
+	}
+
+	/// <summary>
+	/// Creates a recording starting from the given input state.
+	/// </summary>
+	/// <param name="path"></param>
+	/// <param name="updateRate"></param>
+	/// <param name="start">Input held when the recording starts.</param>
+	/// <returns></returns>
+	bool startRecording(const std::string& path, uint32_t updateRate, const InputSnapshot& start);
+
+	/// <summary>
+	/// Opens a recording for replay.
+	/// </summary>
+	/// <param name="path"></param>
+	/// <param name="updateRate">Warns if the recording was made at a different tick rate.</param>
+	/// <param name="start">Receives the input held when the recording started.</param>
+	/// <returns></returns>
+	bool startReplay(const std::string& path, uint32_t updateRate, InputSnapshot& start);
+
+	/// <summary>
+	/// Stores the events received during the next tick.
+	/// </summary>
+	/// <param name="events"></param>
+	void recordTick(const std::vector<InputEvent>& events);
+
+	/// <summary>
+	/// Fills events with the input recorded for the next tick.
+	/// </summary>
+	/// <param name="events"></param>
+	/// <returns>False once the replay is over, at which point the recorder goes idle.</returns>
+	bool replayTick(std::vector<InputEvent>& events);
+
+	/// <summary>
+	/// Finishes the file being recorded or closes the replay.
+	/// </summary>
+	void stop();
+
+	bool isRecording() const
+	{
+		return mMode == Mode::RECORDING;
+	}
+
+	bool isReplaying() const
+	{
+		return mMode == Mode::REPLAYING;
+	}
+
+	uint64_t getReplayLength() const
+	{
+		return mReplayLength;
+	}
+
+	/// <summary>
+	/// Returns true once every recorded tick has been replayed. The recorder only goes idle on the
+	/// following call to replayTick, so check this before running another tick.
+	/// </summary>
+	/// <returns></returns>
+	bool isReplayExhausted() const
+	{
+		return mMode == Mode::REPLAYING && mTick >= mReplayLength;
+	}
+
+private:
+	enum class Mode
+	{
+		IDLE,
+		RECORDING,
+		REPLAYING
+	};
+
+	/// <summary>
+	/// Reads the tick number of the next stored tick, or notes that none are left.
+	/// </summary>
+	void readNextTick();
+
+	/// <summary>
+	/// Reads one stored event, rejecting unknown types and codes outside the key and button tables.
+	/// </summary>
+	/// <param name="event"></param>
+	/// <returns>False if the event could not be read or is invalid.</returns>
+	bool readEvent(InputEvent& event);
+
+	/// <summary>
+	/// Reads the starting snapshot, rejecting codes outside the key and button tables.
+	/// </summary>
+	/// <param name="snapshot"></param>
+	/// <returns>False if the snapshot could not be read or is invalid.</returns>
+	bool readSnapshot(InputSnapshot& snapshot);
+
+	Mode mMode;
+	std::ofstream mOutput;
+	std::ifstream mInput;
+	std::string mPath;
+
+	// Ticks recorded or replayed so far.
+	uint64_t mTick;
+
+	uint64_t mReplayLength;
+
+	// Offset of the footer; stored ticks never extend past it.
+	std::streamoff mDataEnd;
+
+	uint64_t mNextTick;
+	bool mHasNextTick;
+};
@@ -160,11 +160,19 @@ class Keyboard {
             memset(keyClicked, 0, sizeof(keyClicked));
         }
 
+        /**
+         * Releases every key without marking any as clicked
+         * */
+        static void reset() {
+            memset(keyState, 0, sizeof(keyState));
+            update();
+        }
+
         /**
          * Determines if the key was pressed this frame
          * */
         static bool isKeyPressed(int key) {
-            if(key < KEY_COUNT) {
+            if(key >= 0 && key < KEY_COUNT) {
                 return keyPressed[key];
             }
 
@@ -175,7 +183,7 @@ class Keyboard {
          * returns if a key is down
          * */
         static bool isKeyDown(int key) {
-            if(key < KEY_COUNT) {
+            if(key >= 0 && key < KEY_COUNT) {
                 return keyState[key];
             }
 
@@ -186,7 +194,7 @@ class Keyboard {
          * returns if a key is up
          * */
         static bool isKeyUp(int key) {
-            if(key < KEY_COUNT) {
+            if(key >= 0 && key < KEY_COUNT) {
                 return !keyState[key];
             }
 
@@ -197,7 +205,7 @@ class Keyboard {
          * updates the state of a key
          * */
         static void pressKey(int key) {
-            if(key < KEY_COUNT) {
+            if(key >= 0 && key < KEY_COUNT) {
                 if(!keyState[key]) {
                     keyPressed[key] = true;
                 }
@@ -206,18 +214,27 @@ class Keyboard {
             }
         }
 
+        /**
+         * Marks a key as held without registering a press, used to restore a saved state
+         * */
+        static void holdKey(int key) {
+            if(key >= 0 && key < KEY_COUNT) {
+                keyState[key] = true;
+            }
+        }
+
         /**
          * updates the state of a key
          * */
         static void releaseKey(int key) {
-            if(key < KEY_COUNT) {
+            if(key >= 0 && key < KEY_COUNT) {
                 keyClicked[key] = true;
                 keyState[key] = false;
             }
         }
 
         static bool isKeyClicked(int key) {
-            if(key < KEY_COUNT) {
+            if(key >= 0 && key < KEY_COUNT) {
                 return keyClicked[key];
             }
 
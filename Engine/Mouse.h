@@ -54,6 +54,16 @@ public:
 		memset(clickedState, 0, sizeof(clickedState));
 	}
 
+	/**
+	 * Releases every button and moves the cursor and scroll back to the origin
+	 * */
+	static void reset() {
+		memset(mouseState, 0, sizeof(mouseState));
+		update();
+		posx = posy = posdx = posdy = 0;
+		scrollx = scrolly = scrolldx = scrolldy = 0;
+	}
+
 	static double getPosX() {
 		return posx;
 	}
@@ -79,7 +89,7 @@ public:
 	}
 
 	static double getScrollDX() {
-		return scrolldy;
+		return scrolldx;
 	}
 
 	static double getScrollDY() {
@@ -96,11 +106,31 @@ public:
 		scrolly = y;
 	}
 
+	/**
+	 * Sets the position and last movement of the cursor without registering a move, used to restore a saved state
+	 * */
+	static void setPos(double x, double y, double dx, double dy) {
+		posx = x;
+		posy = y;
+		posdx = dx;
+		posdy = dy;
+	}
+
+	/**
+	 * Sets the scroll and its last change without registering a scroll, used to restore a saved state
+	 * */
+	static void setScroll(double x, double y, double dx, double dy) {
+		scrollx = x;
+		scrolly = y;
+		scrolldx = dx;
+		scrolldy = dy;
+	}
+
 	/**
 	 * returns if a mouse button is up
 	 * */
 	static bool isButtonUp(int button) {
-		if (button < BUTTON_COUNT) {
+		if (button >= 0 && button < BUTTON_COUNT) {
 			return !mouseState[button];
 		}
 
@@ -111,7 +141,7 @@ public:
 	 * returns if a mouse button is down
 	 * */
 	static bool isButtonDown(int button) {
-		if (button < BUTTON_COUNT) {
+		if (button >= 0 && button < BUTTON_COUNT) {
 			return mouseState[button];
 		}
 
@@ -122,7 +152,7 @@ public:
 	 * Returns if the button was released this frame
 	 * */
 	static bool isButtonClicked(int button) {
-		if (button < BUTTON_COUNT) {
+		if (button >= 0 && button < BUTTON_COUNT) {
 			return clickedState[button];
 		}
 
@@ -133,7 +163,7 @@ public:
 	 * updates the state of a mouse button
 	 * */
 	static void pressButton(int button) {
-		if (button < BUTTON_COUNT) {
+		if (button >= 0 && button < BUTTON_COUNT) {
 			if (!mouseState[button]) {
 				pressedState[button] = true;
 			}
@@ -142,11 +172,20 @@ public:
 		}
 	}
 
+	/**
+	 * Marks a button as held without registering a press, used to restore a saved state
+	 * */
+	static void holdButton(int button) {
+		if (button >= 0 && button < BUTTON_COUNT) {
+			mouseState[button] = true;
+		}
+	}
+
 	/**
 	 * Udpates the state of a mouse button
 	 * */
 	static void releaseButton(int button) {
-		if (button < BUTTON_COUNT) {
+		if (button >= 0 && button < BUTTON_COUNT) {
 			clickedState[button] = true;
 			mouseState[button] = false;
 		}
@@ -157,7 +196,7 @@ public:
 	 * Resets at the end of the frame
 	 * */
 	static bool isButtonPressed(int button) {
-		if (button < BUTTON_COUNT) {
+		if (button >= 0 && button < BUTTON_COUNT) {
 			return pressedState[button];
 		}
 
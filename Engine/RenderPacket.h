@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Component.h"
+#include "ResourceHandle.h"
+
+class Mesh;
+class Texture;
+
+/// <summary>
+/// Everything the render thread needs to draw one renderable entity.
+/// Holds the transform at the previous and latest update tick so the renderer can blend between them.
+/// Items that did not move this tick carry their world matrix so the renderer can skip the blend.
+/// The mesh and texture are handles, resolved on the render thread, which skips items whose resources are not loaded.
+/// </summary>
+struct RenderItem
+{
+	TransformState Previous;
+	TransformState Current;
+	Matrix44f Model;
+	bool Moving;
+	ResourceHandle<Mesh> Geometry;
+	ResourceHandle<Texture> Diffuse;
+};
+
+/// <summary>
+/// The camera as seen by the render thread.
+/// </summary>
+struct RenderView
+{
+	RenderView()
+		:Active(false)
+	{}
+
+	TransformState Previous;
+	TransformState Current;
+	bool Active;
+};
+
+/// <summary>
+/// Immutable snapshot of a scene produced at the end of an update tick.
+/// The update thread fills one in, the render thread draws from another, so neither
+/// ever touches the other's entities.
+/// </summary>
+struct RenderPacket
+{
+	RenderPacket()
+		:Tick(0),
+		TickNanos(0)
+	{}
+
+	/// <summary>
+	/// Empties the packet while keeping its storage for the next tick.
+	/// </summary>
+	void clear()
+	{
+		Items.clear();
+		View = RenderView();
+	}
+
+	std::vector<RenderItem> Items;
+	RenderView View;
+
+	/// <summary>
+	/// Which update tick produced this packet and the engine time that tick represents.
+	/// </summary>
+	uint64_t Tick;
+	uint64_t TickNanos;
+};
@@ -0,0 +1,52 @@
+#include "RenderPacketRecorder.h"
+
+#include "Logger/StaticLogger.h"
+
+bool RenderPacketRecorder::open(const std::string& path)
+{
+	close();
+	mOutput.open(path, std::ios::out | std::ios::trunc);
+
+	if (!mOutput.is_open())
+	{
+		StaticLogger::instance.warning("Could not open render packet recording: {string}", path.c_str());
+		return false;
+	}
+
+	mOutput << "tick,tick_nanos,items,moving,view_x,view_y,view_z\n";
+	mRecorded = 0;
+	return true;
+}
+
+void RenderPacketRecorder::record(const RenderPacket& packet)
+{
+	if (!mOutput.is_open())
+	{
+		return;
+	}
+
+	size_t moving = 0;
+	for (size_t i = 0; i < packet.Items.size(); ++i)
+	{
+		if (packet.Items[i].Moving)
+		{
+			moving++;
+		}
+	}
+
+	const Vector3f& view = packet.View.Current.Position;
+
+	mOutput << packet.Tick << ',' << packet.TickNanos << ','
+		<< packet.Items.size() << ',' << moving << ','
+		<< view.x << ',' << view.y << ',' << view.z << '\n';
+
+	mRecorded++;
+}
+
+void RenderPacketRecorder::close()
+{
+	if (mOutput.is_open())
+	{
+		mOutput.close();
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "RenderPacket.h"
+
+/// <summary>
+/// Stand-in for the render thread when the engine runs without a window.
+/// Writes one CSV line per render packet so a headless run can be checked or diffed afterwards.
+/// </summary>
+class RenderPacketRecorder
+{
+public:
+	RenderPacketRecorder()
+		:mRecorded(0)
+	{}
+
+	~RenderPacketRecorder()
+	{
+		close();
+	}
+
+	/// <summary>
+	/// Opens the output file and writes the column header.
+	/// </summary>
+	/// <param name="path"></param>
+	/// <returns>False if the file could not be opened.</returns>
+	bool open(const std::string& path);
+
+	/// <summary>
+	/// Appends one line describing the packet. Does nothing if no file is open.
+	/// </summary>
+	/// <param name="packet"></param>
+	void record(const RenderPacket& packet);
+
+	void close();
+
+	bool isOpen() const
+	{
+		return mOutput.is_open();
+	}
+
+	uint64_t getRecordedCount() const
+	{
+		return mRecorded;
+	}
+
+private:
+	std::ofstream mOutput;
+	uint64_t mRecorded;
+};
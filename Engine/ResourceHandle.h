@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#define INVALID_RESOURCE_INDEX 0xFFFFFFFF
+
+/// <summary>
+/// A reference to a resource in a ResourceManager, resolved by index instead of by name.
+/// Get one by name once, at load or init time, and resolve it with ResourceManager::get wherever the resource is used.
+/// The generation is bumped every time a resource is removed, so a handle to a removed resource
+/// resolves to nullptr instead of to whatever resource took its slot.
+/// Eviction keeps the slot and its generation: the handle stays valid, resolves to nullptr until
+/// the reload its first lookup starts has finished, then resolves to the reloaded resource.
+/// ResourceManager::getVersion goes up with every reload.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+template<typename T>
+struct ResourceHandle
+{
+	ResourceHandle()
+		:Index(INVALID_RESOURCE_INDEX),
+		Generation(0)
+	{}
+
+	ResourceHandle(uint32_t index, uint32_t generation)
+		:Index(index),
+		Generation(generation)
+	{}
+
+	bool isNull() const
+	{
+		return Index == INVALID_RESOURCE_INDEX;
+	}
+
+	bool operator==(const ResourceHandle<T>& other) const
+	{
+		return Index == other.Index && Generation == other.Generation;
+	}
+
+	bool operator!=(const ResourceHandle<T>& other) const
+	{
+		return !(*this == other);
+	}
+
+	uint32_t Index;
+	uint32_t Generation;
+};
@@ -1,73 +1,735 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "../Logger/StaticLogger.h"
+#include "ResourceHandle.h"
 
 #define RESOURCE_ALREADY_REGISTERED_WARNING "{string}: Resource already registered {string}"
 #define RESOURCE_NOT_REGISTERED_ERROR "{string}: Resource not registered {string}"
+#define RESOURCE_LIMIT_ERROR "{string}: Too many resources, could not register {string}"
+
+// Slots are added in chunks that never move, so handles resolve without taking a lock.
+#define RESOURCE_SLOTS_PER_CHUNK 256
+#define RESOURCE_MAX_CHUNKS 256
+
+// Frames an evicted resource waits after a failed reload before asking its reloader again.
+#define RESOURCE_RELOAD_RETRY_FRAMES 60
+
+/// <summary>
+/// Memory a resource takes up while it is loaded.
+/// </summary>
+struct ResourceSize
+{
+	ResourceSize(uint64_t cpuBytes = 0, uint64_t gpuBytes = 0)
+		:CpuBytes(cpuBytes),
+		GpuBytes(gpuBytes)
+	{}
+
+	uint64_t CpuBytes;
+	uint64_t GpuBytes;
+};
+
+/// <summary>
+/// What a resource manager holds and how residency has behaved so far.
+/// </summary>
+struct ResidencyStats
+{
+	uint32_t Registered;
+	uint32_t Resident;
+	uint64_t CpuBytes;
+	uint64_t GpuBytes;
+	uint64_t BudgetBytes;
+	uint64_t Evictions;
+	uint64_t Reloads;
+};
 
 /// <summary>
 /// Class responsible for managing global resources.
 /// This class assumes ownership of all resources passed to it.
 /// Textures, Meshes, ShaderPrograms
+/// Resources live in a dense array of slots. Look one up by name once to get a handle,
+/// then resolve the handle with get, which is an index and a generation check.
+/// Registries may be added from the render thread while other threads look them up.
+/// Reload, remove and evict resources on the thread that uses them, the render thread for anything
+/// with GPU data, so no pointer it resolved earlier in the frame is destroyed under it.
+///
+/// With a memory budget set, resources that know how to reload themselves and that nothing holds
+/// a reference to are evicted least recently used first once the manager goes over budget.
+/// Their handles stay valid: get returns null until the resource has been reloaded, and asking
+/// for it is what starts the reload.
 /// <author>Bryce Young 1/24/2022</author>
 /// </summary>
 template<typename T>
 class ResourceManager
 {
 public:
-	ResourceManager(const std::string& resourceTypeName) 
+	/// <summary>
+	/// Loads an evicted resource again and hands it back through restore.
+	/// Called when an evicted resource is asked for, from whichever thread asked.
+	/// </summary>
+	typedef std::function<void(const ResourceHandle<T>&)> Reloader;
+
+	ResourceManager(const std::string& resourceTypeName)
 		:mRegistries(),
-		mResourceTypeName(resourceTypeName)
+		mResourceTypeName(resourceTypeName),
+		mSlotCount(0),
+		mFrame(1),
+		mCpuBytes(0),
+		mGpuBytes(0),
+		mBudgetBytes(0),
+		mEvictions(0),
+		mReloads(0)
 	{}
 
 	~ResourceManager() {}
 
+	ResourceManager(const ResourceManager&) = delete;
+	ResourceManager& operator=(const ResourceManager&) = delete;
+
 	/// <summary>
 	/// Adds resource registry by name.
 	/// </summary>
 	/// <param name="name"></param>
 	/// <param name="registry"></param>
-	void addRegistry(const std::string& name, std::unique_ptr<T> registry)
+	/// <param name="size">Memory the resource takes up, counted against the budget.</param>
+	/// <param name="reloader">How to load the resource again. Resources without one are never evicted.</param>
+	/// <returns>Null if the name was already taken, in which case the resource is destroyed.</returns>
+	ResourceHandle<T> addRegistry(const std::string& name, std::unique_ptr<T> registry,
+		const ResourceSize& size = ResourceSize(), const Reloader& reloader = Reloader())
 	{
-		if (mRegistries.find(name) == mRegistries.end())
-		{
-			mRegistries[name] = std::move(registry);
-		}
-		else 
+		std::lock_guard<std::mutex> guard(mLock);
+
+		if (mRegistries.find(name) != mRegistries.end())
 		{
 			StaticLogger::instance.warning(RESOURCE_ALREADY_REGISTERED_WARNING,
 				mResourceTypeName.c_str(), name.c_str());
+			return ResourceHandle<T>();
 		}
+
+		uint32_t index;
+
+		if (!mFreeSlots.empty())
+		{
+			index = mFreeSlots.back();
+			mFreeSlots.pop_back();
+		}
+		else
+		{
+			index = mSlotCount.load(std::memory_order_relaxed);
+
+			if (index >= RESOURCE_SLOTS_PER_CHUNK * RESOURCE_MAX_CHUNKS)
+			{
+				StaticLogger::instance.error(RESOURCE_LIMIT_ERROR, mResourceTypeName.c_str(), name.c_str());
+				return ResourceHandle<T>();
+			}
+
+			std::unique_ptr<Slot[]>& chunk = mChunks[index / RESOURCE_SLOTS_PER_CHUNK];
+
+			if (chunk == nullptr)
+			{
+				chunk.reset(new Slot[RESOURCE_SLOTS_PER_CHUNK]);
+			}
+
+			// Publishes the chunk to readers, who check the count first.
+			mSlotCount.store(index + 1, std::memory_order_release);
+		}
+
+		Slot& slot = getSlot(index);
+		slot.Name = name;
+		slot.Size = size;
+		slot.Load = reloader;
+		slot.LastUsed.store(mFrame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		slot.Owner = std::move(registry);
+		slot.Resource.store(slot.Owner.get(), std::memory_order_release);
+
+		mCpuBytes += size.CpuBytes;
+		mGpuBytes += size.GpuBytes;
+
+		mRegistries[name] = index;
+		return ResourceHandle<T>(index, slot.Generation.load(std::memory_order_relaxed));
 	}
 
 	/// <summary>
 	/// Returns resource registry by name.
+	/// Looks the name up every call, prefer getHandle and get for anything done every frame.
 	/// </summary>
 	/// <param name="name"></param>
 	/// <returns></returns>
 	T* getRegistry(const std::string& name)
 	{
+		return get(getHandle(name));
+	}
+
+	/// <summary>
+	/// Returns a handle to a resource by name, or a null handle if there is no such resource.
+	/// </summary>
+	/// <param name="name"></param>
+	/// <returns></returns>
+	ResourceHandle<T> getHandle(const std::string& name)
+	{
+		std::lock_guard<std::mutex> guard(mLock);
 		auto value = mRegistries.find(name);
 
 		if (value == mRegistries.end())
 		{
 			StaticLogger::instance.error(RESOURCE_NOT_REGISTERED_ERROR,
 				mResourceTypeName.c_str(), name.c_str());
+			return ResourceHandle<T>();
+		}
+
+		return ResourceHandle<T>(value->second, getSlot(value->second).Generation.load(std::memory_order_relaxed));
+	}
+
+	/// <summary>
+	/// Resolves a handle without taking a lock or touching the name, and marks the resource as used this frame.
+	/// An evicted resource is reloaded in the background the first time it is asked for.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns>Null if the handle is invalid or the resource is not loaded right now.</returns>
+	T* get(const ResourceHandle<T>& handle)
+	{
+		Slot* slot = findSlot(handle);
+
+		if (slot == nullptr)
+		{
+			return nullptr;
+		}
+
+		T* resource = slot->Resource.load(std::memory_order_acquire);
+
+		if (resource == nullptr)
+		{
+			if (slot->Evicted.load(std::memory_order_acquire)
+				&& mFrame.load(std::memory_order_relaxed) >= slot->RetryFrame.load(std::memory_order_relaxed)
+				&& !slot->ReloadRequested.exchange(true))
+			{
+				requestReload(handle);
+			}
+
+			return nullptr;
+		}
+
+		slot->LastUsed.store(mFrame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return resource;
+	}
+
+	/// <summary>
+	/// Returns true while the handle's resource is registered, whether or not it is loaded right now.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns></returns>
+	bool isValid(const ResourceHandle<T>& handle) const
+	{
+		return findSlot(handle) != nullptr;
+	}
+
+	/// <summary>
+	/// Returns true if the handle's resource is loaded right now.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns></returns>
+	bool isResident(const ResourceHandle<T>& handle) const
+	{
+		const Slot* slot = findSlot(handle);
+		return slot != nullptr && slot->Resource.load(std::memory_order_acquire) != nullptr;
+	}
+
+	/// <summary>
+	/// Returns how many times the handle's resource has been reloaded, 0 if the handle is no longer valid.
+	/// Anything built from a resource can keep the version it was built from and compare to detect a reload.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns></returns>
+	uint32_t getVersion(const ResourceHandle<T>& handle) const
+	{
+		const Slot* slot = findSlot(handle);
+		return slot == nullptr ? 0 : slot->Version.load(std::memory_order_acquire);
+	}
+
+	/// <summary>
+	/// Keeps a resource from being evicted until the reference is released.
+	/// Safe from any thread. ResourceRef does this for as long as it lives.
+	/// </summary>
+	/// <param name="handle"></param>
+	void addReference(const ResourceHandle<T>& handle)
+	{
+		Slot* slot = findSlot(handle);
+
+		if (slot != nullptr)
+		{
+			slot->References.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void releaseReference(const ResourceHandle<T>& handle)
+	{
+		Slot* slot = findSlot(handle);
+
+		if (slot != nullptr)
+		{
+			slot->References.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	/// <summary>
+	/// Returns the number of live references to a resource.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns></returns>
+	int32_t getReferenceCount(const ResourceHandle<T>& handle) const
+	{
+		const Slot* slot = findSlot(handle);
+		return slot == nullptr ? 0 : slot->References.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Replaces a resource in place, destroying the old one. Handles to it stay valid and resolve to the new resource.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <param name="registry"></param>
+	/// <param name="size">Memory the new resource takes up.</param>
+	/// <returns>False if the handle is no longer valid, in which case the new resource is destroyed.</returns>
+	bool reload(const ResourceHandle<T>& handle, std::unique_ptr<T> registry, const ResourceSize& size = ResourceSize())
+	{
+		std::unique_ptr<T> previous;
+
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			Slot* slot = findSlot(handle);
+
+			if (slot == nullptr)
+			{
+				return false;
+			}
+
+			// A resource reloaded by hand while evicted is simply resident again.
+			slot->Evicted.store(false, std::memory_order_relaxed);
+			slot->ReloadRequested.store(false, std::memory_order_relaxed);
+
+			previous = std::move(slot->Owner);
+			store(*slot, std::move(registry), size);
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Puts a reloaded resource back into its slot after an eviction.
+	/// Called by the reloader, on the thread that owns the resource's GPU data.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <param name="registry"></param>
+	/// <param name="size"></param>
+	/// <returns>False if the resource was removed or loaded again in the meantime.</returns>
+	bool restore(const ResourceHandle<T>& handle, std::unique_ptr<T> registry, const ResourceSize& size)
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		Slot* slot = findSlot(handle);
+
+		if (slot == nullptr || !slot->Evicted.load(std::memory_order_relaxed))
+		{
+			return false;
+		}
+
+		slot->Evicted.store(false, std::memory_order_relaxed);
+		slot->ReloadRequested.store(false, std::memory_order_relaxed);
+		slot->LastUsed.store(mFrame.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		store(*slot, std::move(registry), size);
+		mReloads++;
+		return true;
+	}
+
+	/// <summary>
+	/// Lets a resource whose reload failed be asked for again. The resource stays evicted, and the reloader
+	/// is only run again once RESOURCE_RELOAD_RETRY_FRAMES have passed, so a missing file is not read every frame.
+	/// Called by the reloader.
+	/// </summary>
+	/// <param name="handle"></param>
+	void reloadFailed(const ResourceHandle<T>& handle)
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		Slot* slot = findSlot(handle);
+
+		if (slot == nullptr || !slot->Evicted.load(std::memory_order_relaxed))
+		{
+			return;
+		}
+
+		slot->RetryFrame.store(mFrame.load(std::memory_order_relaxed) + RESOURCE_RELOAD_RETRY_FRAMES, std::memory_order_relaxed);
+		slot->ReloadRequested.store(false, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Destroys a resource and frees its name and slot. Every handle to it resolves to null from now on.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns>False if the handle was already invalid.</returns>
+	bool remove(const ResourceHandle<T>& handle)
+	{
+		std::unique_ptr<T> previous;
+		Reloader load;
+
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			Slot* slot = findSlot(handle);
+
+			if (slot == nullptr)
+			{
+				return false;
+			}
+
+			// Retire the handles before the pointer goes away.
+			slot->Generation.fetch_add(1, std::memory_order_release);
+			slot->Resource.store(nullptr, std::memory_order_release);
+			slot->Version.store(0, std::memory_order_relaxed);
+			slot->References.store(0, std::memory_order_relaxed);
+			slot->Evicted.store(false, std::memory_order_relaxed);
+			slot->ReloadRequested.store(false, std::memory_order_relaxed);
+
+			if (slot->Owner != nullptr)
+			{
+				mCpuBytes -= slot->Size.CpuBytes;
+				mGpuBytes -= slot->Size.GpuBytes;
+			}
+
+			previous = std::move(slot->Owner);
+			load = std::move(slot->Load);
+			mRegistries.erase(slot->Name);
+			slot->Name.clear();
+			mFreeSlots.push_back(handle.Index);
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Sets the most memory, CPU and GPU together, the manager's resources should take up.
+	/// </summary>
+	/// <param name="bytes">0 for no budget, nothing is ever evicted.</param>
+	void setMemoryBudget(uint64_t bytes)
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		mBudgetBytes = bytes;
+	}
+
+	uint64_t getMemoryBudget()
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		return mBudgetBytes;
+	}
+
+	/// <summary>
+	/// Starts a new frame for the least recently used order and evicts resources until the manager is within its budget.
+	/// Only unreferenced resources with a reloader that were not used in the previous frame are evicted.
+	/// Called once per frame by the thread that owns the resources' GPU data.
+	/// </summary>
+	/// <returns>The number of resources evicted.</returns>
+	uint32_t evictUnused()
+	{
+		std::vector<std::unique_ptr<T>> evicted;
+
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			uint64_t frame = mFrame.fetch_add(1, std::memory_order_relaxed);
+
+			if (mBudgetBytes == 0 || mCpuBytes + mGpuBytes <= mBudgetBytes)
+			{
+				return 0;
+			}
+
+			mCandidates.clear();
+
+			for (auto i = mRegistries.begin(); i != mRegistries.end(); ++i)
+			{
+				Slot& slot = getSlot(i->second);
+				uint64_t lastUsed = slot.LastUsed.load(std::memory_order_relaxed);
+
+				if (slot.Owner != nullptr && slot.Load && lastUsed < frame &&
+					slot.References.load(std::memory_order_relaxed) <= 0)
+				{
+					mCandidates.push_back(std::make_pair(lastUsed, i->second));
+				}
+			}
+
+			std::sort(mCandidates.begin(), mCandidates.end());
+
+			for (size_t i = 0; i < mCandidates.size() && mCpuBytes + mGpuBytes > mBudgetBytes; ++i)
+			{
+				Slot& slot = getSlot(mCandidates[i].second);
+
+				slot.Resource.store(nullptr, std::memory_order_release);
+				slot.ReloadRequested.store(false, std::memory_order_relaxed);
+				slot.Evicted.store(true, std::memory_order_release);
+
+				mCpuBytes -= slot.Size.CpuBytes;
+				mGpuBytes -= slot.Size.GpuBytes;
+				evicted.push_back(std::move(slot.Owner));
+				mEvictions++;
+			}
 		}
-		else 
+
+		// Free the resources, and their GPU data, outside the lock.
+		return (uint32_t)evicted.size();
+	}
+
+	/// <summary>
+	/// Returns the name a handle's resource was registered under, empty if the handle is no longer valid.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns></returns>
+	std::string getName(const ResourceHandle<T>& handle)
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		const Slot* slot = findSlot(handle);
+		return slot != nullptr ? slot->Name : std::string();
+	}
+
+	/// <summary>
+	/// Returns the number of registered resources, loaded or not.
+	/// </summary>
+	/// <returns></returns>
+	size_t getCount()
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+		return mRegistries.size();
+	}
+
+	ResidencyStats getStats()
+	{
+		std::lock_guard<std::mutex> guard(mLock);
+
+		ResidencyStats stats;
+		stats.Registered = (uint32_t)mRegistries.size();
+		stats.Resident = 0;
+		stats.CpuBytes = mCpuBytes;
+		stats.GpuBytes = mGpuBytes;
+		stats.BudgetBytes = mBudgetBytes;
+		stats.Evictions = mEvictions;
+		stats.Reloads = mReloads;
+
+		for (auto i = mRegistries.begin(); i != mRegistries.end(); ++i)
 		{
-			return value->second.get();
+			if (getSlot(i->second).Owner != nullptr)
+			{
+				stats.Resident++;
+			}
 		}
 
-		return nullptr;
+		return stats;
+	}
+
+	const std::string& getResourceTypeName() const
+	{
+		return mResourceTypeName;
 	}
 
 private:
-	std::map<std::string, std::unique_ptr<T>> mRegistries;
+	struct Slot
+	{
+		Slot()
+			:Resource(nullptr),
+			Generation(0),
+			Version(0),
+			References(0),
+			LastUsed(0),
+			RetryFrame(0),
+			Evicted(false),
+			ReloadRequested(false)
+		{}
+
+		// Read without the lock.
+		std::atomic<T*> Resource;
+		std::atomic<uint32_t> Generation;
+		std::atomic<uint32_t> Version;
+		std::atomic<int32_t> References;
+		std::atomic<uint64_t> LastUsed;
+		std::atomic<uint64_t> RetryFrame;
+		std::atomic<bool> Evicted;
+		std::atomic<bool> ReloadRequested;
+
+		// Guarded by the lock.
+		std::unique_ptr<T> Owner;
+		std::string Name;
+		ResourceSize Size;
+		Reloader Load;
+	};
+
+	Slot& getSlot(uint32_t index)
+	{
+		return mChunks[index / RESOURCE_SLOTS_PER_CHUNK][index % RESOURCE_SLOTS_PER_CHUNK];
+	}
+
+	Slot* findSlot(const ResourceHandle<T>& handle) const
+	{
+		if (handle.Index >= mSlotCount.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+
+		Slot& slot = mChunks[handle.Index / RESOURCE_SLOTS_PER_CHUNK][handle.Index % RESOURCE_SLOTS_PER_CHUNK];
+
+		if (slot.Generation.load(std::memory_order_acquire) != handle.Generation)
+		{
+			return nullptr;
+		}
+
+		return &slot;
+	}
+
+	/// <summary>
+	/// Makes a resource the slot's current one. Caller holds the lock and has taken the old one out.
+	/// </summary>
+	void store(Slot& slot, std::unique_ptr<T> registry, const ResourceSize& size)
+	{
+		if (slot.Resource.load(std::memory_order_relaxed) != nullptr)
+		{
+			mCpuBytes -= slot.Size.CpuBytes;
+			mGpuBytes -= slot.Size.GpuBytes;
+		}
+
+		slot.Size = size;
+		mCpuBytes += size.CpuBytes;
+		mGpuBytes += size.GpuBytes;
+
+		slot.Owner = std::move(registry);
+		slot.Resource.store(slot.Owner.get(), std::memory_order_release);
+		slot.Version.fetch_add(1, std::memory_order_release);
+	}
+
+	/// <summary>
+	/// Runs an evicted resource's reloader outside the lock.
+	/// </summary>
+	void requestReload(const ResourceHandle<T>& handle)
+	{
+		Reloader load;
+
+		{
+			std::lock_guard<std::mutex> guard(mLock);
+			Slot* slot = findSlot(handle);
+
+			if (slot == nullptr || !slot->Evicted.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+
+			load = slot->Load;
+		}
+
+		load(handle);
+	}
+
+	std::mutex mLock;
+	std::map<std::string, uint32_t> mRegistries;
 	std::string mResourceTypeName;
+
+	std::unique_ptr<Slot[]> mChunks[RESOURCE_MAX_CHUNKS];
+	std::atomic<uint32_t> mSlotCount;
+	std::vector<uint32_t> mFreeSlots;
+
+	// Residency. Byte counts include only resources that are loaded right now.
+	std::atomic<uint64_t> mFrame;
+	uint64_t mCpuBytes;
+	uint64_t mGpuBytes;
+	uint64_t mBudgetBytes;
+	uint64_t mEvictions;
+	uint64_t mReloads;
+	std::vector<std::pair<uint64_t, uint32_t>> mCandidates;
 };
 
+/// <summary>
+/// A handle that holds a reference to its resource for as long as it lives, keeping it from being evicted.
+/// Entities and render stages keep these, packets and anything short lived pass plain handles.
+/// The manager must outlive it.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+template<typename T>
+class ResourceRef
+{
+public:
+	ResourceRef()
+		:mManager(nullptr)
+	{}
+
+	ResourceRef(ResourceManager<T>& manager, const ResourceHandle<T>& handle)
+		:mManager(&manager),
+		mHandle(handle)
+	{
+		mManager->addReference(mHandle);
+	}
+
+	ResourceRef(const ResourceRef<T>& other)
+		:mManager(other.mManager),
+		mHandle(other.mHandle)
+	{
+		if (mManager != nullptr)
+		{
+			mManager->addReference(mHandle);
+		}
+	}
+
+	ResourceRef<T>& operator=(const ResourceRef<T>& other)
+	{
+		if (other.mManager != nullptr)
+		{
+			other.mManager->addReference(other.mHandle);
+		}
+
+		if (mManager != nullptr)
+		{
+			mManager->releaseReference(mHandle);
+		}
+
+		mManager = other.mManager;
+		mHandle = other.mHandle;
+		return *this;
+	}
+
+	~ResourceRef()
+	{
+		if (mManager != nullptr)
+		{
+			mManager->releaseReference(mHandle);
+		}
+	}
+
+	/// <summary>
+	/// Returns the resource, null if it is not loaded right now.
+	/// </summary>
+	/// <returns></returns>
+	T* get() const
+	{
+		return mManager == nullptr ? nullptr : mManager->get(mHandle);
+	}
+
+	const ResourceHandle<T>& getHandle() const
+	{
+		return mHandle;
+	}
+
+	/// <summary>
+	/// Returns how many times the resource has been reloaded, see ResourceManager::getVersion.
+	/// </summary>
+	/// <returns></returns>
+	uint32_t getVersion() const
+	{
+		return mManager == nullptr ? 0 : mManager->getVersion(mHandle);
+	}
+
+	bool isNull() const
+	{
+		return mManager == nullptr || mHandle.isNull();
+	}
+
+private:
+	ResourceManager<T>* mManager;
+	ResourceHandle<T> mHandle;
+};
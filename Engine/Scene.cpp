@@ -1,23 +1,328 @@
 #include "Scene.h"
 
+#include "Utils/Profiler.h"
+
+// Entities handed to each job when per-entity work is split across the job system.
+#define ENTITY_JOB_GRAIN_SIZE 256
+
+void Scene::addEntity(std::unique_ptr<Entity> entity)
+{
+	EntityId id;
+
+	if (!mFreeIds.empty())
+	{
+		id = mFreeIds.back();
+		mFreeIds.pop_back();
+		mEntityLookup[id] = entity.get();
+	}
+	else
+	{
+		id = (EntityId)mEntityLookup.size();
+		mEntityLookup.push_back(entity.get());
+		mGenerations.push_back(0);
+	}
+
+	entity->attachToScene(this, &mComponents, EntityHandle(id, mGenerations[id]), (uint32_t)mEntities.size());
+	addToTagIndex(entity.get());
+
+	entity->init(this);
+	mEntities.push_back(std::move(entity));
+	mTransformOrderDirty = true;
+}
+
+bool Scene::destroyEntity(EntityHandle entity)
+{
+	// Resolving the handle rather than trusting a pointer drops stale and repeated destroys.
+	Entity* resolved = getEntity(entity);
+
+	if (resolved == nullptr)
+	{
+		return false;
+	}
+
+	retireEntity(resolved);
+	return true;
+}
+
+void Scene::retireEntity(Entity* entity)
+{
+	// Children go with their parent. Destroying a child detaches it, so keep taking the last one.
+	const std::vector<TransformComponent*>& children = entity->getTransform()->getChildren();
+
+	while (!children.empty())
+	{
+		retireEntity(children.back()->getOwner());
+	}
+
+	entity->getTransform()->setParent(nullptr);
+	mTransformOrderDirty = true;
+
+	EntityId id = entity->mId;
+	uint32_t index = entity->mSceneIndex;
+
+	removeFromTagIndex(entity);
+	mComponents.removeAll(id);
+	mEntityLookup[id] = nullptr;
+	mGenerations[id]++;
+	mFreeIds.push_back(id);
+
+	RetiredEntity retired;
+	retired.Retired = std::move(mEntities[index]);
+	retired.ReleaseTick = mTickCount + 1;
+
+	if (index != mEntities.size() - 1)
+	{
+		mEntities[index] = std::move(mEntities.back());
+		mEntities[index]->mSceneIndex = index;
+	}
+
+	mEntities.pop_back();
+
+	retired.Retired->attachToScene(nullptr, nullptr, EntityHandle(), 0);
+	mRetiredEntities.push_back(std::move(retired));
+}
+
+void Scene::releaseRetiredEntities()
+{
+	uint64_t renderedTick = mRenderedTick.load(std::memory_order_acquire);
+	size_t i = 0;
+
+	while (i < mRetiredEntities.size())
+	{
+		if (mRetiredEntities[i].ReleaseTick <= renderedTick)
+		{
+			mRetiredEntities[i] = std::move(mRetiredEntities.back());
+			mRetiredEntities.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
 void Scene::render()
 {
+	consumeRenderPacket();
 	mRenderPipeline->render(*this);
 }
 
+const RenderPacket& Scene::consumeRenderPacket()
+{
+	// Pick up the newest tick if the update thread has published one since the last frame.
+	mRenderPackets.consume();
+
+	const RenderPacket& packet = mRenderPackets.getReadBuffer();
+	mRenderedTick.store(packet.Tick, std::memory_order_release);
+	return packet;
+}
+
 void Scene::init()
 {
 	this->onInit();
 
 	// Init each added entity.
-	for (int i = 0; i < mEntities.size(); ++i)
+	for (size_t i = 0; i < mEntities.size(); ++i)
 	{
 		mEntities[i]->init(this);
 	}
+}
 
+void Scene::initRenderPipeline()
+{
 	mRenderPipeline->init(*this);
 }
 
 void Scene::update()
 {
+	releaseRetiredEntities();
+
+	{
+		PROFILE_SCOPE("Systems");
+		mSystems.run(this, mJobSystem);
+	}
+
+	{
+		// Sync point: every system has finished, apply what they recorded.
+		PROFILE_SCOPE("Flush Commands");
+		mCommands.flush(*this);
+	}
+
+	updateTransforms();
+
+	{
+		PROFILE_SCOPE("Collision");
+		mCollision.update(mComponents.getPool<ColliderComponent>(), mEntityLookup);
+	}
 }
+
+void Scene::rebuildTransformOrder()
+{
+	mTransformOrder.clear();
+
+	for (size_t i = 0; i < mEntities.size(); ++i)
+	{
+		if (mEntities[i]->getTransform()->getParent() == nullptr)
+		{
+			mTransformOrder.push_back(mEntities[i]->getTransform());
+		}
+	}
+
+	// Appending each transform's children as it is reached lays the tree out level by level.
+	for (size_t i = 0; i < mTransformOrder.size(); ++i)
+	{
+		const std::vector<TransformComponent*>& children = mTransformOrder[i]->getChildren();
+
+		for (size_t j = 0; j < children.size(); ++j)
+		{
+			// Children still waiting to be spawned are not in the scene yet.
+			if (children[j]->getOwner()->getScene() == this)
+			{
+				mTransformOrder.push_back(children[j]);
+			}
+		}
+	}
+
+	mTransformOrderDirty = false;
+}
+
+void Scene::updateTransforms()
+{
+	PROFILE_SCOPE("Update Transforms");
+
+	if (mTransformOrderDirty)
+	{
+		rebuildTransformOrder();
+	}
+
+	mMovedTransforms.clear();
+
+	size_t count = mTransformOrder.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		TransformComponent* transform = mTransformOrder[i];
+		TransformComponent* parent = transform->getParent();
+
+		if (transform->updateWorldState(parent != nullptr && parent->hasMoved()))
+		{
+			mMovedTransforms.push_back(transform);
+		}
+	}
+
+	size_t movedCount = mMovedTransforms.size();
+	mMovedStates.resize(movedCount);
+	mMovedMatrices.resize(movedCount);
+
+	for (size_t i = 0; i < movedCount; ++i)
+	{
+		const TransformState& world = mMovedTransforms[i]->getState();
+		mMovedStates.set(i, world.Position, world.Rotation, world.Scale);
+	}
+
+	BatchTransform::computeModelMatrices(mMovedStates, mMovedMatrices.data());
+
+	for (size_t i = 0; i < movedCount; ++i)
+	{
+		mMovedTransforms[i]->mTransformationMatrix = mMovedMatrices[i];
+	}
+
+	{
+		PROFILE_SCOPE("Update Spatial Index");
+		mSpatialIndex.update(mComponents.getPool<BoundsComponent>(), mEntityLookup);
+	}
+}
+
+void Scene::addToTagIndex(Entity* entity)
+{
+	TagId tag = entity->getTagId();
+
+	if (tag >= mEntitiesByTag.size())
+	{
+		mEntitiesByTag.resize((size_t)tag + 1);
+	}
+
+	entity->mTagIndex = (uint32_t)mEntitiesByTag[tag].size();
+	mEntitiesByTag[tag].push_back(entity);
+}
+
+void Scene::removeFromTagIndex(Entity* entity)
+{
+	std::vector<Entity*>& bucket = mEntitiesByTag[entity->getTagId()];
+	uint32_t index = entity->mTagIndex;
+
+	if (index != bucket.size() - 1)
+	{
+		bucket[index] = bucket.back();
+		bucket[index]->mTagIndex = index;
+	}
+
+	bucket.pop_back();
+}
+
+void Scene::onTagChanged(Entity* entity, TagId oldTag)
+{
+	TagId newTag = entity->getTagId();
+
+	// The entity is still filed under its old tag.
+	entity->mTag = oldTag;
+	removeFromTagIndex(entity);
+	entity->mTag = newTag;
+
+	addToTagIndex(entity);
+}
+
+void Scene::logEntityPoolStats() const
+{
+	for (size_t i = 0; i < mEntityPools.size(); ++i)
+	{
+		ObjectPoolStats stats = mEntityPools[i]->getStats();
+
+		StaticLogger::instance.trace("Entity pool {string}: {int}/{int} in use, peak {int}, {int} blocks, {long} acquired",
+			mEntityPools[i]->getName().c_str(), (int)stats.inUse, (int)stats.capacity, (int)stats.peakInUse,
+			(int)stats.blocks, stats.acquires);
+	}
+}
+
+void Scene::storePreviousTransforms()
+{
+	PROFILE_SCOPE("Store Previous Transforms");
+
+	auto storeRange = [this](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			TransformComponent* transform = mEntities[i]->getTransform();
+
+			// A transform that did not move last tick already has its previous state.
+			if (transform->hasMoved())
+			{
+				transform->storePreviousState();
+			}
+		}
+	};
+
+	if (mJobSystem == nullptr)
+	{
+		storeRange(0, mEntities.size());
+		return;
+	}
+
+	mJobSystem->parallelFor(mEntities.size(), ENTITY_JOB_GRAIN_SIZE, storeRange);
+}
+
+void Scene::publishRenderPacket(uint64_t tickNanos)
+{
+	PROFILE_SCOPE("Publish Render Packet");
+
+	RenderPacket& packet = mRenderPackets.getWriteBuffer();
+	packet.clear();
+	packet.Tick = ++mTickCount;
+	packet.TickNanos = tickNanos;
+
+	for (size_t i = 0; i < mEntities.size(); ++i)
+	{
+		mEntities[i]->extractRenderData(packet);
+	}
+
+	mRenderPackets.publish();
+}
\ No newline at end of file
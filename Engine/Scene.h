@@ -1,12 +1,47 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
-#include <mutex>
 
 #include "Render Engine/RenderPipeline.h"
 #include "Render Engine/Camera.h"
+#include "Utils/TripleBuffer.h"
+#include "Utils/JobSystem.h"
+#include "Math/BatchTransform.h"
+#include "ComponentStorage.h"
+#include "EntityCommandBuffer.h"
+#include "SystemScheduler.h"
+#include "SpatialIndex.h"
+#include "CollisionWorld.h"
+#include "EntityPool.h"
 #include "Entity.h"
+#include "RenderPacket.h"
+
+/// <summary>
+/// Calls IComponent::update on every component in the scene.
+/// Component updates receive the whole scene and may touch anything, so this runs exclusively.
+/// </summary>
+class ComponentUpdateSystem : public ISystem
+{
+public:
+	ComponentUpdateSystem(ComponentStorage& components, const std::vector<Entity*>& entities)
+		:ISystem("ComponentUpdate"),
+		mComponents(components),
+		mEntities(entities)
+	{
+		setExclusive(true);
+	}
+
+	void update(Scene* scene)
+	{
+		mComponents.updateAll(scene, mEntities);
+	}
+
+private:
+	ComponentStorage& mComponents;
+	const std::vector<Entity*>& mEntities;
+};
 
 /// <summary>
 /// Class representing a scene. Contains a render pipeline along with all entities 
@@ -20,76 +55,262 @@ public:
 	/// Standard constructor.
 	/// </summary>
 	Scene(std::unique_ptr<RenderPipeline> renderPipeline) 
+		:mTransformOrderDirty(false),
+		mTickCount(0),
+		mRenderedTick(0),
+		mJobSystem(nullptr)
 	{
 		this->mRenderPipeline = std::move(renderPipeline);
+		mSystems.addSystem(std::make_unique<ComponentUpdateSystem>(mComponents, mEntityLookup));
 	}
 
 	/// <summary>
 	/// Add entity gives ownership of the entity to this class.
+	/// Takes effect immediately, so only call it from the update thread outside of a system.
+	/// Use getCommands().spawn() while the tick is running.
+	/// </summary>
+	/// <param name="entity"></param>
+	void addEntity(std::unique_ptr<Entity> entity);
+
+	/// <summary>
+	/// Removes the entity a handle refers to, and all of its children, from the scene.
+	/// Each removal is O(1), the last entity is swapped into its place.
+	/// The entity's generation is bumped first, so every handle to it stops resolving at once.
+	/// Its components are removed and its id is reused, but its memory is only released once the
+	/// render thread has moved past every packet produced while it was alive.
+	/// Takes effect immediately, so only call it from the update thread outside of a system.
+	/// Use getCommands().destroy() while the tick is running.
 	/// </summary>
 	/// <param name="entity"></param>
-	void addEntity(std::unique_ptr<Entity> entity)
+	/// <returns>False if the handle no longer resolves, because the entity was already destroyed.</returns>
+	bool destroyEntity(EntityHandle entity);
+
+	/// <summary>
+	/// Spawns and destroys recorded during the tick. Applied at the end of Scene::update.
+	/// </summary>
+	/// <returns></returns>
+	EntityCommandBuffer& getCommands()
 	{
-		entity->init(this);
-		EntitiesMutex.lock();
-		mEntities.push_back(std::move(entity));
-		EntitiesMutex.unlock();
+		return mCommands;
 	}
 
 	/// <summary>
-	/// Returns the first entity found that has the set tag.
+	/// Finds entities with a BoundsComponent by position. Refreshed at the end of Scene::update,
+	/// so systems see where everything was at the end of the previous tick.
+	/// Queries are read only and may run from parallel systems.
 	/// </summary>
-	/// <param name="tag"></param>
 	/// <returns></returns>
-	Entity* getEntityWithTag(const std::string& tag)
+	const SpatialIndex& getSpatialIndex() const
 	{
-		Entity* foundEntity = nullptr;
-		size_t entityCount = mEntities.size();
+		return mSpatialIndex;
+	}
 
-		EntitiesMutex.lock();
+	SpatialIndex& getSpatialIndex()
+	{
+		return mSpatialIndex;
+	}
 
-		for (int i = 0; i < entityCount; ++i)
-		{
-			if (mEntities[i]->getTag() == tag)
-			{
-				foundEntity = mEntities[i].get();
-				break;
-			}
-		}
+	/// <summary>
+	/// Every pair of colliders found touching at the end of the last tick.
+	/// Systems read the list instead of registering callbacks, and may read it in parallel.
+	/// </summary>
+	/// <returns></returns>
+	const std::vector<Contact>& getContacts() const
+	{
+		return mCollision.getContacts();
+	}
 
-		EntitiesMutex.unlock();
+	CollisionWorld& getCollisionWorld()
+	{
+		return mCollision;
+	}
+
+	/// <summary>
+	/// Returns an entity with the set tag. Which one is unspecified once entities with the tag are destroyed.
+	/// Update thread only.
+	/// </summary>
+	/// <param name="tag"></param>
+	/// <returns></returns>
+	Entity* getEntityWithTag(TagId tag) const
+	{
+		const std::vector<Entity*>& entities = getEntitiesWithTag(tag);
+		return entities.empty() ? nullptr : entities[0];
+	}
 
-		return foundEntity;
+	Entity* getEntityWithTag(const std::string& tag) const
+	{
+		return getEntityWithTag(TagRegistry::find(tag));
 	}
 
 	/// <summary>
 	/// Returns all entities which have a specific tag.
+	/// The view is kept up to date by addEntity, destroyEntity and Entity::setTag, so do not hold it across any of them.
+	/// Update thread only.
 	/// </summary>
 	/// <param name="tag"></param>
 	/// <returns></returns>
-	std::vector<Entity*> getEntitiesWithTag(const std::string& tag)
+	const std::vector<Entity*>& getEntitiesWithTag(TagId tag) const
 	{
-		std::vector<Entity*> entities;
+		static const std::vector<Entity*> none;
 
-		EntitiesMutex.lock();
+		if (tag >= mEntitiesByTag.size())
+		{
+			return none;
+		}
+
+		return mEntitiesByTag[tag];
+	}
+
+	const std::vector<Entity*>& getEntitiesWithTag(const std::string& tag) const
+	{
+		return getEntitiesWithTag(TagRegistry::find(tag));
+	}
+
+	/// <summary>
+	/// Marks the flattened transform hierarchy for a rebuild. Called by Entity::setParent.
+	/// </summary>
+	void onHierarchyChanged()
+	{
+		mTransformOrderDirty = true;
+	}
 
-		size_t entityCount = mEntities.size();
-		for (int i = 0; i < entityCount; ++i)
+	/// <summary>
+	/// Moves an entity between tag buckets. Called by Entity::setTag.
+	/// </summary>
+	/// <param name="entity"></param>
+	/// <param name="oldTag"></param>
+	void onTagChanged(Entity* entity, TagId oldTag);
+
+	/// <summary>
+	/// Returns the entity a handle refers to, or nullptr if it has been destroyed.
+	/// Update thread only.
+	/// </summary>
+	/// <param name="handle"></param>
+	/// <returns></returns>
+	Entity* getEntity(EntityHandle handle) const
+	{
+		if (handle.Index >= mEntityLookup.size() || mGenerations[handle.Index] != handle.Generation)
 		{
-			if (mEntities[i]->getTag() == tag)
-			{
-				entities.push_back(mEntities[i].get());
-			}
+			return nullptr;
 		}
 
-		EntitiesMutex.unlock();
-		return entities;
+		return mEntityLookup[handle.Index];
+	}
+
+	/// <summary>
+	/// Returns a handle to the first entity found with the tag, or a null handle.
+	/// </summary>
+	/// <param name="tag"></param>
+	/// <returns></returns>
+	EntityHandle getEntityHandleWithTag(const std::string& tag) const
+	{
+		Entity* entity = getEntityWithTag(tag);
+		return (entity != nullptr) ? entity->getHandle() : EntityHandle();
+	}
+
+	/// <summary>
+	/// Returns the dense pool holding every component of type T in the scene.
+	/// Systems should iterate the pool directly instead of going through entities.
+	/// </summary>
+	/// <typeparam name="T"></typeparam>
+	/// <returns></returns>
+	template<typename T>
+	ComponentPool<T>& getComponentPool()
+	{
+		return mComponents.getPool<T>();
+	}
+
+	ComponentStorage& getComponentStorage()
+	{
+		return mComponents;
+	}
+
+	/// <summary>
+	/// Adds a system to run every tick after the systems already added.
+	/// Systems whose declared component access does not overlap run concurrently.
+	/// </summary>
+	/// <param name="system"></param>
+	/// <returns>The system, owned by the scene.</returns>
+	ISystem* addSystem(std::unique_ptr<ISystem> system)
+	{
+		return mSystems.addSystem(std::move(system));
+	}
+
+	/// <summary>
+	/// Sets the job system the scene fans its per-entity work out on.
+	/// Without one all work runs on the update thread.
+	/// </summary>
+	/// <param name="jobSystem"></param>
+	void setJobSystem(JobSystem* jobSystem)
+	{
+		mJobSystem = jobSystem;
+		mCommands.setJobSystem(jobSystem);
 	}
 
+	JobSystem* getJobSystem()
+	{
+		return mJobSystem;
+	}
+
+	/// <summary>
+	/// Runs onInit and initializes every entity added so far.
+	/// Does not touch the render pipeline, so a headless run can call it without a graphics context.
+	/// </summary>
 	virtual void init();
+
+	/// <summary>
+	/// Initializes the render pipeline. Needs a current graphics context.
+	/// </summary>
+	void initRenderPipeline();
+
 	virtual void render();
+
+	/// <summary>
+	/// Picks up the newest render packet if one was published since the last call
+	/// and marks its tick as the one being drawn. Called by render, or once per tick
+	/// by a headless run so destroyed entities are still released.
+	/// </summary>
+	/// <returns>The packet now being drawn.</returns>
+	const RenderPacket& consumeRenderPacket();
+
+	/// <summary>
+	/// Runs every system in the scene, starting with the per-component update calls,
+	/// then applies the spawns and destroys they recorded, updates transforms and finds this tick's contacts.
+	/// Derived scenes should call this from their own update.
+	/// </summary>
 	virtual void update();
 
+	/// <summary>
+	/// Recomputes the world transform of every entity that moved, or whose parent moved.
+	/// Walks the hierarchy breadth first so every parent is finished before its children,
+	/// then refreshes the spatial index from what moved.
+	/// Runs at the end of Scene::update.
+	/// </summary>
+	void updateTransforms();
+
+	/// <summary>
+	/// Saves every entity's transform as the previous tick's state so the
+	/// render thread can interpolate between ticks.
+	/// </summary>
+	void storePreviousTransforms();
+
+	/// <summary>
+	/// Snapshots every entity's render data and hands it to the render thread.
+	/// Called on the update thread at the end of every tick.
+	/// </summary>
+	/// <param name="tickNanos">Engine time the finished tick represents.</param>
+	void publishRenderPacket(uint64_t tickNanos);
+
+	/// <summary>
+	/// Returns the latest render packet picked up by the render thread.
+	/// Only valid on the render thread.
+	/// </summary>
+	/// <returns></returns>
+	const RenderPacket& getRenderPacket() const
+	{
+		return mRenderPackets.getReadBuffer();
+	}
+
 	virtual ~Scene() {}
 
 	const std::vector<std::unique_ptr<Entity>>& getEntities()
@@ -97,13 +318,115 @@ public:
 		return mEntities;
 	}
 
+	/// <summary>
+	/// Creates a pool of preallocated entities owned by the scene, so it outlives every entity taken from it.
+	/// </summary>
+	/// <typeparam name="T"></typeparam>
+	/// <param name="name">Shown in pool statistics.</param>
+	/// <param name="capacity">Entities allocated up front.</param>
+	/// <param name="growBy">Entities added each time the pool runs out. Defaults to the initial capacity.</param>
+	/// <returns></returns>
+	template<typename T>
+	EntityPool<T>& createEntityPool(const std::string& name, size_t capacity, size_t growBy = 0)
+	{
+		EntityPool<T>* pool = new EntityPool<T>(name, capacity, growBy);
+		mEntityPools.push_back(std::unique_ptr<IEntityPool>(pool));
+		return *pool;
+	}
+
+	const std::vector<std::unique_ptr<IEntityPool>>& getEntityPools() const
+	{
+		return mEntityPools;
+	}
+
+	/// <summary>
+	/// Logs the occupancy of every entity pool.
+	/// </summary>
+	void logEntityPoolStats() const;
+
 protected:
 	virtual void onInit() = 0;
 
+	void addToTagIndex(Entity* entity);
+	void removeFromTagIndex(Entity* entity);
+
+	/// <summary>
+	/// Flattens the transform hierarchy into mTransformOrder, roots first then each level in turn.
+	/// </summary>
+	void rebuildTransformOrder();
+
+	/// <summary>
+	/// Removes an entity that is known to be in the scene, children first, and parks it until it can be freed.
+	/// </summary>
+	/// <param name="entity"></param>
+	void retireEntity(Entity* entity);
+
+	/// <summary>
+	/// Frees destroyed entities the render thread can no longer be looking at.
+	/// </summary>
+	void releaseRetiredEntities();
+
+	/// <summary>
+	/// Declared before anything holding entities so pooled entities are freed before their pools.
+	/// </summary>
+	std::vector<std::unique_ptr<IEntityPool>> mEntityPools;
+
 	std::unique_ptr<RenderPipeline> mRenderPipeline;
 	std::vector<std::unique_ptr<Entity>> mEntities;
 
-public:
-	std::mutex EntitiesMutex;
+	/// <summary>
+	/// Entity lookup by id, used to hand each component its owner while iterating pools.
+	/// Destroyed entities leave a null slot whose id is reused by the next entity added,
+	/// with the slot's generation bumped so old handles no longer resolve.
+	/// </summary>
+	std::vector<Entity*> mEntityLookup;
+	std::vector<uint32_t> mGenerations;
+	std::vector<EntityId> mFreeIds;
+	ComponentStorage mComponents;
+
+	/// <summary>
+	/// Entities bucketed by tag id, in the order they were added or retagged.
+	/// </summary>
+	std::vector<std::vector<Entity*>> mEntitiesByTag;
+
+	/// <summary>
+	/// Every transform in the scene in breadth first order. Rebuilt when entities are added,
+	/// destroyed or reparented.
+	/// </summary>
+	std::vector<TransformComponent*> mTransformOrder;
+	bool mTransformOrderDirty;
+
+	/// <summary>
+	/// Scratch space for building the matrices of every transform that moved this tick in one batch.
+	/// </summary>
+	std::vector<TransformComponent*> mMovedTransforms;
+	TransformSoA mMovedStates;
+	std::vector<Matrix44f> mMovedMatrices;
+
+	SystemScheduler mSystems;
+	EntityCommandBuffer mCommands;
+	SpatialIndex mSpatialIndex;
+	CollisionWorld mCollision;
+
+	/// <summary>
+	/// A destroyed entity and the first tick whose packet no longer contains it.
+	/// </summary>
+	struct RetiredEntity
+	{
+		std::unique_ptr<Entity> Retired;
+		uint64_t ReleaseTick;
+	};
+
+	std::vector<RetiredEntity> mRetiredEntities;
+
+	TripleBuffer<RenderPacket> mRenderPackets;
+	uint64_t mTickCount;
+
+	/// <summary>
+	/// Tick of the packet the render thread is currently drawing.
+	/// </summary>
+	std::atomic<uint64_t> mRenderedTick;
+
+	JobSystem* mJobSystem;
 };
 
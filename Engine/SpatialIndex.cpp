@@ -0,0 +1,701 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "Entity.h"
+#include "Utils/FrameArena.h"
+
+// Cell coordinates are packed into 21 bits per axis, so the grid spans about a million cells each way.
+#define CELL_KEY_BITS 21
+#define CELL_KEY_MASK ((1ull << CELL_KEY_BITS) - 1)
+#define CELL_COORDINATE_LIMIT ((1 << (CELL_KEY_BITS - 1)) - 1)
+
+// Deepest tree a traversal can walk. Median splits keep the depth near log2 of the static count.
+#define BVH_STACK_SIZE 64
+
+SpatialIndex::SpatialIndex(float cellSize)
+	:mCellSize(cellSize),
+	mInverseCellSize(1.0f / cellSize),
+	mBvhDirty(false),
+	mUpdateStamp(0)
+{
+}
+
+void SpatialIndex::setCellSize(float cellSize)
+{
+	mCellSize = cellSize;
+	mInverseCellSize = 1.0f / cellSize;
+
+	mCells.clear();
+	mOversized.clear();
+
+	for (size_t i = 0; i < mActive.size(); ++i)
+	{
+		if (!mProxies[mActive[i]].Static)
+		{
+			gridInsert(mActive[i]);
+		}
+	}
+}
+
+void SpatialIndex::update(ComponentPool<BoundsComponent>& bounds, const std::vector<Entity*>& entities)
+{
+	mUpdateStamp++;
+	mDynamicBounds = AABBf();
+
+	size_t count = bounds.size();
+	for (size_t i = 0; i < count; ++i)
+	{
+		EntityId id = bounds.getOwner(i);
+		BoundsComponent& component = bounds.at(i);
+		Entity* entity = entities[id];
+
+		if (entity == nullptr)
+		{
+			continue;
+		}
+
+		if (id >= mProxies.size())
+		{
+			mProxies.resize((size_t)id + 1);
+		}
+
+		Proxy& proxy = mProxies[id];
+		EntityHandle handle = entity->getHandle();
+		bool added = !proxy.Active || proxy.Handle != handle;
+
+		// The id was reused by a new entity in the same tick the old one was destroyed.
+		if (proxy.Active && added)
+		{
+			removeProxy(id);
+			mActive.erase(std::find(mActive.begin(), mActive.end(), id));
+		}
+
+		TransformComponent* transform = entity->getTransform();
+
+		if (added || component.mDirty || transform->hasMoved())
+		{
+			AABBf worldBounds = component.mLocalBounds.transformed(transform->getTransformationMatrix());
+
+			if (!added && !proxy.Static && !component.mStatic)
+			{
+				gridMove(id, worldBounds);
+			}
+			else
+			{
+				if (!added)
+				{
+					removeProxy(id);
+				}
+
+				proxy.Handle = handle;
+				proxy.Static = component.mStatic;
+				proxy.Bounds = worldBounds;
+				insertProxy(id);
+
+				if (added)
+				{
+					proxy.Active = true;
+					mActive.push_back(id);
+				}
+			}
+
+			component.mDirty = false;
+		}
+
+		proxy.Seen = mUpdateStamp;
+
+		if (!proxy.Static)
+		{
+			mDynamicBounds.merge(proxy.Bounds);
+		}
+	}
+
+	// Anything not seen this tick lost its bounds or was destroyed.
+	for (size_t i = 0; i < mActive.size();)
+	{
+		EntityId id = mActive[i];
+
+		if (mProxies[id].Seen != mUpdateStamp)
+		{
+			removeProxy(id);
+			mProxies[id].Active = false;
+			mActive[i] = mActive.back();
+			mActive.pop_back();
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (mBvhDirty)
+	{
+		rebuildBvh();
+	}
+}
+
+void SpatialIndex::insertProxy(EntityId id)
+{
+	if (mProxies[id].Static)
+	{
+		mBvhDirty = true;
+	}
+	else
+	{
+		gridInsert(id);
+	}
+}
+
+void SpatialIndex::removeProxy(EntityId id)
+{
+	if (mProxies[id].Static)
+	{
+		mBvhDirty = true;
+	}
+	else
+	{
+		gridRemove(id);
+	}
+}
+
+void SpatialIndex::gridInsert(EntityId id)
+{
+	Proxy& proxy = mProxies[id];
+	getCellRange(proxy.Bounds, proxy.CellMin, proxy.CellMax);
+
+	uint64_t cellCount = (uint64_t)(proxy.CellMax[0] - proxy.CellMin[0] + 1)
+		* (uint64_t)(proxy.CellMax[1] - proxy.CellMin[1] + 1)
+		* (uint64_t)(proxy.CellMax[2] - proxy.CellMin[2] + 1);
+
+	proxy.Oversized = cellCount > SPATIAL_MAX_CELLS_PER_ENTITY;
+
+	if (proxy.Oversized)
+	{
+		mOversized.push_back(id);
+		return;
+	}
+
+	for (int32_t x = proxy.CellMin[0]; x <= proxy.CellMax[0]; ++x)
+	{
+		for (int32_t y = proxy.CellMin[1]; y <= proxy.CellMax[1]; ++y)
+		{
+			for (int32_t z = proxy.CellMin[2]; z <= proxy.CellMax[2]; ++z)
+			{
+				mCells[getCellKey(x, y, z)].push_back(id);
+			}
+		}
+	}
+}
+
+void SpatialIndex::gridRemove(EntityId id)
+{
+	Proxy& proxy = mProxies[id];
+
+	if (proxy.Oversized)
+	{
+		mOversized.erase(std::find(mOversized.begin(), mOversized.end(), id));
+		return;
+	}
+
+	for (int32_t x = proxy.CellMin[0]; x <= proxy.CellMax[0]; ++x)
+	{
+		for (int32_t y = proxy.CellMin[1]; y <= proxy.CellMax[1]; ++y)
+		{
+			for (int32_t z = proxy.CellMin[2]; z <= proxy.CellMax[2]; ++z)
+			{
+				auto cell = mCells.find(getCellKey(x, y, z));
+				std::vector<EntityId>& ids = cell->second;
+
+				*std::find(ids.begin(), ids.end(), id) = ids.back();
+				ids.pop_back();
+
+				// Empty cells are dropped so the map only grows with the area that is occupied.
+				if (ids.empty())
+				{
+					mCells.erase(cell);
+				}
+			}
+		}
+	}
+}
+
+void SpatialIndex::gridMove(EntityId id, const AABBf& bounds)
+{
+	Proxy& proxy = mProxies[id];
+
+	int32_t cellMin[3];
+	int32_t cellMax[3];
+	getCellRange(bounds, cellMin, cellMax);
+
+	// Most moves stay within the same cells and only need the new box.
+	if (std::equal(cellMin, cellMin + 3, proxy.CellMin) && std::equal(cellMax, cellMax + 3, proxy.CellMax))
+	{
+		proxy.Bounds = bounds;
+		return;
+	}
+
+	gridRemove(id);
+	proxy.Bounds = bounds;
+	gridInsert(id);
+}
+
+void SpatialIndex::rebuildBvh()
+{
+	mBvhNodes.clear();
+	mBvhItems.clear();
+
+	for (size_t i = 0; i < mActive.size(); ++i)
+	{
+		if (mProxies[mActive[i]].Static)
+		{
+			mBvhItems.push_back(mActive[i]);
+		}
+	}
+
+	if (!mBvhItems.empty())
+	{
+		mBvhNodes.reserve(mBvhItems.size() * 2);
+		mBvhNodes.push_back(BvhNode());
+		buildBvhNode(0, 0, (uint32_t)mBvhItems.size());
+	}
+
+	mBvhDirty = false;
+}
+
+void SpatialIndex::buildBvhNode(uint32_t nodeIndex, uint32_t first, uint32_t count)
+{
+	AABBf bounds;
+	AABBf centers;
+
+	for (uint32_t i = first; i < first + count; ++i)
+	{
+		const AABBf& box = mProxies[mBvhItems[i]].Bounds;
+		bounds.merge(box);
+		centers.merge(box.getCenter());
+	}
+
+	mBvhNodes[nodeIndex].Bounds = bounds;
+
+	if (count <= SPATIAL_BVH_LEAF_SIZE)
+	{
+		mBvhNodes[nodeIndex].First = first;
+		mBvhNodes[nodeIndex].Count = count;
+		return;
+	}
+
+	// Split at the median center along the axis the centers are most spread out on.
+	Vector3f spread = centers.Max - centers.Min;
+	int axis = 0;
+
+	if (spread.y > spread.x)
+	{
+		axis = 1;
+	}
+
+	if (spread.z > (axis == 0 ? spread.x : spread.y))
+	{
+		axis = 2;
+	}
+
+	auto centerOnAxis = [this, axis](EntityId id)
+	{
+		Vector3f center = mProxies[id].Bounds.getCenter();
+		return axis == 0 ? center.x : (axis == 1 ? center.y : center.z);
+	};
+
+	uint32_t half = count / 2;
+	std::nth_element(mBvhItems.begin() + first, mBvhItems.begin() + first + half, mBvhItems.begin() + first + count,
+		[&centerOnAxis](EntityId a, EntityId b)
+		{
+			return centerOnAxis(a) < centerOnAxis(b);
+		});
+
+	uint32_t left = (uint32_t)mBvhNodes.size();
+	mBvhNodes.push_back(BvhNode());
+	mBvhNodes.push_back(BvhNode());
+
+	mBvhNodes[nodeIndex].First = left;
+	mBvhNodes[nodeIndex].Count = 0;
+
+	buildBvhNode(left, first, half);
+	buildBvhNode(left + 1, first + half, count - half);
+}
+
+void SpatialIndex::getCellRange(const AABBf& box, int32_t* cellMin, int32_t* cellMax) const
+{
+	cellMin[0] = getCell(box.Min.x);
+	cellMin[1] = getCell(box.Min.y);
+	cellMin[2] = getCell(box.Min.z);
+	cellMax[0] = getCell(box.Max.x);
+	cellMax[1] = getCell(box.Max.y);
+	cellMax[2] = getCell(box.Max.z);
+}
+
+int32_t SpatialIndex::getCell(float coordinate) const
+{
+	float cell = std::floor(coordinate * mInverseCellSize);
+	cell = std::fmax(std::fmin(cell, (float)CELL_COORDINATE_LIMIT), (float)-CELL_COORDINATE_LIMIT);
+	return (int32_t)cell;
+}
+
+uint64_t SpatialIndex::getCellKey(int32_t x, int32_t y, int32_t z)
+{
+	return ((uint64_t)(uint32_t)x & CELL_KEY_MASK)
+		| (((uint64_t)(uint32_t)y & CELL_KEY_MASK) << CELL_KEY_BITS)
+		| (((uint64_t)(uint32_t)z & CELL_KEY_MASK) << (CELL_KEY_BITS * 2));
+}
+
+/// <summary>
+/// Sorts the results appended since start and drops entities found more than once.
+/// </summary>
+static void removeDuplicates(std::vector<EntityHandle>& results, size_t start)
+{
+	std::sort(results.begin() + start, results.end(), [](const EntityHandle& a, const EntityHandle& b)
+	{
+		return a.Index < b.Index;
+	});
+
+	results.erase(std::unique(results.begin() + start, results.end()), results.end());
+}
+
+template<typename Visitor>
+void SpatialIndex::visitCandidates(const AABBf& box, Visitor visit) const
+{
+	if (box.isEmpty())
+	{
+		return;
+	}
+
+	if (!mCells.empty())
+	{
+		int32_t cellMin[3];
+		int32_t cellMax[3];
+		getCellRange(box, cellMin, cellMax);
+
+		uint64_t cellCount = (uint64_t)(cellMax[0] - cellMin[0] + 1)
+			* (uint64_t)(cellMax[1] - cellMin[1] + 1)
+			* (uint64_t)(cellMax[2] - cellMin[2] + 1);
+
+		// A query larger than the occupied area is cheaper to answer by walking the occupied cells.
+		if (cellCount > mCells.size())
+		{
+			for (auto cell = mCells.begin(); cell != mCells.end(); ++cell)
+			{
+				for (size_t i = 0; i < cell->second.size(); ++i)
+				{
+					visit(cell->second[i]);
+				}
+			}
+		}
+		else
+		{
+			for (int32_t x = cellMin[0]; x <= cellMax[0]; ++x)
+			{
+				for (int32_t y = cellMin[1]; y <= cellMax[1]; ++y)
+				{
+					for (int32_t z = cellMin[2]; z <= cellMax[2]; ++z)
+					{
+						auto cell = mCells.find(getCellKey(x, y, z));
+
+						if (cell == mCells.end())
+						{
+							continue;
+						}
+
+						for (size_t i = 0; i < cell->second.size(); ++i)
+						{
+							visit(cell->second[i]);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < mOversized.size(); ++i)
+	{
+		visit(mOversized[i]);
+	}
+
+	if (mBvhNodes.empty())
+	{
+		return;
+	}
+
+	uint32_t stack[BVH_STACK_SIZE];
+	uint32_t stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const BvhNode& node = mBvhNodes[stack[--stackSize]];
+
+		if (!node.Bounds.intersects(box))
+		{
+			continue;
+		}
+
+		if (node.Count > 0)
+		{
+			for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+			{
+				visit(mBvhItems[i]);
+			}
+		}
+		else
+		{
+			stack[stackSize++] = node.First;
+			stack[stackSize++] = node.First + 1;
+		}
+	}
+}
+
+template<typename Visitor>
+void SpatialIndex::visitRay(const Vector3f& origin, const Vector3f& direction, float maxDistance, Visitor visit) const
+{
+	float length = std::sqrt(direction * direction);
+
+	if (length == 0.0f)
+	{
+		return;
+	}
+
+	Vector3f unitDirection = direction * (1.0f / length);
+	Vector3f inverseDirection(1.0f / unitDirection.x, 1.0f / unitDirection.y, 1.0f / unitDirection.z);
+
+	// Shrinks as hits come in when only the nearest one is wanted.
+	float limit = maxDistance;
+
+	auto test = [&](EntityId id)
+	{
+		float distance;
+
+		if (mProxies[id].Bounds.intersectsRay(origin, inverseDirection, limit, distance))
+		{
+			limit = visit(id, distance);
+		}
+	};
+
+	for (size_t i = 0; i < mOversized.size(); ++i)
+	{
+		test(mOversized[i]);
+	}
+
+	if (!mBvhNodes.empty())
+	{
+		uint32_t stack[BVH_STACK_SIZE];
+		uint32_t stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const BvhNode& node = mBvhNodes[stack[--stackSize]];
+			float distance;
+
+			if (!node.Bounds.intersectsRay(origin, inverseDirection, limit, distance))
+			{
+				continue;
+			}
+
+			if (node.Count > 0)
+			{
+				for (uint32_t i = node.First; i < node.First + node.Count; ++i)
+				{
+					test(mBvhItems[i]);
+				}
+			}
+			else
+			{
+				stack[stackSize++] = node.First;
+				stack[stackSize++] = node.First + 1;
+			}
+		}
+	}
+
+	float entry;
+
+	if (mCells.empty() || !mDynamicBounds.intersectsRay(origin, inverseDirection, limit, entry))
+	{
+		return;
+	}
+
+	// Step cell by cell from where the ray enters the occupied area (Amanatides and Woo).
+	float start[3] = { origin.x + unitDirection.x * entry, origin.y + unitDirection.y * entry, origin.z + unitDirection.z * entry };
+	float originAxis[3] = { origin.x, origin.y, origin.z };
+	float directionAxis[3] = { unitDirection.x, unitDirection.y, unitDirection.z };
+
+	int32_t rangeMin[3];
+	int32_t rangeMax[3];
+	getCellRange(mDynamicBounds, rangeMin, rangeMax);
+
+	int32_t cell[3];
+	int32_t step[3];
+	float nextBoundary[3];
+	float boundaryDelta[3];
+
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		cell[axis] = std::min(std::max(getCell(start[axis]), rangeMin[axis]), rangeMax[axis]);
+
+		if (directionAxis[axis] > 0.0f)
+		{
+			step[axis] = 1;
+			nextBoundary[axis] = ((float)(cell[axis] + 1) * mCellSize - originAxis[axis]) / directionAxis[axis];
+			boundaryDelta[axis] = mCellSize / directionAxis[axis];
+		}
+		else if (directionAxis[axis] < 0.0f)
+		{
+			step[axis] = -1;
+			nextBoundary[axis] = ((float)cell[axis] * mCellSize - originAxis[axis]) / directionAxis[axis];
+			boundaryDelta[axis] = -mCellSize / directionAxis[axis];
+		}
+		else
+		{
+			step[axis] = 0;
+			nextBoundary[axis] = std::numeric_limits<float>::infinity();
+			boundaryDelta[axis] = std::numeric_limits<float>::infinity();
+		}
+	}
+
+	while (true)
+	{
+		auto found = mCells.find(getCellKey(cell[0], cell[1], cell[2]));
+
+		if (found != mCells.end())
+		{
+			for (size_t i = 0; i < found->second.size(); ++i)
+			{
+				test(found->second[i]);
+			}
+		}
+
+		int axis = 0;
+
+		if (nextBoundary[1] < nextBoundary[axis])
+		{
+			axis = 1;
+		}
+
+		if (nextBoundary[2] < nextBoundary[axis])
+		{
+			axis = 2;
+		}
+
+		// Any box entered past this point is entered in a later cell, so nothing there can beat the limit.
+		if (nextBoundary[axis] > limit)
+		{
+			break;
+		}
+
+		cell[axis] += step[axis];
+
+		if (cell[axis] < rangeMin[axis] || cell[axis] > rangeMax[axis])
+		{
+			break;
+		}
+
+		nextBoundary[axis] += boundaryDelta[axis];
+	}
+}
+
+void SpatialIndex::queryAabb(const AABBf& box, std::vector<EntityHandle>& results) const
+{
+	size_t start = results.size();
+
+	visitCandidates(box, [this, &box, &results](EntityId id)
+	{
+		const Proxy& proxy = mProxies[id];
+
+		if (proxy.Bounds.intersects(box))
+		{
+			results.push_back(proxy.Handle);
+		}
+	});
+
+	removeDuplicates(results, start);
+}
+
+void SpatialIndex::queryRadius(const Vector3f& center, float radius, std::vector<EntityHandle>& results) const
+{
+	size_t start = results.size();
+	AABBf box = AABBf::fromCenter(center, Vector3f(radius, radius, radius));
+
+	visitCandidates(box, [this, &center, radius, &results](EntityId id)
+	{
+		const Proxy& proxy = mProxies[id];
+
+		if (proxy.Bounds.intersectsSphere(center, radius))
+		{
+			results.push_back(proxy.Handle);
+		}
+	});
+
+	removeDuplicates(results, start);
+}
+
+void SpatialIndex::queryRay(const Vector3f& origin, const Vector3f& direction, float maxDistance, std::vector<EntityHandle>& results) const
+{
+	ArenaScope scratch;
+	ArenaVector<std::pair<float, EntityId>> hits;
+
+	visitRay(origin, direction, maxDistance, [maxDistance, &hits](EntityId id, float distance)
+	{
+		hits.push_back(std::make_pair(distance, id));
+		return maxDistance;
+	});
+
+	// The same entity is hit at the same distance from every cell it covers.
+	std::sort(hits.begin(), hits.end());
+	hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
+
+	for (size_t i = 0; i < hits.size(); ++i)
+	{
+		results.push_back(mProxies[hits[i].second].Handle);
+	}
+}
+
+bool SpatialIndex::raycast(const Vector3f& origin, const Vector3f& direction, float maxDistance, RaycastHit& hit) const
+{
+	bool found = false;
+	hit.Distance = maxDistance;
+
+	visitRay(origin, direction, maxDistance, [this, &found, &hit](EntityId id, float distance)
+	{
+		if (distance < hit.Distance || !found)
+		{
+			hit.Entity = mProxies[id].Handle;
+			hit.Distance = distance;
+			found = true;
+		}
+
+		return hit.Distance;
+	});
+
+	return found;
+}
+
+const AABBf* SpatialIndex::getBounds(EntityId entity) const
+{
+	if (entity >= mProxies.size() || !mProxies[entity].Active)
+	{
+		return nullptr;
+	}
+
+	return &mProxies[entity].Bounds;
+}
+
+void SpatialIndex::clear()
+{
+	mProxies.clear();
+	mActive.clear();
+	mCells.clear();
+	mOversized.clear();
+	mDynamicBounds = AABBf();
+	mBvhNodes.clear();
+	mBvhItems.clear();
+	mBvhDirty = false;
+}
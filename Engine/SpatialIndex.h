@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "BoundsComponent.h"
+#include "ComponentStorage.h"
+#include "EntityHandle.h"
+#include "Math/AABB.h"
+
+class Entity;
+
+// Edge length of a grid cell in world units. Roughly the size of the typical dynamic object works best.
+#define SPATIAL_DEFAULT_CELL_SIZE 4.0f
+
+// Entities covering more cells than this skip the grid and are checked by every query instead.
+#define SPATIAL_MAX_CELLS_PER_ENTITY 64
+
+// Most entities stored in one tree leaf.
+#define SPATIAL_BVH_LEAF_SIZE 4
+
+/// <summary>
+/// An entity hit by a ray and how far along the ray it was hit.
+/// </summary>
+struct RaycastHit
+{
+	EntityHandle Entity;
+	float Distance;
+};
+
+/// <summary>
+/// Finds entities by where they are. Every entity with a BoundsComponent is indexed by its world space box:
+/// dynamic entities in a uniform hash grid that only touches the cells an entity enters or leaves, and
+/// static entities in a bounding volume hierarchy that is rebuilt only when one of them changes.
+/// The index is refreshed once per tick from the transforms that moved. Queries only read the index,
+/// so systems may run them in parallel, and return handles so results can be kept across ticks safely.
+/// </summary>
+class SpatialIndex
+{
+public:
+	SpatialIndex(float cellSize = SPATIAL_DEFAULT_CELL_SIZE);
+
+	/// <summary>
+	/// Changes the grid cell size and reinserts every dynamic entity.
+	/// </summary>
+	/// <param name="cellSize"></param>
+	void setCellSize(float cellSize);
+
+	float getCellSize() const
+	{
+		return mCellSize;
+	}
+
+	/// <summary>
+	/// Brings the index up to date. Entities whose transform moved or whose bounds changed are
+	/// reinserted, entities that lost their bounds or were destroyed are removed.
+	/// Called by the scene after world transforms have been updated.
+	/// </summary>
+	/// <param name="bounds"></param>
+	/// <param name="entities">Entity lookup table indexed by entity id.</param>
+	void update(ComponentPool<BoundsComponent>& bounds, const std::vector<Entity*>& entities);
+
+	/// <summary>
+	/// Appends every entity whose box overlaps the query box.
+	/// </summary>
+	void queryAabb(const AABBf& box, std::vector<EntityHandle>& results) const;
+
+	/// <summary>
+	/// Appends every entity whose box overlaps the sphere.
+	/// </summary>
+	void queryRadius(const Vector3f& center, float radius, std::vector<EntityHandle>& results) const;
+
+	/// <summary>
+	/// Appends every entity whose box the ray passes through, nearest first.
+	/// </summary>
+	void queryRay(const Vector3f& origin, const Vector3f& direction, float maxDistance, std::vector<EntityHandle>& results) const;
+
+	/// <summary>
+	/// Finds the nearest entity whose box the ray passes through.
+	/// </summary>
+	/// <returns>False if nothing was hit within maxDistance.</returns>
+	bool raycast(const Vector3f& origin, const Vector3f& direction, float maxDistance, RaycastHit& hit) const;
+
+	/// <summary>
+	/// Returns the world space box the index holds for an entity, or nullptr if it is not indexed.
+	/// </summary>
+	const AABBf* getBounds(EntityId entity) const;
+
+	/// <summary>
+	/// Number of indexed entities.
+	/// </summary>
+	size_t size() const
+	{
+		return mActive.size();
+	}
+
+	void clear();
+
+private:
+	struct Proxy
+	{
+		Proxy()
+			:Active(false),
+			Static(false),
+			Oversized(false),
+			Seen(0)
+		{}
+
+		EntityHandle Handle;
+		AABBf Bounds;
+		int32_t CellMin[3];
+		int32_t CellMax[3];
+		bool Active;
+		bool Static;
+		bool Oversized;
+		uint64_t Seen;
+	};
+
+	/// <summary>
+	/// Leaf nodes hold Count entities starting at First in mBvhItems.
+	/// Inner nodes have Count 0 and their children at First and First + 1.
+	/// </summary>
+	struct BvhNode
+	{
+		AABBf Bounds;
+		uint32_t First;
+		uint32_t Count;
+	};
+
+	void insertProxy(EntityId id);
+	void removeProxy(EntityId id);
+
+	void gridInsert(EntityId id);
+	void gridRemove(EntityId id);
+
+	/// <summary>
+	/// Moves a dynamic entity to its new box, touching the grid only if it covers different cells.
+	/// </summary>
+	void gridMove(EntityId id, const AABBf& bounds);
+
+	void rebuildBvh();
+	void buildBvhNode(uint32_t nodeIndex, uint32_t first, uint32_t count);
+
+	void getCellRange(const AABBf& box, int32_t* cellMin, int32_t* cellMax) const;
+	int32_t getCell(float coordinate) const;
+	static uint64_t getCellKey(int32_t x, int32_t y, int32_t z);
+
+	/// <summary>
+	/// Calls visit(id) for every entity in a grid cell, the oversized list or a tree leaf that may overlap the box.
+	/// An entity may be visited more than once.
+	/// </summary>
+	template<typename Visitor>
+	void visitCandidates(const AABBf& box, Visitor visit) const;
+
+	/// <summary>
+	/// Walks the ray through the index, calling visit(id, distance) for every entity it hits in roughly
+	/// increasing distance. Stops early once visit returns a distance no later cell or node can beat.
+	/// </summary>
+	template<typename Visitor>
+	void visitRay(const Vector3f& origin, const Vector3f& direction, float maxDistance, Visitor visit) const;
+
+	float mCellSize;
+	float mInverseCellSize;
+
+	// Indexed by entity id.
+	std::vector<Proxy> mProxies;
+	std::vector<EntityId> mActive;
+
+	std::unordered_map<uint64_t, std::vector<EntityId>> mCells;
+	std::vector<EntityId> mOversized;
+
+	// Union of every dynamic entity's box, bounds ray walks through the grid.
+	AABBf mDynamicBounds;
+
+	std::vector<BvhNode> mBvhNodes;
+	std::vector<EntityId> mBvhItems;
+	bool mBvhDirty;
+
+	uint64_t mUpdateStamp;
+};
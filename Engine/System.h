@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+
+#include "ComponentStorage.h"
+
+class Scene;
+
+/// <summary>
+/// A piece of per tick logic that runs over one or more component pools.
+/// Systems declare which component types they read and write so the scheduler can run
+/// systems that do not touch the same data at the same time.
+/// </summary>
+class ISystem
+{
+public:
+	ISystem(const std::string& name)
+		:mName(name),
+		mReads(0),
+		mWrites(0),
+		mExclusive(false)
+	{}
+
+	virtual ~ISystem() {}
+
+	/// <summary>
+	/// Runs the system for one tick. May be called from any worker thread,
+	/// except for exclusive systems, which always run on the thread updating the scene.
+	/// </summary>
+	/// <param name="scene"></param>
+	virtual void update(Scene* scene) = 0;
+
+	const std::string& getName() const { return mName; }
+	ComponentMask getReads() const { return mReads; }
+	ComponentMask getWrites() const { return mWrites; }
+	bool isExclusive() const { return mExclusive; }
+
+	/// <summary>
+	/// Returns true if the two systems cannot safely run at the same time.
+	/// </summary>
+	/// <param name="other"></param>
+	/// <returns></returns>
+	bool conflictsWith(const ISystem& other) const
+	{
+		return mExclusive || other.mExclusive ||
+			(mWrites & (other.mReads | other.mWrites)) != 0 ||
+			(other.mWrites & mReads) != 0;
+	}
+
+protected:
+	/// <summary>
+	/// Declares access to a component type. Call from the constructor.
+	/// </summary>
+	template<typename T>
+	void reads()
+	{
+		mReads |= ComponentTypes::getMask<T>();
+	}
+
+	template<typename T>
+	void writes()
+	{
+		mWrites |= ComponentTypes::getMask<T>();
+	}
+
+	/// <summary>
+	/// Marks the system as touching state outside its declared components,
+	/// so it runs alone on the thread updating the scene.
+	/// </summary>
+	void setExclusive(bool exclusive)
+	{
+		mExclusive = exclusive;
+	}
+
+private:
+	std::string mName;
+	ComponentMask mReads;
+	ComponentMask mWrites;
+	bool mExclusive;
+};
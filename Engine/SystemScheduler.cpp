@@ -0,0 +1,147 @@
+#include "SystemScheduler.h"
+
+#include "Utils/Profiler.h"
+
+ISystem* SystemScheduler::addSystem(std::unique_ptr<ISystem> system)
+{
+	std::unique_ptr<SystemNode> node = std::make_unique<SystemNode>();
+	node->System = std::move(system);
+	node->ProfileName = Profiler::internName(node->System->getName());
+	node->DependencyCount = 0;
+	node->RemainingDependencies.store(0);
+
+	ISystem* added = node->System.get();
+	mNodes.push_back(std::move(node));
+	mGraphDirty = true;
+
+	return added;
+}
+
+void SystemScheduler::buildGraph()
+{
+	for (size_t i = 0; i < mNodes.size(); ++i)
+	{
+		mNodes[i]->Dependents.clear();
+		mNodes[i]->DependencyCount = 0;
+	}
+
+	size_t phaseBegin = 0;
+
+	for (size_t i = 0; i < mNodes.size(); ++i)
+	{
+		if (mNodes[i]->System->isExclusive())
+		{
+			phaseBegin = i + 1;
+			continue;
+		}
+
+		for (size_t j = phaseBegin; j < i; ++j)
+		{
+			if (mNodes[i]->System->conflictsWith(*mNodes[j]->System))
+			{
+				mNodes[j]->Dependents.push_back(i);
+				mNodes[i]->DependencyCount++;
+			}
+		}
+	}
+
+	mGraphDirty = false;
+}
+
+void SystemScheduler::run(Scene* scene, JobSystem* jobSystem)
+{
+	if (jobSystem == nullptr || mNodes.size() <= 1)
+	{
+		for (size_t i = 0; i < mNodes.size(); ++i)
+		{
+			runInline(i, scene);
+		}
+
+		return;
+	}
+
+	if (mGraphDirty)
+	{
+		buildGraph();
+	}
+
+	size_t begin = 0;
+
+	while (begin < mNodes.size())
+	{
+		// Every system before this one has finished, and the next phase waits until it returns.
+		if (mNodes[begin]->System->isExclusive())
+		{
+			runInline(begin, scene);
+			++begin;
+			continue;
+		}
+
+		size_t end = begin + 1;
+
+		while (end < mNodes.size() && !mNodes[end]->System->isExclusive())
+		{
+			++end;
+		}
+
+		runPhase(begin, end, scene, jobSystem);
+		begin = end;
+	}
+}
+
+void SystemScheduler::runPhase(size_t begin, size_t end, Scene* scene, JobSystem* jobSystem)
+{
+	// Nothing to run alongside, so skip the round trip through the job system.
+	if (end - begin == 1)
+	{
+		runInline(begin, scene);
+		return;
+	}
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		mNodes[i]->RemainingDependencies.store(mNodes[i]->DependencyCount, std::memory_order_relaxed);
+	}
+
+	JobCounter counter;
+
+	for (size_t i = begin; i < end; ++i)
+	{
+		if (mNodes[i]->DependencyCount == 0)
+		{
+			scheduleSystem(i, scene, jobSystem, &counter);
+		}
+	}
+
+	jobSystem->wait(counter);
+}
+
+void SystemScheduler::runInline(size_t index, Scene* scene)
+{
+	PROFILE_SCOPE(mNodes[index]->ProfileName);
+	mNodes[index]->System->update(scene);
+}
+
+void SystemScheduler::scheduleSystem(size_t index, Scene* scene, JobSystem* jobSystem, JobCounter* counter)
+{
+	jobSystem->schedule([this, index, scene, jobSystem, counter]()
+	{
+		SystemNode& node = *mNodes[index];
+
+		{
+			PROFILE_SCOPE(node.ProfileName);
+			node.System->update(scene);
+		}
+
+		// Release every system that was only waiting on this one.
+		for (size_t i = 0; i < node.Dependents.size(); ++i)
+		{
+			SystemNode& dependent = *mNodes[node.Dependents[i]];
+
+			if (dependent.RemainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				scheduleSystem(node.Dependents[i], scene, jobSystem, counter);
+			}
+		}
+	}, counter);
+}
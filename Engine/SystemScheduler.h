@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "System.h"
+#include "Utils/JobSystem.h"
+
+/// <summary>
+/// Runs a scene's systems once per tick.
+/// Systems run in the order they were added unless their declared component access
+/// does not overlap, in which case they run concurrently on the job system.
+/// Exclusive systems split the tick into phases. Each one runs alone on the calling thread once every
+/// earlier system has finished, and no later system starts until it is done.
+/// </summary>
+class SystemScheduler
+{
+public:
+	SystemScheduler()
+		:mGraphDirty(false)
+	{}
+
+	~SystemScheduler() {}
+
+	/// <summary>
+	/// Adds a system after every system already registered.
+	/// </summary>
+	/// <param name="system"></param>
+	/// <returns>The system, owned by the scheduler.</returns>
+	ISystem* addSystem(std::unique_ptr<ISystem> system);
+
+	/// <summary>
+	/// Runs every system for one tick and returns once all have finished.
+	/// Runs them in order on the calling thread if there is no job system.
+	/// </summary>
+	/// <param name="scene"></param>
+	/// <param name="jobSystem"></param>
+	void run(Scene* scene, JobSystem* jobSystem);
+
+	size_t getSystemCount() const
+	{
+		return mNodes.size();
+	}
+
+private:
+	/// <summary>
+	/// A system along with the systems that have to wait for it.
+	/// </summary>
+	struct SystemNode
+	{
+		std::unique_ptr<ISystem> System;
+		const char* ProfileName;
+		std::vector<size_t> Dependents;
+		uint32_t DependencyCount;
+		std::atomic<uint32_t> RemainingDependencies;
+	};
+
+	/// <summary>
+	/// Orders each system after every earlier system it conflicts with in the same phase.
+	/// Exclusive systems end a phase, so they take no part in the graph.
+	/// </summary>
+	void buildGraph();
+
+	/// <summary>
+	/// Runs the non-exclusive systems in [begin, end) on the job system and waits for all of them.
+	/// </summary>
+	void runPhase(size_t begin, size_t end, Scene* scene, JobSystem* jobSystem);
+
+	void runInline(size_t index, Scene* scene);
+
+	void scheduleSystem(size_t index, Scene* scene, JobSystem* jobSystem, JobCounter* counter);
+
+	std::vector<std::unique_ptr<SystemNode>> mNodes;
+	bool mGraphDirty;
+};
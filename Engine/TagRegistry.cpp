@@ -0,0 +1,66 @@
+#include "TagRegistry.h"
+
+#include <cstdlib>
+
+#include "Logger/StaticLogger.h"
+
+std::mutex TagRegistry::mMutex;
+std::unordered_map<std::string, TagId> TagRegistry::mIds;
+std::unique_ptr<std::string[]> TagRegistry::mNameChunks[TAG_MAX_CHUNKS];
+std::atomic<uint32_t> TagRegistry::mNameCount(0);
+
+TagId TagRegistry::intern(const std::string& tag)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto found = mIds.find(tag);
+
+	if (found != mIds.end())
+	{
+		return found->second;
+	}
+
+	TagId id = mNameCount.load(std::memory_order_relaxed);
+
+	if (id >= TAG_NAMES_PER_CHUNK * TAG_MAX_CHUNKS)
+	{
+		// Every entity stores a tag id, so there is nothing sensible to hand back.
+		StaticLogger::instance.critical("Too many distinct tags, cannot add {string}", tag.c_str());
+		std::abort();
+	}
+
+	std::unique_ptr<std::string[]>& chunk = mNameChunks[id / TAG_NAMES_PER_CHUNK];
+
+	if (chunk == nullptr)
+	{
+		chunk.reset(new std::string[TAG_NAMES_PER_CHUNK]);
+	}
+
+	chunk[id % TAG_NAMES_PER_CHUNK] = tag;
+	mIds[tag] = id;
+
+	// Publishes the name to getName, which checks the count first.
+	mNameCount.store(id + 1, std::memory_order_release);
+
+	return id;
+}
+
+TagId TagRegistry::find(const std::string& tag)
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+
+	auto found = mIds.find(tag);
+	return found == mIds.end() ? INVALID_TAG_ID : found->second;
+}
+
+const std::string& TagRegistry::getName(TagId id)
+{
+	static const std::string invalid = "";
+
+	if (id >= mNameCount.load(std::memory_order_acquire))
+	{
+		return invalid;
+	}
+
+	return mNameChunks[id / TAG_NAMES_PER_CHUNK][id % TAG_NAMES_PER_CHUNK];
+}
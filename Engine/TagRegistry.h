@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/// <summary>
+/// Small integer standing in for a tag string.
+/// </summary>
+typedef uint32_t TagId;
+
+#define INVALID_TAG_ID 0xFFFFFFFF
+
+// Names are stored in chunks that never move, so reading one back needs no lock.
+#define TAG_NAMES_PER_CHUNK 256
+#define TAG_MAX_CHUNKS 1024
+
+/// <summary>
+/// Interns tag strings so entities can store and compare tags as integers.
+/// Each distinct tag is given an id once and keeps it for the life of the program.
+/// </summary>
+class TagRegistry
+{
+public:
+	/// <summary>
+	/// Returns the id for a tag, assigning a new one if the tag has not been seen before.
+	/// Intended for setup code, cache the id when querying every tick.
+	/// </summary>
+	/// <param name="tag"></param>
+	/// <returns></returns>
+	static TagId intern(const std::string& tag);
+
+	/// <summary>
+	/// Returns the id for a tag or INVALID_TAG_ID if no entity has ever used it.
+	/// </summary>
+	/// <param name="tag"></param>
+	/// <returns></returns>
+	static TagId find(const std::string& tag);
+
+	/// <summary>
+	/// Returns the string for a tag id. The reference stays valid for the life of the program.
+	/// Does not lock, so it is safe to call every tick from any thread.
+	/// </summary>
+	/// <param name="id"></param>
+	/// <returns></returns>
+	static const std::string& getName(TagId id);
+
+private:
+	// Guards interning. Names are only ever appended, and published through mNameCount.
+	static std::mutex mMutex;
+	static std::unordered_map<std::string, TagId> mIds;
+
+	static std::unique_ptr<std::string[]> mNameChunks[TAG_MAX_CHUNKS];
+	static std::atomic<uint32_t> mNameCount;
+};
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "TransformBenchmark.h"
+#include "Component.h"
+#include "Math/BatchTransform.h"
+#include "Utils/Timer.h"
+#include "Logger/StaticLogger.h"
+
+TransformBenchmark::Result TransformBenchmark::run(size_t entityCount, uint32_t iterations)
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+	std::vector<TransformComponent> transforms;
+	TransformSoA states;
+	transforms.reserve(entityCount);
+	states.resize(entityCount);
+
+	for (size_t i = 0; i < entityCount; ++i)
+	{
+		Quaternionf rotation(unit(random), unit(random), unit(random), unit(random));
+		rotation.normalize();
+
+		transforms.emplace_back(Vector3f(position(random), position(random), position(random)),
+			Vector3f(scale(random), scale(random), scale(random)), rotation);
+
+		const TransformState& state = transforms[i].getLocalState();
+		states.set(i, state.Position, state.Rotation, state.Scale);
+	}
+
+	std::vector<Matrix44f> batchScalar(entityCount);
+	std::vector<Matrix44f> batch(entityCount);
+
+	Result result;
+	result.EntityCount = entityCount;
+	result.Iterations = iterations;
+
+	Timer timer;
+	for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		for (size_t i = 0; i < entityCount; ++i)
+		{
+			transforms[i].calculateTransformationMatrix();
+		}
+	}
+	result.PerEntityNanos = (double)timer.nanoseconds() / iterations;
+
+	timer.reset();
+	for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		BatchTransform::computeModelMatricesScalar(states, batchScalar.data());
+	}
+	result.BatchScalarNanos = (double)timer.nanoseconds() / iterations;
+
+	timer.reset();
+	for (uint32_t iteration = 0; iteration < iterations; ++iteration)
+	{
+		BatchTransform::computeModelMatrices(states, batch.data());
+	}
+	result.BatchNanos = (double)timer.nanoseconds() / iterations;
+
+	// Comparing against the per-entity matrices also keeps every loop's output alive.
+	result.MaxError = 0;
+	for (size_t i = 0; i < entityCount; ++i)
+	{
+		const Matrix44f& expected = transforms[i].getTransformationMatrix();
+
+		for (int row = 0; row < 4; ++row)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				float error = std::fabs(batch[i].data[row][column] - expected.data[row][column]);
+				float scalarError = std::fabs(batchScalar[i].data[row][column] - expected.data[row][column]);
+
+				result.MaxError = std::fmax(result.MaxError, std::fmax(error, scalarError));
+			}
+		}
+	}
+
+	return result;
+}
+
+void TransformBenchmark::log(const Result& result)
+{
+	StaticLogger::instance.trace("Model matrix benchmark: {int} entities, {int} iterations, {string} kernel",
+		(int)result.EntityCount, (int)result.Iterations, BatchTransform::getInstructionSet());
+	StaticLogger::instance.trace("  per entity:   {.3float} us", result.PerEntityNanos / 1000.0);
+	StaticLogger::instance.trace("  batch scalar: {.3float} us", result.BatchScalarNanos / 1000.0);
+	StaticLogger::instance.trace("  batch:        {.3float} us ({.2float}x)", result.BatchNanos / 1000.0,
+		result.PerEntityNanos / (result.BatchNanos > 0 ? result.BatchNanos : 1.0));
+	StaticLogger::instance.trace("  max error:    {float}", (double)result.MaxError);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/// <summary>
+/// Microbenchmark comparing the per-entity model matrix path with the batch kernel.
+/// Run it on the target machine to see what BatchTransform buys at a given entity count.
+/// </summary>
+class TransformBenchmark
+{
+public:
+	struct Result
+	{
+		size_t EntityCount;
+		uint32_t Iterations;
+
+		/// <summary>
+		/// Average nanoseconds per iteration for each path.
+		/// </summary>
+		double PerEntityNanos;
+		double BatchScalarNanos;
+		double BatchNanos;
+
+		/// <summary>
+		/// Largest difference between any batch matrix element and the per-entity result.
+		/// </summary>
+		float MaxError;
+	};
+
+	/// <summary>
+	/// Builds entityCount random transforms and times every path over them.
+	/// </summary>
+	/// <param name="entityCount"></param>
+	/// <param name="iterations"></param>
+	/// <returns></returns>
+	static Result run(size_t entityCount, uint32_t iterations);
+
+	/// <summary>
+	/// Writes a result to the static logger.
+	/// </summary>
+	/// <param name="result"></param>
+	static void log(const Result& result);
+};
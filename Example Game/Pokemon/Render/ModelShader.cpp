@@ -9,8 +9,6 @@ ModelShader::ModelShader()
     locationModelMatrix(0),
     locationLightPos(0)
 {
-    loadShaders(GameManager::resPath("shaders/ModelShader.vert"),
-        GameManager::resPath("shaders/ModelShader.frag"));
 }
 
 void ModelShader::setUniformLocations() 
@@ -5,6 +5,9 @@
 
 class ModelShader : public ShaderProgram {
     public:
+        /**
+         * Creates the program without its shaders, the resource loader reads and compiles them
+         * */
         ModelShader();
 
         ~ModelShader() 
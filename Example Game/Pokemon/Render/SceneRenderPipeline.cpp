@@ -8,42 +8,115 @@
 #include "SceneRenderPipeline.h"
 #include "Engine/GameManager.h"
 #include "Engine/GameWindow.h"
+#include "Logger/StaticLogger.h"
 
 #include "Serializers/OBJ Serializer/ModelLoader.h"
 
 void RenderMainScene::init(Scene& scene)
 {
-	mCamera = static_cast<Camera3D*>(scene.getEntityWithTag("Camera"));
+	Camera3D* camera = static_cast<Camera3D*>(scene.getEntityWithTag("Camera"));
+	mProjection = camera->getProjection();
 
-	mModelShader = static_cast<ModelShader*>(GameManager::Resources.
-		ShaderResources.getRegistry(SHADER_MODEL));
-
-	mModelShader->bind();
-	mModelShader->loadDiffuseTexture(0);
-	mModelShader->loadCameraProjection(mCamera->getProjection());
+	// Look the shader up by name once, every frame after that goes through the handle.
+	ResourceManager<ShaderProgram>& shaders = GameManager::Resources.ShaderResources;
+	mModelShaderRef = ResourceRef<ShaderProgram>(shaders, shaders.getHandle(SHADER_MODEL));
 }
 
 void RenderMainScene::prepare(Scene& scene)
 {
+	mModelShader = static_cast<ModelShader*>(mModelShaderRef.get());
+
+	// The shader failed to load or was removed: skip the pass until it is back.
+	if (mModelShader == nullptr)
+	{
+		if (!mModelShaderMissing)
+		{
+			StaticLogger::instance.warning("Model shader is not loaded, skipping the main scene");
+			mModelShaderMissing = true;
+		}
+
+		return;
+	}
+
+	mModelShaderMissing = false;
 	mModelShader->bind();
 
+	// Uniforms that never change only need setting again when the shader has been reloaded.
+	uint32_t version = mModelShaderRef.getVersion();
+
+	if (version != mModelShaderVersion)
+	{
+		mModelShader->loadDiffuseTexture(0);
+		mModelShader->loadCameraProjection(mProjection);
+		mModelShaderVersion = version;
+	}
+
 	mModelShader->loadLightPosition(Vector3f(0, 50, 0));
 }
 
 void RenderMainScene::execute(Scene& scene)
 {
-	mCamera->calculateViewMatrix();
-	mModelShader->loadCameraViewMatrix(mCamera->getViewMatrix());
+	if (mModelShader == nullptr)
+	{
+		return;
+	}
+
+	// Everything drawn comes from the snapshot published by the update thread.
+	const RenderPacket& packet = scene.getRenderPacket();
 
-	const std::vector<std::unique_ptr<Entity>>& entities = scene.getEntities();
+	// Blend between the last two update ticks so motion is smooth at any frame rate.
+	float alpha = GameManager::getInterpolationAlpha(packet.TickNanos);
 
-	// Render each entity.
-	int entityCount = (int)entities.size();
-	for (int i = 0; i < entityCount; i++)
+	if (packet.View.Active)
 	{
-		entities[i]->getTransform()->calculateTransformationMatrix();
-		mModelShader->loadModelMatrix(entities[i]->getTransform()->getTransformationMatrix());
-		entities[i]->render();
+		TransformState view = TransformState::interpolate(packet.View.Previous, packet.View.Current, alpha);
+		mModelShader->loadCameraViewMatrix(Camera3D::calculateViewMatrix(view.Position, view.Rotation));
+	}
+
+	// Blend every item that moved this tick, then build all of their model matrices at once.
+	int itemCount = (int)packet.Items.size();
+	mBlendedStates.clear();
+
+	for (int i = 0; i < itemCount; i++)
+	{
+		const RenderItem& item = packet.Items[i];
+
+		if (item.Moving)
+		{
+			TransformState blended = TransformState::interpolate(item.Previous, item.Current, alpha);
+			mBlendedStates.push(blended.Position, blended.Rotation, blended.Scale);
+		}
+	}
+
+	mBlendedMatrices.resize(mBlendedStates.size());
+	BatchTransform::computeModelMatrices(mBlendedStates, mBlendedMatrices.data());
+
+	ResourceManager<Mesh>& meshes = GameManager::Resources.MeshResources;
+	ResourceManager<Texture>& textures = GameManager::Resources.TextureResources;
+
+	// Render each item.
+	size_t blendedIndex = 0;
+	for (int i = 0; i < itemCount; i++)
+	{
+		const RenderItem& item = packet.Items[i];
+		const Matrix44f& model = item.Moving ? mBlendedMatrices[blendedIndex++] : item.Model;
+
+		Mesh* geometry = meshes.get(item.Geometry);
+		Texture* diffuse = textures.get(item.Diffuse);
+
+		// Skip anything that is still loading.
+		if (geometry == nullptr || diffuse == nullptr)
+		{
+			continue;
+		}
+
+		// Items that did not move this tick already carry their model matrix.
+		mModelShader->loadModelMatrix(model);
+
+		// Bind the texture to slot 0.
+		diffuse->bind(0);
+
+		geometry->render();
 	}
 }
 
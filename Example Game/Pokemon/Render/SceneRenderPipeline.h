@@ -8,6 +8,8 @@
 #include "Engine/Scene.h"
 #include "Render Engine/Framebuffer.h"
 #include "Engine/Entity.h"
+#include "Engine/ResourceManager.h"
+#include "Math/BatchTransform.h"
 
 #include "Example Game/Pokemon/Render/ModelShader.h"
 
@@ -20,7 +22,8 @@ class RenderMainScene : public RenderPipelineStage
 public:
 	RenderMainScene()
 		:mModelShader(nullptr),
-		mCamera(nullptr){ }
+		mModelShaderVersion(0xFFFFFFFF),
+		mModelShaderMissing(false) { }
 
 	void init(Scene& scene);
 
@@ -30,7 +33,18 @@ protected:
 
 private:
 	ModelShader* mModelShader;
-	Camera3D* mCamera;
+	ResourceRef<ShaderProgram> mModelShaderRef;
+
+	// Version of the shader the constant uniforms were last set on.
+	uint32_t mModelShaderVersion;
+
+	// Set once the missing shader has been reported, so it is logged once rather than every frame.
+	bool mModelShaderMissing;
+	Matrix44f mProjection;
+
+	// Blended transforms of the items that moved this tick and their model matrices, built in one batch.
+	TransformSoA mBlendedStates;
+	std::vector<Matrix44f> mBlendedMatrices;
 };
 
 class RenderMainScenePipeline : public RenderPipeline
@@ -23,12 +23,16 @@ public:
 
 	virtual void loadShaders(ResourceManager<ShaderProgram>& shaderResources)
 	{
-		// Load the model shader.
-		std::unique_ptr<ShaderProgram> shader = std::make_unique<ModelShader>();
-		shaderResources.addRegistry(SHADER_MODEL, std::move(shader));
 	}
 
 	virtual void loadMeshes(ResourceManager<Mesh>& meshResources)
 	{
 	}
+
+	virtual void queueResources(AsyncResourceLoader& loader)
+	{
+		// Load the model shader.
+		loader.loadShader(SHADER_MODEL, GameManager::resPath("shaders/ModelShader.vert"), GameManager::resPath("shaders/ModelShader.frag"),
+			[]() { return std::unique_ptr<ShaderProgram>(new ModelShader()); });
+	}
 };
@@ -6,8 +6,7 @@
 #include "Engine/GameManager.h"
 
 GameScene::GameScene()
-	:Scene(std::make_unique<RenderMainScenePipeline>()),
-    mCamera(nullptr)
+	:Scene(std::make_unique<RenderMainScenePipeline>())
 {
 }
 
@@ -15,22 +14,24 @@ void GameScene::onInit()
 {
     // Create camera.
     std::unique_ptr<Camera3D> sceneCamera = std::make_unique<Camera3D>();
-    mCamera = sceneCamera.get();
+
+    // There is no window when running headless.
+    GameWindow* window = GameManager::getGameWindow();
+    float aspectRatio = (window != nullptr)? window->getAspectRatio() : 16.0f / 9.0f;
+
 	sceneCamera->createProjectionMatrix(1.5,
-		GameManager::getGameWindow()->getAspectRatio(),
+		aspectRatio,
 		.5f, 100);
 
-    sceneCamera->getTransform()->Position.y = 55;
-    sceneCamera->getTransform()->Position.z = 15;
+    sceneCamera->getTransform()->setPosition(Vector3f(0, 55, 15));
     sceneCamera->getTransform()->lookAt(Vector3f(0, 0, 0));
 
+    Camera3D* camera = sceneCamera.get();
     addEntity(std::move(sceneCamera));
+    mCamera = camera->getHandle();
 }
 
 void GameScene::update()
 {
-    for (int i = 0; i < mEntities.size(); i++)
-    {
-        mEntities[i]->update(this);
-    }
+    Scene::update();
 }
\ No newline at end of file
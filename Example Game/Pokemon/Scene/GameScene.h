@@ -16,9 +16,9 @@ public:
 
 	virtual void update();
 
-	Camera3D* getCamera() { return mCamera; }
+	Camera3D* getCamera() { return static_cast<Camera3D*>(getEntity(mCamera)); }
 
 protected:
 	void onInit();
-	Camera3D* mCamera;
+	EntityHandle mCamera;
 };
@@ -1,7 +1,9 @@
+#include <cstdlib>
 #include <vector>
 #include <string>
 
 #include "Engine/GameManager.h"
+#include "Engine/TransformBenchmark.h"
 #include "Scene/GameScene.h"
 #include "Logger/StaticLogger.h"
 #include "Serializers/OBJ Serializer/ModelLoader.h"
@@ -14,8 +16,97 @@
 
 using namespace Pkmn;
 
-int main()
+/// <summary>
+/// Runs the tank scene with no window or graphics context, for servers and CI perf runs.
+/// Usage: --headless [ticks=600] [packet csv] [--profile trace json] [--frame-stats csv] [--frame-histogram csv]
+///     [--record-input file] [--replay-input file]
+/// A replay with no tick count given runs until the recorded input ends.
+/// </summary>
+static int runHeadless(int argc, char** argv)
 {
+	GameManager::HeadlessConfig config(600);
+	int positional = 0;
+
+	for (int i = 2; i < argc; i++)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "--profile" && i + 1 < argc)
+		{
+			config.files.profileTracePath = argv[++i];
+		}
+		else if (arg == "--frame-stats" && i + 1 < argc)
+		{
+			config.files.frameStatsPath = argv[++i];
+		}
+		else if (arg == "--frame-histogram" && i + 1 < argc)
+		{
+			config.files.frameHistogramPath = argv[++i];
+		}
+		else if (arg == "--record-input" && i + 1 < argc)
+		{
+			config.files.inputRecordPath = argv[++i];
+		}
+		else if (arg == "--replay-input" && i + 1 < argc)
+		{
+			config.files.inputReplayPath = argv[++i];
+		}
+		else if (positional == 0)
+		{
+			config.tickCount = std::strtoull(arg.c_str(), nullptr, 10);
+			positional++;
+		}
+		else if (positional == 1)
+		{
+			config.recordPath = arg;
+			positional++;
+		}
+		else
+		{
+			StaticLogger::instance.warning("Ignoring unknown headless argument: {string}", arg.c_str());
+		}
+	}
+
+	if (positional == 0 && !config.files.inputReplayPath.empty())
+	{
+		config.tickCount = 0;
+	}
+
+	GameManager::setResPath("res/");
+	GameManager::setScene(std::make_unique<GameScene>());
+	GameManager::loadSettings(GameManager::resPath("settings.json"));
+	GameManager::startHeadless(config);
+
+	return 0;
+}
+
+/// <summary>
+/// Times the per-entity and batched model matrix paths and logs the result.
+/// Usage: --transform-benchmark [entities] [iterations]
+/// </summary>
+static int runTransformBenchmark(int argc, char** argv)
+{
+	size_t entities = (argc > 2) ? (size_t)std::strtoull(argv[2], nullptr, 10) : 10000;
+	uint32_t iterations = (argc > 3) ? (uint32_t)std::strtoul(argv[3], nullptr, 10) : 100;
+
+	TransformBenchmark::Result result = TransformBenchmark::run(entities, (iterations != 0) ? iterations : 1);
+	TransformBenchmark::log(result);
+
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc > 1 && std::string(argv[1]) == "--headless")
+	{
+		return runHeadless(argc, argv);
+	}
+
+	if (argc > 1 && std::string(argv[1]) == "--transform-benchmark")
+	{
+		return runTransformBenchmark(argc, argv);
+	}
+
 	/**
 	GameManager::setResPath("res/");
 	GameManager::setScene(std::make_unique<GameScene>());
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <ostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <string.h>
 #include <stdarg.h>
@@ -529,7 +530,19 @@ class DebugLogger {
          * @param level the current log level
          * */
         inline int logInternal(std::ostream& output, const char* format, va_list& args, bool recursive = false) {
-            std::stringstream outputLine;
+            //top level lines reuse one stream per thread rather than constructing a stream for every message
+            static thread_local std::stringstream reusedLine;
+            std::unique_ptr<std::stringstream> nestedLine;
+
+            if(recursive) {
+                nestedLine.reset(new std::stringstream());
+            }
+            else {
+                reusedLine.str(std::string());
+                reusedLine.clear();
+            }
+
+            std::stringstream& outputLine = recursive? *nestedLine : reusedLine;
 
             //print prefix to message using only internal variables
             if(!recursive) {
@@ -550,8 +563,9 @@ class DebugLogger {
                 outputLine << "\n";
             }
 
-            output << outputLine.str();
-            return (int)outputLine.str().size();
+            std::string line = outputLine.str();
+            output << line;
+            return (int)line.size();
         }
 
         /**
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "Vector3.h"
+#include "Matrix44.h"
+
+/// <summary>
+/// Axis aligned bounding box stored as its minimum and maximum corners.
+/// A default constructed box is empty: it contains nothing and merging anything into it yields that thing.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+template<typename T>
+class AABB
+{
+public:
+	AABB()
+		:Min(std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), std::numeric_limits<T>::max()),
+		Max(std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest(), std::numeric_limits<T>::lowest())
+	{}
+
+	AABB(const Vector3<T>& min, const Vector3<T>& max)
+		:Min(min),
+		Max(max)
+	{}
+
+	/// <summary>
+	/// Builds the box from its center and half size along each axis.
+	/// </summary>
+	static AABB<T> fromCenter(const Vector3<T>& center, const Vector3<T>& halfExtents)
+	{
+		return AABB<T>(center - halfExtents, center + halfExtents);
+	}
+
+	bool isEmpty() const
+	{
+		return Min.x > Max.x || Min.y > Max.y || Min.z > Max.z;
+	}
+
+	Vector3<T> getCenter() const
+	{
+		return (Min + Max) * (T)0.5;
+	}
+
+	Vector3<T> getHalfExtents() const
+	{
+		return (Max - Min) * (T)0.5;
+	}
+
+	T getSurfaceArea() const
+	{
+		Vector3<T> size = Max - Min;
+		return (T)2 * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	/// <summary>
+	/// Grows the box to include a point.
+	/// </summary>
+	void merge(const Vector3<T>& point)
+	{
+		Min = Vector3<T>(std::fmin(Min.x, point.x), std::fmin(Min.y, point.y), std::fmin(Min.z, point.z));
+		Max = Vector3<T>(std::fmax(Max.x, point.x), std::fmax(Max.y, point.y), std::fmax(Max.z, point.z));
+	}
+
+	/// <summary>
+	/// Grows the box to include another box.
+	/// </summary>
+	void merge(const AABB<T>& other)
+	{
+		Min = Vector3<T>(std::fmin(Min.x, other.Min.x), std::fmin(Min.y, other.Min.y), std::fmin(Min.z, other.Min.z));
+		Max = Vector3<T>(std::fmax(Max.x, other.Max.x), std::fmax(Max.y, other.Max.y), std::fmax(Max.z, other.Max.z));
+	}
+
+	bool contains(const Vector3<T>& point) const
+	{
+		return point.x >= Min.x && point.x <= Max.x
+			&& point.y >= Min.y && point.y <= Max.y
+			&& point.z >= Min.z && point.z <= Max.z;
+	}
+
+	bool intersects(const AABB<T>& other) const
+	{
+		return Min.x <= other.Max.x && Max.x >= other.Min.x
+			&& Min.y <= other.Max.y && Max.y >= other.Min.y
+			&& Min.z <= other.Max.z && Max.z >= other.Min.z;
+	}
+
+	/// <summary>
+	/// Squared distance from a point to the closest point of the box, 0 if the point is inside.
+	/// </summary>
+	T distanceSquared(const Vector3<T>& point) const
+	{
+		T dx = std::fmax(std::fmax(Min.x - point.x, (T)0), point.x - Max.x);
+		T dy = std::fmax(std::fmax(Min.y - point.y, (T)0), point.y - Max.y);
+		T dz = std::fmax(std::fmax(Min.z - point.z, (T)0), point.z - Max.z);
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	bool intersectsSphere(const Vector3<T>& center, T radius) const
+	{
+		return distanceSquared(center) <= radius * radius;
+	}
+
+	/// <summary>
+	/// Slab test against a ray.
+	/// </summary>
+	/// <param name="origin"></param>
+	/// <param name="inverseDirection">One over each component of the normalized ray direction. Infinite components are fine.</param>
+	/// <param name="maxDistance">Hits further along the ray than this are ignored.</param>
+	/// <param name="distance">Distance along the ray to the entry point, 0 if the ray starts inside.</param>
+	/// <returns></returns>
+	bool intersectsRay(const Vector3<T>& origin, const Vector3<T>& inverseDirection, T maxDistance, T& distance) const
+	{
+		T tx1 = (Min.x - origin.x) * inverseDirection.x;
+		T tx2 = (Max.x - origin.x) * inverseDirection.x;
+		T ty1 = (Min.y - origin.y) * inverseDirection.y;
+		T ty2 = (Max.y - origin.y) * inverseDirection.y;
+		T tz1 = (Min.z - origin.z) * inverseDirection.z;
+		T tz2 = (Max.z - origin.z) * inverseDirection.z;
+
+		// fmin/fmax drop the NaN produced when the origin lies on a slab and the direction is parallel to it.
+		T entry = std::fmax(std::fmax(std::fmin(tx1, tx2), std::fmin(ty1, ty2)), std::fmin(tz1, tz2));
+		T exit = std::fmin(std::fmin(std::fmax(tx1, tx2), std::fmax(ty1, ty2)), std::fmax(tz1, tz2));
+
+		entry = std::fmax(entry, (T)0);
+
+		if (entry > exit || entry > maxDistance)
+		{
+			return false;
+		}
+
+		distance = entry;
+		return true;
+	}
+
+	/// <summary>
+	/// Returns the box enclosing this box after it has been transformed by a matrix.
+	/// </summary>
+	AABB<T> transformed(const Matrix44<T>& matrix) const
+	{
+		if (isEmpty())
+		{
+			return *this;
+		}
+
+		Vector3<T> center = getCenter();
+		Vector3<T> half = getHalfExtents();
+		Vector3<T> newCenter;
+		Vector3<T> newHalf;
+
+		// Columns of the matrix are the transformed axes, translation is the last column.
+		newCenter.x = matrix.data[0][0] * center.x + matrix.data[1][0] * center.y + matrix.data[2][0] * center.z + matrix.data[3][0];
+		newCenter.y = matrix.data[0][1] * center.x + matrix.data[1][1] * center.y + matrix.data[2][1] * center.z + matrix.data[3][1];
+		newCenter.z = matrix.data[0][2] * center.x + matrix.data[1][2] * center.y + matrix.data[2][2] * center.z + matrix.data[3][2];
+
+		newHalf.x = std::fabs(matrix.data[0][0]) * half.x + std::fabs(matrix.data[1][0]) * half.y + std::fabs(matrix.data[2][0]) * half.z;
+		newHalf.y = std::fabs(matrix.data[0][1]) * half.x + std::fabs(matrix.data[1][1]) * half.y + std::fabs(matrix.data[2][1]) * half.z;
+		newHalf.z = std::fabs(matrix.data[0][2]) * half.x + std::fabs(matrix.data[1][2]) * half.y + std::fabs(matrix.data[2][2]) * half.z;
+
+		return fromCenter(newCenter, newHalf);
+	}
+
+	Vector3<T> Min;
+	Vector3<T> Max;
+};
+
+typedef AABB<float> AABBf;
+typedef AABB<double> AABBd;
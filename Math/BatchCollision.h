@@ -0,0 +1,386 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Vector3.h"
+#include "Sphere.h"
+#include "OBB.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__AVX__)
+#define BATCH_COLLISION_SSE
+#endif
+
+#if defined(BATCH_COLLISION_SSE)
+#include <xmmintrin.h>
+#endif
+
+/// <summary>
+/// Pairs of spheres laid out one array per component so a batch kernel can test several pairs at once.
+/// </summary>
+struct SpherePairSoA
+{
+	void clear()
+	{
+		resize(0);
+	}
+
+	void resize(size_t count)
+	{
+		AX.resize(count);
+		AY.resize(count);
+		AZ.resize(count);
+		ARadius.resize(count);
+		BX.resize(count);
+		BY.resize(count);
+		BZ.resize(count);
+		BRadius.resize(count);
+	}
+
+	size_t size() const
+	{
+		return AX.size();
+	}
+
+	void push(const Spheref& a, const Spheref& b)
+	{
+		AX.push_back(a.Center.x);
+		AY.push_back(a.Center.y);
+		AZ.push_back(a.Center.z);
+		ARadius.push_back(a.Radius);
+		BX.push_back(b.Center.x);
+		BY.push_back(b.Center.y);
+		BZ.push_back(b.Center.z);
+		BRadius.push_back(b.Radius);
+	}
+
+	std::vector<float> AX, AY, AZ, ARadius;
+	std::vector<float> BX, BY, BZ, BRadius;
+};
+
+/// <summary>
+/// Sphere and box pairs laid out one array per component.
+/// </summary>
+struct SphereBoxSoA
+{
+	void clear()
+	{
+		resize(0);
+	}
+
+	void resize(size_t count)
+	{
+		SphereX.resize(count);
+		SphereY.resize(count);
+		SphereZ.resize(count);
+		Radius.resize(count);
+		BoxX.resize(count);
+		BoxY.resize(count);
+		BoxZ.resize(count);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			AxisX[i].resize(count);
+			AxisY[i].resize(count);
+			AxisZ[i].resize(count);
+			Half[i].resize(count);
+		}
+	}
+
+	size_t size() const
+	{
+		return SphereX.size();
+	}
+
+	void push(const Spheref& sphere, const OBBf& box)
+	{
+		SphereX.push_back(sphere.Center.x);
+		SphereY.push_back(sphere.Center.y);
+		SphereZ.push_back(sphere.Center.z);
+		Radius.push_back(sphere.Radius);
+		BoxX.push_back(box.Center.x);
+		BoxY.push_back(box.Center.y);
+		BoxZ.push_back(box.Center.z);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			AxisX[i].push_back(box.Axes[i].x);
+			AxisY[i].push_back(box.Axes[i].y);
+			AxisZ[i].push_back(box.Axes[i].z);
+			Half[i].push_back(box.getHalfExtent(i));
+		}
+	}
+
+	OBBf getBox(size_t index) const
+	{
+		OBBf box;
+		box.Center = Vector3f(BoxX[index], BoxY[index], BoxZ[index]);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			box.Axes[i] = Vector3f(AxisX[i][index], AxisY[i][index], AxisZ[i][index]);
+		}
+
+		box.HalfExtents = Vector3f(Half[0][index], Half[1][index], Half[2][index]);
+		return box;
+	}
+
+	std::vector<float> SphereX, SphereY, SphereZ, Radius;
+	std::vector<float> BoxX, BoxY, BoxZ;
+	std::vector<float> AxisX[3], AxisY[3], AxisZ[3];
+	std::vector<float> Half[3];
+};
+
+/// <summary>
+/// Result of each pair in a batch: whether it touches and, if so, the unit normal from the first
+/// shape towards the second and how deep they overlap along it.
+/// </summary>
+struct ContactSoA
+{
+	void resize(size_t count)
+	{
+		Hit.resize(count);
+		NormalX.resize(count);
+		NormalY.resize(count);
+		NormalZ.resize(count);
+		Depth.resize(count);
+	}
+
+	void set(size_t index, bool hit, const Vector3f& normal, float depth)
+	{
+		Hit[index] = hit ? 1 : 0;
+		NormalX[index] = normal.x;
+		NormalY[index] = normal.y;
+		NormalZ[index] = normal.z;
+		Depth[index] = depth;
+	}
+
+	std::vector<uint8_t> Hit;
+	std::vector<float> NormalX, NormalY, NormalZ;
+	std::vector<float> Depth;
+};
+
+/// <summary>
+/// Narrowphase overlap tests for many pairs at once.
+/// Gives the same results as Sphere::intersects and OBB::intersectsSphere, four pairs at a time
+/// with SSE when the compiler targets it, otherwise a scalar loop.
+/// </summary>
+class BatchCollision
+{
+public:
+	/// <summary>
+	/// Tests every sphere pair. Normals point from sphere A to sphere B.
+	/// </summary>
+	static void testSpheres(const SpherePairSoA& pairs, ContactSoA& out)
+	{
+		size_t count = pairs.size();
+		size_t done = 0;
+		out.resize(count);
+
+#if defined(BATCH_COLLISION_SSE)
+		done = testSpheresSSE(pairs, out, count);
+#endif
+
+		testSpheresScalar(pairs, out, done, count);
+	}
+
+	/// <summary>
+	/// Tests every sphere against its box. Normals point from the sphere to the box.
+	/// </summary>
+	static void testSphereBoxes(const SphereBoxSoA& pairs, ContactSoA& out)
+	{
+		size_t count = pairs.size();
+		size_t done = 0;
+		out.resize(count);
+
+#if defined(BATCH_COLLISION_SSE)
+		done = testSphereBoxesSSE(pairs, out, count);
+#endif
+
+		testSphereBoxesScalar(pairs, out, done, count);
+	}
+
+	/// <summary>
+	/// Name of the instruction set the batch tests were compiled for.
+	/// </summary>
+	static const char* getInstructionSet()
+	{
+#if defined(BATCH_COLLISION_SSE)
+		return "SSE";
+#else
+		return "Scalar";
+#endif
+	}
+
+private:
+	static void testSpheresScalar(const SpherePairSoA& p, ContactSoA& out, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			testSphere(p, out, i);
+		}
+	}
+
+	static void testSphere(const SpherePairSoA& p, ContactSoA& out, size_t i)
+	{
+		Spheref a(Vector3f(p.AX[i], p.AY[i], p.AZ[i]), p.ARadius[i]);
+		Spheref b(Vector3f(p.BX[i], p.BY[i], p.BZ[i]), p.BRadius[i]);
+		Vector3f normal;
+		float depth = 0;
+
+		bool hit = a.intersects(b, normal, depth);
+		out.set(i, hit, normal, depth);
+	}
+
+	static void testSphereBoxesScalar(const SphereBoxSoA& p, ContactSoA& out, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			testSphereBox(p, out, i);
+		}
+	}
+
+	static void testSphereBox(const SphereBoxSoA& p, ContactSoA& out, size_t i)
+	{
+		Vector3f normal;
+		float depth = 0;
+
+		bool hit = p.getBox(i).intersectsSphere(Vector3f(p.SphereX[i], p.SphereY[i], p.SphereZ[i]), p.Radius[i], normal, depth);
+
+		// The box reports its normal towards the sphere.
+		out.set(i, hit, normal * -1.0f, depth);
+	}
+
+#if defined(BATCH_COLLISION_SSE)
+	static void storeResults(ContactSoA& out, size_t i, __m128 hit, __m128 nx, __m128 ny, __m128 nz, __m128 depth)
+	{
+		int mask = _mm_movemask_ps(hit);
+
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			out.Hit[i + lane] = (uint8_t)((mask >> lane) & 1);
+		}
+
+		_mm_storeu_ps(&out.NormalX[i], nx);
+		_mm_storeu_ps(&out.NormalY[i], ny);
+		_mm_storeu_ps(&out.NormalZ[i], nz);
+		_mm_storeu_ps(&out.Depth[i], depth);
+	}
+
+	static size_t testSpheresSSE(const SpherePairSoA& p, ContactSoA& out, size_t count)
+	{
+		size_t i = 0;
+		const __m128 zero = _mm_setzero_ps();
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 dx = _mm_sub_ps(_mm_loadu_ps(&p.BX[i]), _mm_loadu_ps(&p.AX[i]));
+			__m128 dy = _mm_sub_ps(_mm_loadu_ps(&p.BY[i]), _mm_loadu_ps(&p.AY[i]));
+			__m128 dz = _mm_sub_ps(_mm_loadu_ps(&p.BZ[i]), _mm_loadu_ps(&p.AZ[i]));
+			__m128 radii = _mm_add_ps(_mm_loadu_ps(&p.ARadius[i]), _mm_loadu_ps(&p.BRadius[i]));
+
+			__m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			__m128 hit = _mm_cmple_ps(distanceSquared, _mm_mul_ps(radii, radii));
+			__m128 distance = _mm_sqrt_ps(distanceSquared);
+			__m128 inverse = _mm_div_ps(_mm_set1_ps(1.0f), distance);
+
+			storeResults(out, i, hit, _mm_mul_ps(dx, inverse), _mm_mul_ps(dy, inverse), _mm_mul_ps(dz, inverse), _mm_sub_ps(radii, distance));
+
+			// Concentric spheres have no direction, let the scalar test pick one.
+			int concentric = _mm_movemask_ps(_mm_and_ps(hit, _mm_cmpeq_ps(distanceSquared, zero)));
+
+			for (int lane = 0; concentric != 0; ++lane, concentric >>= 1)
+			{
+				if (concentric & 1)
+				{
+					testSphere(p, out, i + lane);
+				}
+			}
+		}
+
+		return i;
+	}
+
+	static __m128 select(__m128 mask, __m128 a, __m128 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	static size_t testSphereBoxesSSE(const SphereBoxSoA& p, ContactSoA& out, size_t count)
+	{
+		size_t i = 0;
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 radius = _mm_loadu_ps(&p.Radius[i]);
+
+			__m128 ox = _mm_sub_ps(_mm_loadu_ps(&p.SphereX[i]), _mm_loadu_ps(&p.BoxX[i]));
+			__m128 oy = _mm_sub_ps(_mm_loadu_ps(&p.SphereY[i]), _mm_loadu_ps(&p.BoxY[i]));
+			__m128 oz = _mm_sub_ps(_mm_loadu_ps(&p.SphereZ[i]), _mm_loadu_ps(&p.BoxZ[i]));
+
+			// Works in the box's axes like OBB::intersectsSphere: the part of the offset beyond the
+			// half size gives the distance from the closest point, and the center is inside when
+			// no axis has any. The face the center is least deep behind is tracked for that case.
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			__m128 distanceSquared = zero;
+			__m128 bx = zero;
+			__m128 by = zero;
+			__m128 bz = zero;
+			__m128 nearestGap = _mm_set1_ps(std::numeric_limits<float>::max());
+			__m128 fx = zero;
+			__m128 fy = zero;
+			__m128 fz = zero;
+
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				__m128 ax = _mm_loadu_ps(&p.AxisX[axis][i]);
+				__m128 ay = _mm_loadu_ps(&p.AxisY[axis][i]);
+				__m128 az = _mm_loadu_ps(&p.AxisZ[axis][i]);
+				__m128 half = _mm_loadu_ps(&p.Half[axis][i]);
+
+				__m128 projected = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, ax), _mm_mul_ps(oy, ay)), _mm_mul_ps(oz, az));
+				__m128 clamped = _mm_max_ps(_mm_sub_ps(zero, half), _mm_min_ps(projected, half));
+				__m128 beyond = _mm_sub_ps(projected, clamped);
+
+				distanceSquared = _mm_add_ps(distanceSquared, _mm_mul_ps(beyond, beyond));
+				bx = _mm_add_ps(bx, _mm_mul_ps(ax, beyond));
+				by = _mm_add_ps(by, _mm_mul_ps(ay, beyond));
+				bz = _mm_add_ps(bz, _mm_mul_ps(az, beyond));
+
+				__m128 absolute = _mm_andnot_ps(signBit, projected);
+				__m128 gap = _mm_sub_ps(half, absolute);
+				__m128 nearer = _mm_cmplt_ps(gap, nearestGap);
+
+				// The face on the side of the center, its normal pointing out of the box.
+				__m128 flip = _mm_and_ps(_mm_cmplt_ps(projected, zero), signBit);
+
+				inside = _mm_and_ps(inside, _mm_cmple_ps(absolute, half));
+				nearestGap = select(nearer, gap, nearestGap);
+				fx = select(nearer, _mm_xor_ps(ax, flip), fx);
+				fy = select(nearer, _mm_xor_ps(ay, flip), fy);
+				fz = select(nearer, _mm_xor_ps(az, flip), fz);
+			}
+
+			// Outside: from the sphere towards the closest point, which is towards the box.
+			__m128 distance = _mm_sqrt_ps(distanceSquared);
+			__m128 inverse = _mm_div_ps(_mm_set1_ps(-1.0f), distance);
+			__m128 hit = _mm_or_ps(inside, _mm_cmple_ps(distanceSquared, _mm_mul_ps(radius, radius)));
+
+			// Inside: out through the nearest face, so towards the box is into that face.
+			__m128 nx = select(inside, _mm_xor_ps(fx, signBit), _mm_mul_ps(bx, inverse));
+			__m128 ny = select(inside, _mm_xor_ps(fy, signBit), _mm_mul_ps(by, inverse));
+			__m128 nz = select(inside, _mm_xor_ps(fz, signBit), _mm_mul_ps(bz, inverse));
+			__m128 depth = select(inside, _mm_add_ps(nearestGap, radius), _mm_sub_ps(radius, distance));
+
+			storeResults(out, i, hit, nx, ny, nz, depth);
+		}
+
+		return i;
+	}
+#endif
+};
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Matrix44.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+#if defined(__AVX__)
+#define BATCH_TRANSFORM_AVX
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(BATCH_TRANSFORM_AVX)
+#define BATCH_TRANSFORM_SSE
+#endif
+
+#if defined(BATCH_TRANSFORM_AVX)
+#include <immintrin.h>
+#elif defined(BATCH_TRANSFORM_SSE)
+#include <xmmintrin.h>
+#endif
+
+/// <summary>
+/// Positions, rotations and scales for many transforms, one array per component
+/// so a batch kernel can load several transforms into one register.
+/// </summary>
+struct TransformSoA
+{
+	void clear()
+	{
+		resize(0);
+	}
+
+	void resize(size_t count)
+	{
+		PositionX.resize(count);
+		PositionY.resize(count);
+		PositionZ.resize(count);
+		RotationX.resize(count);
+		RotationY.resize(count);
+		RotationZ.resize(count);
+		RotationW.resize(count);
+		ScaleX.resize(count);
+		ScaleY.resize(count);
+		ScaleZ.resize(count);
+	}
+
+	size_t size() const
+	{
+		return PositionX.size();
+	}
+
+	void set(size_t index, const Vector3f& position, const Quaternionf& rotation, const Vector3f& scale)
+	{
+		PositionX[index] = position.x;
+		PositionY[index] = position.y;
+		PositionZ[index] = position.z;
+		RotationX[index] = rotation.x;
+		RotationY[index] = rotation.y;
+		RotationZ[index] = rotation.z;
+		RotationW[index] = rotation.w;
+		ScaleX[index] = scale.x;
+		ScaleY[index] = scale.y;
+		ScaleZ[index] = scale.z;
+	}
+
+	void push(const Vector3f& position, const Quaternionf& rotation, const Vector3f& scale)
+	{
+		size_t index = size();
+		resize(index + 1);
+		set(index, position, rotation, scale);
+	}
+
+	std::vector<float> PositionX, PositionY, PositionZ;
+	std::vector<float> RotationX, RotationY, RotationZ, RotationW;
+	std::vector<float> ScaleX, ScaleY, ScaleZ;
+};
+
+/// <summary>
+/// Builds translation * rotation * scale model matrices for many transforms at once.
+/// Produces the same matrices as composing Matrix44f::translate, Quaternion::toMatrix and
+/// Matrix44f::scale, but writes each element directly instead of multiplying three matrices.
+/// Uses AVX or SSE when the compiler targets them, otherwise a scalar loop.
+/// </summary>
+class BatchTransform
+{
+public:
+	/// <summary>
+	/// Writes transforms.size() matrices to out.
+	/// </summary>
+	/// <param name="transforms"></param>
+	/// <param name="out"></param>
+	static void computeModelMatrices(const TransformSoA& transforms, Matrix44f* out)
+	{
+		size_t count = transforms.size();
+		size_t done = 0;
+
+#if defined(BATCH_TRANSFORM_AVX)
+		done = computeAVX(transforms, out, count);
+#elif defined(BATCH_TRANSFORM_SSE)
+		done = computeSSE(transforms, out, 0, count);
+#endif
+
+		computeScalar(transforms, out, done, count);
+	}
+
+	/// <summary>
+	/// Scalar version of computeModelMatrices. Used for the tail of a batch and as a reference.
+	/// </summary>
+	static void computeModelMatricesScalar(const TransformSoA& transforms, Matrix44f* out)
+	{
+		computeScalar(transforms, out, 0, transforms.size());
+	}
+
+	/// <summary>
+	/// Name of the instruction set computeModelMatrices was compiled for.
+	/// </summary>
+	static const char* getInstructionSet()
+	{
+#if defined(BATCH_TRANSFORM_AVX)
+		return "AVX";
+#elif defined(BATCH_TRANSFORM_SSE)
+		return "SSE";
+#else
+		return "Scalar";
+#endif
+	}
+
+private:
+	static void computeScalar(const TransformSoA& t, Matrix44f* out, size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; ++i)
+		{
+			float x = t.RotationX[i], y = t.RotationY[i], z = t.RotationZ[i], w = t.RotationW[i];
+			float sx = t.ScaleX[i], sy = t.ScaleY[i], sz = t.ScaleZ[i];
+
+			float xx = x * x, yy = y * y, zz = z * z;
+			float xy = x * y, xz = x * z, yz = y * z;
+			float xw = x * w, yw = y * w, zw = z * w;
+
+			float (*m)[4] = out[i].data;
+
+			m[0][0] = (1 - 2 * (yy + zz)) * sx;
+			m[0][1] = 2 * (xy - zw) * sx;
+			m[0][2] = 2 * (xz + yw) * sx;
+			m[0][3] = 0;
+
+			m[1][0] = 2 * (xy + zw) * sy;
+			m[1][1] = (1 - 2 * (xx + zz)) * sy;
+			m[1][2] = 2 * (yz - xw) * sy;
+			m[1][3] = 0;
+
+			m[2][0] = 2 * (xz - yw) * sz;
+			m[2][1] = 2 * (yz + xw) * sz;
+			m[2][2] = (1 - 2 * (xx + yy)) * sz;
+			m[2][3] = 0;
+
+			m[3][0] = t.PositionX[i];
+			m[3][1] = t.PositionY[i];
+			m[3][2] = t.PositionZ[i];
+			m[3][3] = 1;
+		}
+	}
+
+#if defined(BATCH_TRANSFORM_SSE)
+	/// <summary>
+	/// Transposes four rows of one matrix element across four transforms into the matrices themselves.
+	/// </summary>
+	static inline void storeRows(__m128 c0, __m128 c1, __m128 c2, __m128 c3, Matrix44f* out, int row)
+	{
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+		_mm_storeu_ps(out[0].data[row], c0);
+		_mm_storeu_ps(out[1].data[row], c1);
+		_mm_storeu_ps(out[2].data[row], c2);
+		_mm_storeu_ps(out[3].data[row], c3);
+	}
+
+	/// <summary>
+	/// Computes four transforms per iteration, one transform per lane, starting at begin.
+	/// </summary>
+	/// <returns>Index of the first transform not written.</returns>
+	static size_t computeSSE(const TransformSoA& t, Matrix44f* out, size_t begin, size_t count)
+	{
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 two = _mm_set1_ps(2.0f);
+		const __m128 zero = _mm_setzero_ps();
+
+		size_t i = begin;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 x = _mm_loadu_ps(&t.RotationX[i]);
+			__m128 y = _mm_loadu_ps(&t.RotationY[i]);
+			__m128 z = _mm_loadu_ps(&t.RotationZ[i]);
+			__m128 w = _mm_loadu_ps(&t.RotationW[i]);
+			__m128 sx = _mm_loadu_ps(&t.ScaleX[i]);
+			__m128 sy = _mm_loadu_ps(&t.ScaleY[i]);
+			__m128 sz = _mm_loadu_ps(&t.ScaleZ[i]);
+
+			__m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+			__m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+			__m128 xw = _mm_mul_ps(x, w), yw = _mm_mul_ps(y, w), zw = _mm_mul_ps(z, w);
+
+			__m128 m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+			__m128 m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, zw)), sx);
+			__m128 m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, yw)), sx);
+
+			__m128 m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, zw)), sy);
+			__m128 m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+			__m128 m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, xw)), sy);
+
+			__m128 m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, yw)), sz);
+			__m128 m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, xw)), sz);
+			__m128 m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+
+			__m128 px = _mm_loadu_ps(&t.PositionX[i]);
+			__m128 py = _mm_loadu_ps(&t.PositionY[i]);
+			__m128 pz = _mm_loadu_ps(&t.PositionZ[i]);
+
+			storeRows(m00, m01, m02, zero, out + i, 0);
+			storeRows(m10, m11, m12, zero, out + i, 1);
+			storeRows(m20, m21, m22, zero, out + i, 2);
+			storeRows(px, py, pz, one, out + i, 3);
+		}
+
+		return i;
+	}
+#endif
+
+#if defined(BATCH_TRANSFORM_AVX)
+	/// <summary>
+	/// Computes eight transforms per iteration, then hands each half to the SSE transpose.
+	/// </summary>
+	/// <returns>Index of the first transform not written.</returns>
+	static size_t computeAVX(const TransformSoA& t, Matrix44f* out, size_t count)
+	{
+		const __m256 one = _mm256_set1_ps(1.0f);
+		const __m256 two = _mm256_set1_ps(2.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 oneLane = _mm_set1_ps(1.0f);
+
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256 x = _mm256_loadu_ps(&t.RotationX[i]);
+			__m256 y = _mm256_loadu_ps(&t.RotationY[i]);
+			__m256 z = _mm256_loadu_ps(&t.RotationZ[i]);
+			__m256 w = _mm256_loadu_ps(&t.RotationW[i]);
+			__m256 sx = _mm256_loadu_ps(&t.ScaleX[i]);
+			__m256 sy = _mm256_loadu_ps(&t.ScaleY[i]);
+			__m256 sz = _mm256_loadu_ps(&t.ScaleZ[i]);
+
+			__m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+			__m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+			__m256 xw = _mm256_mul_ps(x, w), yw = _mm256_mul_ps(y, w), zw = _mm256_mul_ps(z, w);
+
+			__m256 m[12];
+			m[0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))), sx);
+			m[1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, zw)), sx);
+			m[2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, yw)), sx);
+
+			m[3] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, zw)), sy);
+			m[4] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))), sy);
+			m[5] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, xw)), sy);
+
+			m[6] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, yw)), sz);
+			m[7] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, xw)), sz);
+			m[8] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))), sz);
+
+			m[9] = _mm256_loadu_ps(&t.PositionX[i]);
+			m[10] = _mm256_loadu_ps(&t.PositionY[i]);
+			m[11] = _mm256_loadu_ps(&t.PositionZ[i]);
+
+			for (int half = 0; half < 2; ++half)
+			{
+				__m128 r[12];
+				for (int k = 0; k < 12; ++k)
+				{
+					r[k] = (half == 0) ? _mm256_castps256_ps128(m[k]) : _mm256_extractf128_ps(m[k], 1);
+				}
+
+				Matrix44f* block = out + i + half * 4;
+				storeRows(r[0], r[1], r[2], zero, block, 0);
+				storeRows(r[3], r[4], r[5], zero, block, 1);
+				storeRows(r[6], r[7], r[8], zero, block, 2);
+				storeRows(r[9], r[10], r[11], oneLane, block, 3);
+			}
+		}
+
+		// Fewer than eight left, finish what fits in SSE and leave the rest for the scalar tail.
+		return computeSSE(t, out, i, count);
+	}
+#endif
+};
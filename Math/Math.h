@@ -10,6 +10,9 @@
 #include "Vector4.h"
 #include "Line.h"
 #include "Plane.h"
+#include "AABB.h"
+#include "Sphere.h"
+#include "OBB.h"
 
 class GenMath
 {
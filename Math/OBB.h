@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+
+#include "Vector3.h"
+#include "Matrix44.h"
+#include "AABB.h"
+
+/// <summary>
+/// Oriented bounding box: a center, three unit axes and the half size along each axis.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+template<typename T>
+class OBB
+{
+public:
+	OBB()
+		:Center(0, 0, 0),
+		HalfExtents(0, 0, 0)
+	{
+		Axes[0] = Vector3<T>(1, 0, 0);
+		Axes[1] = Vector3<T>(0, 1, 0);
+		Axes[2] = Vector3<T>(0, 0, 1);
+	}
+
+	/// <summary>
+	/// Places a box given in an entity's local space into the world.
+	/// The matrix may rotate, scale and translate but not shear.
+	/// </summary>
+	/// <param name="local"></param>
+	/// <param name="matrix"></param>
+	/// <returns></returns>
+	static OBB<T> fromTransform(const AABB<T>& local, const Matrix44<T>& matrix)
+	{
+		OBB<T> box;
+		Vector3<T> center = local.getCenter();
+		Vector3<T> half = local.getHalfExtents();
+		T halfAxis[3] = { half.x, half.y, half.z };
+		T scaled[3];
+
+		box.Center.x = matrix.data[0][0] * center.x + matrix.data[1][0] * center.y + matrix.data[2][0] * center.z + matrix.data[3][0];
+		box.Center.y = matrix.data[0][1] * center.x + matrix.data[1][1] * center.y + matrix.data[2][1] * center.z + matrix.data[3][1];
+		box.Center.z = matrix.data[0][2] * center.x + matrix.data[1][2] * center.y + matrix.data[2][2] * center.z + matrix.data[3][2];
+
+		// Each column is a local axis scaled by the entity's scale along it.
+		for (int i = 0; i < 3; ++i)
+		{
+			Vector3<T> column(matrix.data[i][0], matrix.data[i][1], matrix.data[i][2]);
+			T length = std::sqrt(column * column);
+
+			if (length > (T)0)
+			{
+				box.Axes[i] = column * ((T)1 / length);
+			}
+
+			scaled[i] = halfAxis[i] * length;
+		}
+
+		box.HalfExtents = Vector3<T>(scaled[0], scaled[1], scaled[2]);
+		return box;
+	}
+
+	/// <summary>
+	/// Half size along axis 0, 1 or 2.
+	/// </summary>
+	T getHalfExtent(int axis) const
+	{
+		return axis == 0 ? HalfExtents.x : (axis == 1 ? HalfExtents.y : HalfExtents.z);
+	}
+
+	AABB<T> getBounds() const
+	{
+		Vector3<T> half;
+		half.x = std::fabs(Axes[0].x) * HalfExtents.x + std::fabs(Axes[1].x) * HalfExtents.y + std::fabs(Axes[2].x) * HalfExtents.z;
+		half.y = std::fabs(Axes[0].y) * HalfExtents.x + std::fabs(Axes[1].y) * HalfExtents.y + std::fabs(Axes[2].y) * HalfExtents.z;
+		half.z = std::fabs(Axes[0].z) * HalfExtents.x + std::fabs(Axes[1].z) * HalfExtents.y + std::fabs(Axes[2].z) * HalfExtents.z;
+		return AABB<T>::fromCenter(Center, half);
+	}
+
+	/// <summary>
+	/// Expresses a world point in the box's axes, relative to its center.
+	/// </summary>
+	Vector3<T> toLocal(const Vector3<T>& point) const
+	{
+		Vector3<T> offset = point - Center;
+		return Vector3<T>(offset * Axes[0], offset * Axes[1], offset * Axes[2]);
+	}
+
+	Vector3<T> closestPoint(const Vector3<T>& point) const
+	{
+		Vector3<T> local = toLocal(point);
+		T clamped[3] = { local.x, local.y, local.z };
+		Vector3<T> result = Center;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			T half = getHalfExtent(i);
+			clamped[i] = std::fmax(-half, std::fmin(clamped[i], half));
+			result += Axes[i] * clamped[i];
+		}
+
+		return result;
+	}
+
+	/// <summary>
+	/// Overlap test against a sphere.
+	/// </summary>
+	/// <param name="center"></param>
+	/// <param name="radius"></param>
+	/// <param name="normal">Unit direction from the box towards the sphere.</param>
+	/// <param name="depth">How far the sphere sinks into the box along the normal.</param>
+	/// <returns></returns>
+	bool intersectsSphere(const Vector3<T>& center, T radius, Vector3<T>& normal, T& depth) const
+	{
+		// Decide inside or outside in the box's axes: a world space distance to the closest
+		// point is not exactly zero for a center inside a rotated box.
+		Vector3<T> local = toLocal(center);
+		T localAxis[3] = { local.x, local.y, local.z };
+		T outside[3];
+		bool inside = true;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			T half = getHalfExtent(i);
+			outside[i] = localAxis[i] - std::fmax(-half, std::fmin(localAxis[i], half));
+			inside = inside && std::fabs(localAxis[i]) <= half;
+		}
+
+		if (!inside)
+		{
+			T distanceSquared = outside[0] * outside[0] + outside[1] * outside[1] + outside[2] * outside[2];
+
+			if (distanceSquared > radius * radius)
+			{
+				return false;
+			}
+
+			T distance = std::sqrt(distanceSquared);
+			normal = (Axes[0] * outside[0] + Axes[1] * outside[1] + Axes[2] * outside[2]) * ((T)1 / distance);
+			depth = radius - distance;
+			return true;
+		}
+
+		// The center is inside the box: push out through the face it is least deep behind.
+		int nearest = 0;
+		T nearestGap = std::numeric_limits<T>::max();
+
+		for (int i = 0; i < 3; ++i)
+		{
+			T gap = getHalfExtent(i) - std::fabs(localAxis[i]);
+
+			if (gap < nearestGap)
+			{
+				nearestGap = gap;
+				nearest = i;
+			}
+		}
+
+		normal = (localAxis[nearest] < (T)0) ? Axes[nearest] * (T)-1 : Axes[nearest];
+		depth = nearestGap + radius;
+		return true;
+	}
+
+	/// <summary>
+	/// Separating axis test against another box, checking the 15 axes that can separate two boxes.
+	/// </summary>
+	/// <param name="other"></param>
+	/// <param name="normal">Unit direction from this box towards the other along the axis of least overlap.</param>
+	/// <param name="depth">Overlap along the normal.</param>
+	/// <returns></returns>
+	bool intersects(const OBB<T>& other, Vector3<T>& normal, T& depth) const
+	{
+		Vector3<T> offset = other.Center - Center;
+		depth = std::numeric_limits<T>::max();
+
+		auto testAxis = [&](const Vector3<T>& axis) -> bool
+		{
+			T lengthSquared = axis * axis;
+
+			// Cross products of near parallel edges carry no information.
+			if (lengthSquared < (T)1e-8)
+			{
+				return true;
+			}
+
+			Vector3<T> unit = axis * ((T)1 / std::sqrt(lengthSquared));
+			T radiusA = HalfExtents.x * std::fabs(Axes[0] * unit) + HalfExtents.y * std::fabs(Axes[1] * unit) + HalfExtents.z * std::fabs(Axes[2] * unit);
+			T radiusB = other.HalfExtents.x * std::fabs(other.Axes[0] * unit) + other.HalfExtents.y * std::fabs(other.Axes[1] * unit) + other.HalfExtents.z * std::fabs(other.Axes[2] * unit);
+			T distance = offset * unit;
+			T overlap = radiusA + radiusB - std::fabs(distance);
+
+			if (overlap < (T)0)
+			{
+				return false;
+			}
+
+			if (overlap < depth)
+			{
+				depth = overlap;
+				normal = (distance < (T)0) ? unit * (T)-1 : unit;
+			}
+
+			return true;
+		};
+
+		for (int i = 0; i < 3; ++i)
+		{
+			if (!testAxis(Axes[i]) || !testAxis(other.Axes[i]))
+			{
+				return false;
+			}
+		}
+
+		for (int i = 0; i < 3; ++i)
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				if (!testAxis(Axes[i] % other.Axes[j]))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Moves a sphere along displacement and finds when it first touches the box.
+	/// Tests against the box grown by the radius, so near the box's edges and corners it can report
+	/// a hit up to a fraction of the radius early. Fine for bullets, which are small next to what they hit.
+	/// </summary>
+	/// <param name="start">Sphere center at the start of the step.</param>
+	/// <param name="displacement">Movement over the whole step.</param>
+	/// <param name="radius"></param>
+	/// <param name="time">Fraction of the step at first contact, 0 if already touching.</param>
+	/// <param name="normal">Unit normal of the face that was hit, pointing out of the box.</param>
+	/// <returns>False if they do not touch during the step.</returns>
+	bool sweepSphere(const Vector3<T>& start, const Vector3<T>& displacement, T radius, T& time, Vector3<T>& normal) const
+	{
+		Vector3<T> local = toLocal(start);
+		T position[3] = { local.x, local.y, local.z };
+		T movement[3] = { displacement * Axes[0], displacement * Axes[1], displacement * Axes[2] };
+
+		T entry = std::numeric_limits<T>::lowest();
+		T exit = std::numeric_limits<T>::max();
+		int entryAxis = -1;
+
+		for (int i = 0; i < 3; ++i)
+		{
+			T half = getHalfExtent(i) + radius;
+
+			if (movement[i] == (T)0)
+			{
+				if (std::fabs(position[i]) > half)
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			T inverse = (T)1 / movement[i];
+			T slabEntry = (-half - position[i]) * inverse;
+			T slabExit = (half - position[i]) * inverse;
+
+			if (slabEntry > slabExit)
+			{
+				T swap = slabEntry;
+				slabEntry = slabExit;
+				slabExit = swap;
+			}
+
+			if (slabEntry > entry)
+			{
+				entry = slabEntry;
+				entryAxis = i;
+			}
+
+			exit = std::fmin(exit, slabExit);
+		}
+
+		if (entry > exit || entry > (T)1 || exit < (T)0)
+		{
+			return false;
+		}
+
+		// Starts inside the grown box: report contact at the start of the step.
+		if (entry <= (T)0 || entryAxis < 0)
+		{
+			T depth;
+			time = 0;
+
+			// Only inside the grown box's rounded off corner, so the center is outside the box itself.
+			if (!intersectsSphere(start, radius, normal, depth))
+			{
+				normal = (start - closestPoint(start)).retNormalized();
+			}
+
+			return true;
+		}
+
+		time = entry;
+		normal = (movement[entryAxis] > (T)0) ? Axes[entryAxis] * (T)-1 : Axes[entryAxis];
+		return true;
+	}
+
+	Vector3<T> Center;
+	Vector3<T> Axes[3];
+	Vector3<T> HalfExtents;
+};
+
+typedef OBB<float> OBBf;
+typedef OBB<double> OBBd;
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+
+#include "Vector3.h"
+#include "AABB.h"
+
+/// <summary>
+/// Sphere given by its center and radius.
+/// </summary>
+/// <typeparam name="T"></typeparam>
+template<typename T>
+class Sphere
+{
+public:
+	Sphere(const Vector3<T>& center = Vector3<T>(0, 0, 0), T radius = 0)
+		:Center(center),
+		Radius(radius)
+	{}
+
+	AABB<T> getBounds() const
+	{
+		return AABB<T>::fromCenter(Center, Vector3<T>(Radius, Radius, Radius));
+	}
+
+	bool contains(const Vector3<T>& point) const
+	{
+		Vector3<T> offset = point - Center;
+		return offset * offset <= Radius * Radius;
+	}
+
+	bool intersects(const Sphere<T>& other) const
+	{
+		Vector3<T> offset = other.Center - Center;
+		T radii = Radius + other.Radius;
+		return offset * offset <= radii * radii;
+	}
+
+	bool intersects(const AABB<T>& box) const
+	{
+		return box.intersectsSphere(Center, Radius);
+	}
+
+	/// <summary>
+	/// Overlap test that also finds how to push the spheres apart.
+	/// </summary>
+	/// <param name="other"></param>
+	/// <param name="normal">Unit direction from this sphere towards the other.</param>
+	/// <param name="depth">How far the spheres overlap along the normal.</param>
+	/// <returns></returns>
+	bool intersects(const Sphere<T>& other, Vector3<T>& normal, T& depth) const
+	{
+		Vector3<T> offset = other.Center - Center;
+		T distanceSquared = offset * offset;
+		T radii = Radius + other.Radius;
+
+		if (distanceSquared > radii * radii)
+		{
+			return false;
+		}
+
+		T distance = std::sqrt(distanceSquared);
+
+		// Concentric spheres have no preferred direction, pick one.
+		normal = (distance > (T)0) ? offset * ((T)1 / distance) : Vector3<T>(0, 1, 0);
+		depth = radii - distance;
+		return true;
+	}
+
+	/// <summary>
+	/// Moves this sphere along displacement and finds when it first touches a still sphere.
+	/// </summary>
+	/// <param name="displacement">Movement over the whole step.</param>
+	/// <param name="other"></param>
+	/// <param name="time">Fraction of the step at first contact, 0 if the spheres already touch.</param>
+	/// <returns>False if they do not touch during the step.</returns>
+	bool sweep(const Vector3<T>& displacement, const Sphere<T>& other, T& time) const
+	{
+		Vector3<T> offset = Center - other.Center;
+		T radii = Radius + other.Radius;
+
+		// Solve |offset + displacement * t| = radii for the smallest t in [0, 1].
+		T c = offset * offset - radii * radii;
+
+		if (c <= (T)0)
+		{
+			time = 0;
+			return true;
+		}
+
+		T a = displacement * displacement;
+		T b = offset * displacement;
+
+		// Not moving, or moving apart.
+		if (a <= (T)0 || b >= (T)0)
+		{
+			return false;
+		}
+
+		T discriminant = b * b - a * c;
+
+		if (discriminant < (T)0)
+		{
+			return false;
+		}
+
+		time = (-b - std::sqrt(discriminant)) / a;
+		return time <= (T)1;
+	}
+
+	Vector3<T> Center;
+	T Radius;
+};
+
+typedef Sphere<float> Spheref;
+typedef Sphere<double> Sphered;
@@ -2,6 +2,7 @@
 
 #include "../Math/Math.h"
 #include "Engine/Entity.h"
+#include "Engine/RenderPacket.h"
 
 /**
  * Class representing a camera
@@ -27,8 +28,41 @@ class Camera : public Entity
         /**
          * Overridable function to calculate the view matrix
          * using internal representations of rotations, and positions
+         * By default the camera is placed at its interpolated transform
+         * @param alpha how far between the previous and current update tick to place the camera
          * */
-        virtual void calculateViewMatrix() {
+        virtual void calculateViewMatrix(float alpha = 1.0f) {
+            viewMatrix = calculateViewMatrix(mTransform.getInterpolatedPosition(alpha),
+                mTransform.getInterpolatedRotation(alpha));
+        }
+
+        /// <summary>
+        /// Calculates a view matrix for a camera at the given position and rotation.
+        /// Lets the render thread build the view from a render packet without touching the entity.
+        /// </summary>
+        /// <param name="position"></param>
+        /// <param name="rotation"></param>
+        /// <returns></returns>
+        static Matrix44f calculateViewMatrix(const Vector3f& position, const Quaternionf& rotation) {
+            Matrix44f translation;
+            translation.translate(position);
+            Matrix44f view = translation * rotation.toMatrix();
+
+            view.invert();
+            return view;
+        }
+
+        /// <summary>
+        /// Hands the camera transform to the render thread.
+        /// The first camera in the scene becomes the view.
+        /// </summary>
+        /// <param name="packet"></param>
+        virtual void extractRenderData(RenderPacket& packet) {
+            if(!packet.View.Active) {
+                packet.View.Previous = mTransform.getPreviousState();
+                packet.View.Current = mTransform.getState();
+                packet.View.Active = true;
+            }
         }
 
         /// <summary>
@@ -65,18 +99,6 @@ class Camera3D : public Camera {
 
         }
 
-        /// <summary>
-        /// Calculates the view matrix from a rotation and position.
-        /// </summary>
-        void calculateViewMatrix() {
-            Matrix44f translation;
-            translation.translate(mTransform->Position);
-            Matrix44f rotation = mTransform->Rotation.toMatrix();
-
-            viewMatrix = translation * rotation;
-            viewMatrix.invert();
-        }
-
         /// <summary>
         /// Calculates projection matrix based on all necessary variables and sets camera internals.
         /// </summary>
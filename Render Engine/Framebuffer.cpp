@@ -1,5 +1,7 @@
 #include "Framebuffer.h"
 
+#include "../lib/glew/include/GL/glew.h"
+
 Framebuffer::Framebuffer(int width, int height)
 	:mWidth(width),
 	mHeight(height)
@@ -15,6 +17,33 @@ Framebuffer::~Framebuffer()
 	}
 }
 
+void Framebuffer::clearDepthAndColor()
+{
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void Framebuffer::clearColor()
+{
+	glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void Framebuffer::clearDepth()
+{
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void Framebuffer::bind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
+	glViewport(0, 0, mWidth, mHeight);
+}
+
+void Framebuffer::unBind(int width, int height)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, width, height);
+}
+
 bool Framebuffer::createFbo()
 {
 	glGenFramebuffers(1, (GLuint*) &mFbo);
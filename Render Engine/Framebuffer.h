@@ -51,35 +51,22 @@ public:
 	/// <summary>
 	/// Clears the currently bound framebuffer
 	/// </summary>
-	static void clearDepthAndColor()
-	{
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	}
+	static void clearDepthAndColor();
 
 	/// <summary>
 	/// Sets the clear color.
 	/// </summary>
-	static void clearColor()
-	{
-		glClear(GL_COLOR_BUFFER_BIT);
-	}
+	static void clearColor();
 
 	/// <summary>
 	/// Clears the depth only.
 	/// </summary>
-	static void clearDepth()
-	{
-		glClear(GL_DEPTH_BUFFER_BIT);
-	}
+	static void clearDepth();
 
 	/// <summary>
 	/// Binds the frame buffer for render
 	/// </summary>
-	void bind()
-	{
-		glBindFramebuffer(GL_FRAMEBUFFER, mFbo);
-		glViewport(0, 0, mWidth, mHeight);
-	}
+	void bind();
 
 	/// <summary>
 	/// Unbinds the current frame buffer
@@ -87,11 +74,7 @@ public:
 	/// </summary>
 	/// <param name="w"></param>
 	/// <param name="h"></param>
-	static void unBind(int width, int height)
-	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glViewport(0, 0, width, height);
-	}
+	static void unBind(int width, int height);
 
 protected:
 private:
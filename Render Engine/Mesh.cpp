@@ -1,6 +1,7 @@
 #include "Mesh.h"
 
 #include "../lib/glew/include/GL/glew.h"
+#include "../Serializers/OBJ Serializer/ModelLoader.h"
 
 void Mesh::addFloatData(const float* data, int count, int dimensions) 
 {
@@ -146,6 +147,14 @@ void IndexedMesh::updateIndices(const int* indices, int count)
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(int), indices, getBufferMode());
 }
 
+void IndexedMesh::loadFromModel(const IndexedModel& model)
+{
+    addFloatData(model.positions, model.positionsCount, 3);
+    addFloatData(model.uvs, model.uvsCount, 2);
+    addFloatData(model.normals, model.normalsCount, 3);
+    setIndices(model.indices, model.indexCount);
+}
+
 void IndexedMesh::render()
 {
     glBindVertexArray(vao);
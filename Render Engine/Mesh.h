@@ -2,6 +2,8 @@
 
 #include <vector>
 
+class IndexedModel;
+
 /**
  * Dyanmic if the mesh will be changing its veritices a lot
  * Static if the mesh will not be frequently written to
@@ -107,6 +109,12 @@ public:
 	/// <param name="count"></param>
 	void updateIndices(const int* indices, int count);
 
+	/// <summary>
+	/// Uploads a model parsed by ModelLoader: positions, texture coordinates and normals as attributes 0, 1 and 2.
+	/// </summary>
+	/// <param name="model"></param>
+	void loadFromModel(const IndexedModel& model);
+
 
 protected:
 	int indicesBuffer;
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <typeinfo>
+
+#include "../Utils/Profiler.h"
+
 class Scene;
 
 /// <summary>
@@ -19,8 +23,17 @@ public:
 	/// </summary>
 	void render(Scene& scene)
 	{
-		prepare(scene);
-		execute(scene);
+		PROFILE_SCOPE(typeid(*this).name());
+
+		{
+			PROFILE_SCOPE("RenderPipelineStage::prepare");
+			prepare(scene);
+		}
+
+		{
+			PROFILE_SCOPE("RenderPipelineStage::execute");
+			execute(scene);
+		}
 	}
 
 	/// <summary>
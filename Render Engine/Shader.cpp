@@ -1,7 +1,12 @@
 #include "Shader.h"
 #include "../Logger/StaticLogger.h"
+#include "../Utils/AssetPack.h"
+#include "../Utils/Profiler.h"
 
-#include <fstream>
+#include "../lib/glew/include/GL/glew.h"
+
+static_assert((GLenum)ShaderType::VERTEX_SHADER == GL_VERTEX_SHADER, "ShaderType must match the GL enums");
+static_assert((GLenum)ShaderType::FRAGMENT_SHADER == GL_FRAGMENT_SHADER, "ShaderType must match the GL enums");
 
 Shader::Shader() {
 
@@ -12,22 +17,13 @@ Shader::~Shader() {
 }
 
 static bool loadShaderi(const std::string& fileName, std::string& shaderString) {
-	std::ifstream file;
-	file.open(fileName);
-
-	std::string output;
-	std::string line;
+	AssetData file;
 
-	if (file.is_open()) {
-		while (file.good()) {
-			getline(file, line);
-			shaderString.append(line + "\n");
-		}
-	}
-	else {
+	if (!AssetFiles::read(fileName, file)) {
 		return false;
 	}
 
+	shaderString.append(file.getData(), file.getSize());
 	return true;
 }
 
@@ -93,36 +89,45 @@ bool Shader::loadShader(const std::string& shaderPath, ShaderType type, std::str
 {
     std::string text;
 
-    if (loadShaderi(shaderPath, text)) {
-        shader = glCreateShader((GLuint)type);
-
-        if (shader == 0) {
-            errorMessage = "Failed to create shader with type: " + std::to_string((int)type);
-            return false;
-        }
+    if (!readSource(shaderPath, text)) {
+        errorMessage = "Could not open file: " + shaderPath;
+        return false;
+    }
 
-        const GLchar* p[1];
-        p[0] = text.c_str();
-        GLint lengths[1];
-        lengths[0] = (GLint)text.length();
+    return compileShader(text, type, shaderPath, errorMessage);
+}
 
-        glShaderSource(shader, 1, p, lengths);
-        glCompileShader(shader);
+bool Shader::compileShader(const std::string& source, ShaderType type, const std::string& sourceName, std::string& errorMessage)
+{
+    shader = glCreateShader((GLuint)type);
 
-        std::string error;
-        if (!checkShaderError(shader, GL_COMPILE_STATUS, false, error)) {
-            errorMessage = "Error compiling shader: " + shaderPath + error;
-            return false;
-        }
+    if (shader == 0) {
+        errorMessage = "Failed to create shader with type: " + std::to_string((int)type);
+        return false;
     }
-    else {
-        errorMessage = "Could not open file: " + shaderPath;
+
+    const GLchar* p[1];
+    p[0] = source.c_str();
+    GLint lengths[1];
+    lengths[0] = (GLint)source.length();
+
+    glShaderSource(shader, 1, p, lengths);
+    glCompileShader(shader);
+
+    std::string error;
+    if (!checkShaderError(shader, GL_COMPILE_STATUS, false, error)) {
+        errorMessage = "Error compiling shader: " + sourceName + error;
         return false;
     }
 
     return true;
 }
 
+bool Shader::readSource(const std::string& shaderPath, std::string& source)
+{
+    return loadShaderi(shaderPath, source);
+}
+
 static bool linkShaderProgram(GLuint shaderProgram, std::string& error) {
     glLinkProgram(shaderProgram);
 
@@ -150,48 +155,79 @@ ShaderProgram::ShaderProgram(const std::vector<std::string>& attributes)
 }
 
 void ShaderProgram::loadShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath) {
+    PROFILE_SCOPE("ShaderProgram::loadShaders");
+
+    std::string vertexSource;
+    std::string fragmentSource;
+    bool loadError = false;
+
+    //read each shader from a file
+    if(!Shader::readSource(vertexShaderPath, vertexSource)) {
+        StaticLogger::instance.error("Could not open file: {string}", vertexShaderPath.c_str());
+        loadError = true;
+    }
+
+    if(!Shader::readSource(fragmentShaderPath, fragmentSource)) {
+        StaticLogger::instance.error("Could not open file: {string}", fragmentShaderPath.c_str());
+        loadError = true;
+    }
+
+    if(!loadError) {
+        loadShaderSources(vertexSource, fragmentSource, vertexShaderPath, fragmentShaderPath);
+    }
+}
+
+bool ShaderProgram::loadShaderSources(const std::string& vertexSource, const std::string& fragmentSource,
+    const std::string& vertexName, const std::string& fragmentName) 
+{
+    PROFILE_SCOPE("ShaderProgram::loadShaderSources");
+
     bool loadError = false;
     std::string currentError;
 
     //create the shader program
     this->shaderProgram = glCreateProgram();
 
-    //load each shader from a file
-    if(!vertexShader.loadShader(vertexShaderPath, ShaderType::VERTEX_SHADER, currentError)) {
+    //compile each shader
+    if(!vertexShader.compileShader(vertexSource, ShaderType::VERTEX_SHADER, vertexName, currentError)) {
         StaticLogger::instance.error("{string}", currentError.c_str());
         loadError = true;
     }
 
-    //load fragment shader from file
     currentError = "";
-    if(!fragmentShader.loadShader(fragmentShaderPath, ShaderType::FRAGMENT_SHADER, currentError)) {
+    if(!fragmentShader.compileShader(fragmentSource, ShaderType::FRAGMENT_SHADER, fragmentName, currentError)) {
         StaticLogger::instance.error("{string}", currentError.c_str());
         loadError = true;
     }
 
+    if(loadError) {
+        return false;
+    }
+
     //link the shaders in a shader program
-    if(!loadError) {
-        if(!attachShaders(shaderProgram, vertexShader.getShader(), fragmentShader.getShader())) {
-            StaticLogger::instance.error("Invalid shader program {int}", shaderProgram);
-        }
+    if(!attachShaders(shaderProgram, vertexShader.getShader(), fragmentShader.getShader())) {
+        StaticLogger::instance.error("Invalid shader program {int}", shaderProgram);
+    }
 
-        //bind each attribute location to the correct name
-        for(std::map<std::string, int>::iterator i = attributes.begin(); i != attributes.end(); ++i) {
-            glBindAttribLocation(this->shaderProgram, (GLuint)i->second, i->first.c_str());
-        }
+    //bind each attribute location to the correct name
+    for(std::map<std::string, int>::iterator i = attributes.begin(); i != attributes.end(); ++i) {
+        glBindAttribLocation(this->shaderProgram, (GLuint)i->second, i->first.c_str());
+    }
 
-        //create the shader program
-        currentError = "";
-        if(!linkShaderProgram(this->shaderProgram, currentError)) {
-            StaticLogger::instance.error("Link shader failed\n: {string}", currentError.c_str());
-        }
-        else {
-            StaticLogger::instance.trace("Successfully loaded shader: vertex: '{string}', fragment: '{string}'", vertexShaderPath.c_str(), fragmentShaderPath.c_str());
-        }
+    //create the shader program
+    currentError = "";
+    bool linked = linkShaderProgram(this->shaderProgram, currentError);
 
-        //load uniforms
-        setUniformLocations();
+    if(!linked) {
+        StaticLogger::instance.error("Link shader failed\n: {string}", currentError.c_str());
     }
+    else {
+        StaticLogger::instance.trace("Successfully loaded shader: vertex: '{string}', fragment: '{string}'", vertexName.c_str(), fragmentName.c_str());
+    }
+
+    //load uniforms
+    setUniformLocations();
+    return linked;
 }
 
 int ShaderProgram::getAttributeLocation(const std::string& name) {
@@ -1,6 +1,5 @@
 #pragma once
 
-#include "../lib/glew/include/GL/glew.h"
 #include "../Math/Math.h"
 
 #include <string>
@@ -9,11 +8,12 @@
 
 /// <summary>
 /// The valid types of shaders.
+/// Values are the GL_VERTEX_SHADER and GL_FRAGMENT_SHADER enums, spelled out so this header does not need the GL headers.
 /// </summary>
 enum class ShaderType
 {
-	VERTEX_SHADER = GL_VERTEX_SHADER,
-	FRAGMENT_SHADER = GL_FRAGMENT_SHADER
+	VERTEX_SHADER = 0x8B31,
+	FRAGMENT_SHADER = 0x8B30
 };
 
 /// <summary>
@@ -36,16 +36,35 @@ public:
 	/// <returns></returns>
 	bool loadShader(const std::string& shaderPath, ShaderType type, std::string& errorMessage);
 
+	/// <summary>
+	/// Compiles a shader from source already in memory.
+	/// </summary>
+	/// <param name="source"></param>
+	/// <param name="type"></param>
+	/// <param name="sourceName">Names the shader in error messages.</param>
+	/// <param name="errorMessage"></param>
+	/// <returns></returns>
+	bool compileShader(const std::string& source, ShaderType type, const std::string& sourceName, std::string& errorMessage);
+
+	/// <summary>
+	/// Reads a shader's source from the file system.
+	/// Does not touch OpenGL, so it can run on any thread.
+	/// </summary>
+	/// <param name="shaderPath"></param>
+	/// <param name="source"></param>
+	/// <returns></returns>
+	static bool readSource(const std::string& shaderPath, std::string& source);
+
 	/// <summary>
 	/// Returns the shader program by index.
 	/// </summary>
 	/// <returns></returns>
-	GLuint getShader() {
+	unsigned int getShader() {
 		return shader;
 	}
 
 protected:
-	GLuint shader;
+	unsigned int shader;
 
 private:
 };
@@ -77,6 +96,17 @@ public:
 	/// <param name="fragmentShaderPath"></param>
 	void loadShaders(const std::string& vertexShaderPath, const std::string& fragmentShaderPath);
 
+	/// <summary>
+	/// Compiles and links the program from shader sources already in memory.
+	/// </summary>
+	/// <param name="vertexSource"></param>
+	/// <param name="fragmentSource"></param>
+	/// <param name="vertexName">Names the vertex shader in messages, usually its path.</param>
+	/// <param name="fragmentName">Names the fragment shader in messages, usually its path.</param>
+	/// <returns>False if either shader failed to compile or the program failed to link.</returns>
+	bool loadShaderSources(const std::string& vertexSource, const std::string& fragmentSource,
+		const std::string& vertexName, const std::string& fragmentName);
+
 protected:
 	/// <summary>
 	/// Uniform loading functions.
@@ -133,7 +163,7 @@ protected:
 
 	Shader vertexShader;
 	Shader fragmentShader;
-	GLuint shaderProgram;
+	unsigned int shaderProgram;
 	std::map<std::string, int> attributes;
 };
 
@@ -1 +1,52 @@
 #include "Texture.h"
+
+#include "../lib/glew/include/GL/glew.h"
+#include "../Utils/Profiler.h"
+
+Texture::~Texture() 
+{
+    // Textures handed over by id may not be textures at all (framebuffer depth attachments), leave those alone.
+    if(ownsTexture) {
+        glDeleteTextures(1, &diffuseID);
+    }
+}
+
+void Texture::loadFromFile(const std::string& path) {
+    PROFILE_SCOPE("Texture::loadFromFile");
+
+    Image img;
+    if(!ImageLoader::loadImage(path, img)) {
+    }
+    else {
+        loadFromImg(img);
+    }
+}
+
+void Texture::loadFromImg(Image& img) {
+    //load texture id
+    glCreateTextures(GL_TEXTURE_2D, 1, &diffuseID);
+    ownsTexture = true;
+
+    //bind texture before operating
+    glBindTexture(GL_TEXTURE_2D, diffuseID);
+
+    //set default parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    //load texture data
+    if(img.numComponents == 3) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, img.width, img.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.data);
+    }
+    else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.width, img.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.data);
+    }
+}
+
+void Texture::bind(unsigned int slot) {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, diffuseID);
+}
@@ -1,12 +1,12 @@
 #pragma once
 
-#include "../lib/glew/include/GL/glew.h"
 #include "../Serializers/STB_image/ImageLoader.h"
 
 //free textures: https://textures.pixel-furnace.com/
 
 /**
  * Base class for storing texture data
+ * The OpenGL calls live in Texture.cpp so code that only holds textures does not need the GL headers
  * @author Bryce Young 5/28/2021
  * */
 class Texture {
@@ -15,50 +15,25 @@ class Texture {
 
         }
 
-        ~Texture() 
-        {
-
-        }
+        ~Texture();
 
         /// <summary>
         /// Loads the texture from a file.
         /// </summary>
         /// <param name="path"></param>
-        void loadFromFile(const std::string& path) {
-            Image img;
-            if(!ImageLoader::loadImage(path, img)) {
-            }
-            else {
-                loadFromImg(img);
-            }
-        }
+        void loadFromFile(const std::string& path);
 
         /// <summary>
         /// Given raw image data, load the texture.
         /// </summary>
         /// <param name="img"></param>
-        void loadFromImg(Image& img) {
-            //load texture id
-            glCreateTextures(GL_TEXTURE_2D, 1, &diffuseID);
-
-            //bind texture before operating
-            glBindTexture(GL_TEXTURE_2D, diffuseID);
-
-            //set default parameters
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        void loadFromImg(Image& img);
 
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-            //load texture data
-            if(img.numComponents == 3) {
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, img.width, img.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.data);
-            }
-            else {
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, img.width, img.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, img.data);
-            }
-        }
+        /// <summary>
+        /// Binds the texture to a texture unit.
+        /// </summary>
+        /// <param name="slot"></param>
+        void bind(unsigned int slot);
 
         /**
          * @return the texture's id
@@ -86,6 +61,8 @@ class Texture {
 
     protected:
 
-        GLuint diffuseID = -1;
-};
+        unsigned int diffuseID = -1;
 
+        // Set for textures created from an image, which are deleted with the texture so eviction frees GPU memory.
+        bool ownsTexture = false;
+};
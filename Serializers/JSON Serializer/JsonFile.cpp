@@ -1,24 +1,25 @@
 #include "JsonFile.h"
 #include "JsonParser.h"
 
-//load the entire json file into memory at once
+#include <cstring>
+
+#include "../../Utils/AssetPack.h"
+
+//load the entire json file into memory at once, from a mounted asset pack if one has it
 static char* loadFile(const std::string& name, uint32_t& size) {
     char* ret;
-    std::ifstream inputFile(name, std::ios::in | std::ios::binary | std::ios::ate);
+    AssetData data;
 
-    if(!inputFile.is_open()) {
+    if(!AssetFiles::read(name, data)) {
         return nullptr;
     }
 
-    size = (uint32_t)inputFile.tellg();
-    inputFile.seekg(0, std::ios::beg);
-
+    //the parser writes into the text while it reads it, so it gets a copy of its own
+    size = (uint32_t)data.getSize();
     ret = new char[size + 1];
-    inputFile.read(ret, size);
+    memcpy(ret, data.getData(), size);
     ret[size] = 0;
 
-    inputFile.close();
-
     return ret;
 }
 
@@ -1,5 +1,6 @@
 #include "JsonLexer.h"
 #include <stdint.h>
+#include <cstring>
 #include <map>
 #include <iostream>
 
@@ -1,11 +1,17 @@
 #include "ModelLoader.h"
 
-#include <fstream>
+#include <cstring>
 #include <iostream>
 #include <unordered_map>
 
+#include "../../Utils/AssetCache.h"
+#include "../../Utils/AssetPack.h"
+
 #define IS_FLOAT_CHAR(i) ((i >= '0' && i <= '9') || (i == '.') || (i == '-'))
 
+// Version of the cooked model layout. Bump it whenever parsing changes so stale cooked models are not used.
+#define OBJ_COOK_VERSION 1
+
 struct Vertex {
     int pos, norm, uv;
 
@@ -153,20 +159,97 @@ static bool loadFace(std::string& line, std::vector<int>& indices, std::vector<f
     return true;
 }
 
-bool ModelLoader::loadOBJ(const std::string& filePath, IndexedModel& model) {
-    std::ifstream file(filePath);
-    std::string line = "";
+/**
+ * Counts at the start of a cooked model, followed by the indices, positions, normals and uvs
+ * */
+struct CookedModelHeader {
+    int32_t indexCount;
+    int32_t positionsCount;
+    int32_t normalsCount;
+    int32_t uvsCount;
+};
 
-    // If the file cannot be found, obviously it cannot load it.
-    if(!file.is_open()) {
+static void cookModel(const IndexedModel& model, std::vector<char>& cooked) {
+    CookedModelHeader header = { model.indexCount, model.positionsCount, model.normalsCount, model.uvsCount };
+
+    cooked.resize(sizeof(header) + sizeof(int) * (size_t)model.indexCount
+        + sizeof(float) * ((size_t)model.positionsCount + model.normalsCount + model.uvsCount));
+
+    char* write = cooked.data();
+    memcpy(write, &header, sizeof(header));
+    write += sizeof(header);
+    memcpy(write, model.indices, sizeof(int) * model.indexCount);
+    write += sizeof(int) * model.indexCount;
+    memcpy(write, model.positions, sizeof(float) * model.positionsCount);
+    write += sizeof(float) * model.positionsCount;
+    memcpy(write, model.normals, sizeof(float) * model.normalsCount);
+    write += sizeof(float) * model.normalsCount;
+    memcpy(write, model.uvs, sizeof(float) * model.uvsCount);
+}
+
+static bool loadCookedModel(const AssetData& cooked, IndexedModel& model) {
+    CookedModelHeader header;
+
+    if(cooked.getSize() < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, cooked.getData(), sizeof(header));
+
+    if(header.indexCount < 0 || header.positionsCount < 0 || header.normalsCount < 0 || header.uvsCount < 0) {
+        return false;
+    }
+
+    size_t size = sizeof(header) + sizeof(int) * (size_t)header.indexCount
+        + sizeof(float) * ((size_t)header.positionsCount + header.normalsCount + header.uvsCount);
+
+    if(cooked.getSize() != size) {
         return false;
     }
 
+    model.indexCount = header.indexCount;
+    model.positionsCount = header.positionsCount;
+    model.normalsCount = header.normalsCount;
+    model.uvsCount = header.uvsCount;
+
+    model.indices = new int[model.indexCount];
+    model.positions = new float[model.positionsCount];
+    model.normals = new float[model.normalsCount];
+    model.uvs = new float[model.uvsCount];
+
+    const char* read = cooked.getData() + sizeof(header);
+    memcpy(model.indices, read, sizeof(int) * model.indexCount);
+    read += sizeof(int) * model.indexCount;
+    memcpy(model.positions, read, sizeof(float) * model.positionsCount);
+    read += sizeof(float) * model.positionsCount;
+    memcpy(model.normals, read, sizeof(float) * model.normalsCount);
+    read += sizeof(float) * model.normalsCount;
+    memcpy(model.uvs, read, sizeof(float) * model.uvsCount);
+
+    return true;
+}
+
+static bool parseOBJ(const AssetData& file, IndexedModel& model) {
+    std::string line = "";
     std::vector<float> positions, normals, uvs;
     std::vector<int> indices;
     std::unordered_map<Vertex, int, VertexHash> vertices;
 
-    while(getline(file, line)) {
+    // Walk the lines in place rather than streaming them out of the file.
+    const char* text = file.getData();
+    size_t size = file.getSize();
+    size_t lineStart = 0;
+
+    while(lineStart < size) {
+        const char* lineEnd = static_cast<const char*>(memchr(text + lineStart, '\n', size - lineStart));
+        size_t lineLength = (lineEnd == nullptr ? size : (size_t)(lineEnd - text)) - lineStart;
+        line.assign(text + lineStart, lineLength);
+        lineStart += lineLength + 1;
+
+        if(!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
         if(line.size() > 2) {
             if(line[0] == 'v' && line[1] == ' ') {
                 if(!loadFloats(line, positions, 3)) return false;
@@ -213,6 +296,34 @@ bool ModelLoader::loadOBJ(const std::string& filePath, IndexedModel& model) {
         model.indices[i] = indices[i];
     }
 
-    file.close();
+    return true;
+}
+
+bool ModelLoader::loadOBJ(const std::string& filePath, IndexedModel& model) {
+    AssetData file;
+
+    // If the file cannot be found, obviously it cannot load it.
+    if(!AssetFiles::read(filePath, file)) {
+        return false;
+    }
+
+    // A model cooked from this exact file skips parsing altogether.
+    AssetCacheKey key = AssetCache::makeKey(filePath, file, "obj", OBJ_COOK_VERSION);
+    AssetData cooked;
+
+    if(AssetCache::load(key, cooked) && loadCookedModel(cooked, model)) {
+        return true;
+    }
+
+    if(!parseOBJ(file, model)) {
+        return false;
+    }
+
+    if(AssetCache::isEnabled()) {
+        std::vector<char> cookedModel;
+        cookModel(model, cookedModel);
+        AssetCache::store(key, cookedModel.data(), cookedModel.size());
+    }
+
     return true;
 }
\ No newline at end of file
@@ -1,13 +1,90 @@
 #include "ImageLoader.h"
 
+#include <cstring>
+#include <vector>
+
+#include "../../Utils/AssetCache.h"
+#include "../../Utils/AssetPack.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+// Version of the cooked image layout. Bump it whenever decoding changes, such as the flip or the channel count.
+#define IMAGE_COOK_VERSION 1
+
+/**
+ * Size of a decoded image at the start of a cooked image, followed by its four channel pixels
+ * */
+struct CookedImageHeader {
+    int32_t width;
+    int32_t height;
+    int32_t numComponents;
+};
+
+static void cookImage(const AssetCacheKey& key, const Image& img) {
+    CookedImageHeader header = { img.width, img.height, img.numComponents };
+    size_t pixels = (size_t)img.width * img.height * 4;
+
+    std::vector<char> cooked(sizeof(header) + pixels);
+    memcpy(cooked.data(), &header, sizeof(header));
+    memcpy(cooked.data() + sizeof(header), img.data, pixels);
+
+    AssetCache::store(key, cooked.data(), cooked.size());
+}
+
+static bool loadCookedImage(const AssetData& cooked, Image& img) {
+    CookedImageHeader header;
+
+    if(cooked.getSize() < sizeof(header)) {
+        return false;
+    }
+
+    memcpy(&header, cooked.getData(), sizeof(header));
+
+    if(header.width <= 0 || header.height <= 0 || cooked.getSize() != sizeof(header) + (size_t)header.width * header.height * 4) {
+        return false;
+    }
+
+    // Allocated the way stb_image allocates, so freeImageData frees decoded and cooked images alike.
+    size_t pixels = (size_t)header.width * header.height * 4;
+    unsigned char* data = (unsigned char*)STBI_MALLOC(pixels);
+
+    if(data == nullptr) {
+        return false;
+    }
+
+    memcpy(data, cooked.getData() + sizeof(header), pixels);
+
+    img.data = data;
+    img.width = header.width;
+    img.height = header.height;
+    img.numComponents = header.numComponents;
+
+    return true;
+}
+
 bool ImageLoader::loadImage(const std::string& fileName, Image& img) {
-    stbi_set_flip_vertically_on_load(true);  
+    // Per thread so images can be decoded on several threads at once.
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    // Decoded straight out of the asset pack when the image is packed.
+    AssetData file;
+
+    if(!AssetFiles::read(fileName, file)) {
+        return false;
+    }
+
+    // An image cooked from this exact file skips decoding altogether.
+    AssetCacheKey key = AssetCache::makeKey(fileName, file, "rgba", IMAGE_COOK_VERSION);
+    AssetData cooked;
+
+    if(AssetCache::load(key, cooked) && loadCookedImage(cooked, img)) {
+        return true;
+    }
 
     int width, height, numComponents;
-	unsigned char *data = stbi_load((fileName).c_str(), &width, &height, &numComponents, 4);
+	unsigned char *data = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(file.getData()), (int)file.getSize(),
+        &width, &height, &numComponents, 4);
 
     if(data) {
         img.data = data;
@@ -15,8 +92,17 @@ bool ImageLoader::loadImage(const std::string& fileName, Image& img) {
         img.height = height;
         img.numComponents = numComponents;
 
+        if(AssetCache::isEnabled()) {
+            cookImage(key, img);
+        }
+
         return true;
     } 
 
     return false;
+}
+
+void ImageLoader::freeImageData(unsigned char* data) {
+    // stb_image allocates with malloc, so the data must not be freed with delete.
+    stbi_image_free(data);
 }
\ No newline at end of file
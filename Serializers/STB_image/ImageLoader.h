@@ -19,6 +19,11 @@ class ImageLoader {
 
         static bool loadImage(const std::string& path, Image& img);
 
+        /**
+         * Frees pixel data returned by loadImage
+         * */
+        static void freeImageData(unsigned char* data);
+
     private:
 
 };
@@ -36,7 +41,7 @@ struct Image {
 
     ~Image() {
         if(data != nullptr) {
-            delete[] data;
+            ImageLoader::freeImageData(data);
         }
     }
 
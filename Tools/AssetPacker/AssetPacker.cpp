@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Utils/AssetPack.h"
+
+/**
+ * Builds an asset pack out of a resource folder, or lists the contents of one
+ *
+ * AssetPacker <res folder> <output pack> [--store]
+ *     Packs every file under the folder, named by its path relative to it. Files are compressed where
+ *     that pays off unless --store is given. Point the game at the result with "assetpack" in its settings
+ * AssetPacker --list <pack>
+ *     Prints every entry with its size on disk and in memory
+ * */
+
+// Extensions of formats that are already compressed, which are stored as they are.
+static const char* const STORED_EXTENSIONS[] = { ".png", ".jpg", ".jpeg", ".ogg", ".mp3", ".pak" };
+
+static bool isCompressedFormat(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+
+    for(const char* stored : STORED_EXTENSIONS) {
+        if(extension == stored) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int listPack(const std::string& packPath) {
+    AssetPack pack;
+
+    if(!pack.mount(packPath)) {
+        std::cerr << "Could not open asset pack: " << packPath << "\n";
+        return 1;
+    }
+
+    for(uint32_t i = 0; i < pack.getEntryCount(); ++i) {
+        const AssetPackEntry& entry = pack.getEntry(i);
+
+        std::cout << pack.getName(entry) << "  " << entry.size << " bytes";
+
+        if((entry.flags & ASSET_ENTRY_COMPRESSED) != 0) {
+            std::cout << ", " << entry.storedSize << " compressed";
+        }
+
+        std::cout << "\n";
+    }
+
+    std::cout << pack.getEntryCount() << " entries\n";
+    return 0;
+}
+
+static int buildPack(const std::string& rootPath, const std::string& packPath, bool compress) {
+    std::filesystem::path root(rootPath);
+    std::error_code error;
+
+    if(!std::filesystem::is_directory(root, error)) {
+        std::cerr << "Not a folder: " << rootPath << "\n";
+        return 1;
+    }
+
+    std::filesystem::path output = std::filesystem::absolute(packPath, error);
+    std::vector<std::filesystem::path> files;
+
+    for(const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(root, error)) {
+        // Never pack the pack being written if it is inside the folder.
+        if(entry.is_regular_file() && !std::filesystem::equivalent(entry.path(), output, error)) {
+            files.push_back(entry.path());
+        }
+    }
+
+    // Sorted so the same folder always produces the same pack.
+    std::sort(files.begin(), files.end());
+
+    AssetPackWriter writer;
+
+    for(const std::filesystem::path& file : files) {
+        std::string name = std::filesystem::relative(file, root).generic_string();
+        AssetData data;
+
+        if(!AssetFiles::readFile(file.string(), data)) {
+            std::cerr << "Could not read " << file.string() << "\n";
+            return 1;
+        }
+
+        if(!writer.add(name, data.getData(), data.getSize(), compress && !isCompressedFormat(file))) {
+            std::cerr << "Could not add " << name << ", its name collides with another entry\n";
+            return 1;
+        }
+    }
+
+    if(!writer.write(packPath)) {
+        std::cerr << "Could not write asset pack: " << packPath << "\n";
+        return 1;
+    }
+
+    std::cout << "Packed " << writer.getEntryCount() << " files, " << writer.getSize() << " bytes into "
+        << writer.getStoredSize() << " bytes: " << packPath << "\n";
+
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    if(args.size() == 2 && args[0] == "--list") {
+        return listPack(args[1]);
+    }
+
+    if(args.size() == 2 || (args.size() == 3 && args[2] == "--store")) {
+        return buildPack(args[0], args[1], args.size() == 2);
+    }
+
+    std::cerr << "Usage: AssetPacker <res folder> <output pack> [--store]\n"
+        << "       AssetPacker --list <pack>\n";
+
+    return 1;
+}
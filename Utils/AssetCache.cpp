@@ -0,0 +1,193 @@
+#include "AssetCache.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "AssetPack.h"
+#include "BlockCompression.h"
+#include "Hash.h"
+
+#if defined(_WIN32)
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+// The cooked data is stored compressed.
+#define ASSET_CACHE_COMPRESSED 0x1
+
+/**
+ * First bytes of a cache entry, followed by the stored data
+ * */
+struct AssetCacheHeader {
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t version;
+    uint32_t flags;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint64_t size;
+    uint64_t storedSize;
+};
+
+static bool makeFolder(const std::string& folder) {
+#if defined(_WIN32)
+    return _mkdir(folder.c_str()) == 0 || errno == EEXIST;
+#else
+    return mkdir(folder.c_str(), 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+std::string& AssetCache::getFolderPath() {
+    static std::string folder;
+    return folder;
+}
+
+bool AssetCache::setFolder(const std::string& folder) {
+    std::string& path = getFolderPath();
+    path.clear();
+
+    if(folder.empty()) {
+        return true;
+    }
+
+    if(!makeFolder(folder)) {
+        return false;
+    }
+
+    path = folder;
+
+    if(path.back() != '/' && path.back() != '\\') {
+        path.push_back('/');
+    }
+
+    return true;
+}
+
+AssetCacheKey AssetCache::makeKey(const std::string& sourcePath, const AssetData& source, const char* type, uint32_t version) {
+    AssetCacheKey key;
+
+    if(!isEnabled()) {
+        return key;
+    }
+
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)fnv1a64(AssetPack::normalizeName(sourcePath)));
+
+    key.file = getFolderPath() + name + "." + type;
+    key.sourceHash = fnv1a64(source.getData(), source.getSize());
+    key.sourceSize = source.getSize();
+    key.version = version;
+    return key;
+}
+
+bool AssetCache::load(const AssetCacheKey& key, AssetData& cooked) {
+    if(key.file.empty()) {
+        return false;
+    }
+
+    std::ifstream input(key.file, std::ios::in | std::ios::binary);
+
+    if(!input.is_open()) {
+        return false;
+    }
+
+    AssetCacheHeader header;
+    input.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if(input.gcount() != sizeof(header)) {
+        return false;
+    }
+
+    // Sizes are checked against the file before anything is allocated for them.
+    input.seekg(0, std::ios::end);
+    uint64_t storedBytes = (uint64_t)input.tellg() - sizeof(header);
+    input.seekg(sizeof(header));
+
+    bool valid = input.good()
+        && header.magic == ASSET_CACHE_MAGIC
+        && header.formatVersion == ASSET_CACHE_FORMAT_VERSION
+        && header.version == key.version
+        && header.sourceHash == key.sourceHash
+        && header.sourceSize == key.sourceSize
+        && header.storedSize == storedBytes
+        && header.size <= SIZE_MAX - 1
+        && ((header.flags & ASSET_CACHE_COMPRESSED) != 0 ? header.size <= BlockCompression::getDecompressBound(header.storedSize)
+            : header.storedSize == header.size);
+
+    if(!valid) {
+        return false;
+    }
+
+    if((header.flags & ASSET_CACHE_COMPRESSED) == 0) {
+        input.read(cooked.allocate((size_t)header.size), (std::streamsize)header.size);
+        return (uint64_t)input.gcount() == header.size;
+    }
+
+    std::vector<char> stored((size_t)header.storedSize);
+    input.read(stored.data(), (std::streamsize)stored.size());
+
+    if((uint64_t)input.gcount() != header.storedSize) {
+        return false;
+    }
+
+    return BlockCompression::decompress(stored.data(), stored.size(), cooked.allocate((size_t)header.size), (size_t)header.size);
+}
+
+bool AssetCache::store(const AssetCacheKey& key, const char* cooked, size_t size) {
+    if(key.file.empty()) {
+        return false;
+    }
+
+    AssetCacheHeader header = {};
+    header.magic = ASSET_CACHE_MAGIC;
+    header.formatVersion = ASSET_CACHE_FORMAT_VERSION;
+    header.version = key.version;
+    header.sourceHash = key.sourceHash;
+    header.sourceSize = key.sourceSize;
+    header.size = size;
+
+    std::vector<char> compressed;
+    const char* stored = cooked;
+    header.storedSize = size;
+
+    if(BlockCompression::compress(cooked, size, compressed) && compressed.size() <= size - size / 8) {
+        header.flags |= ASSET_CACHE_COMPRESSED;
+        stored = compressed.data();
+        header.storedSize = compressed.size();
+    }
+
+    // Written under a name of its own and renamed into place once complete.
+    static std::atomic<uint32_t> writes(0);
+    std::string temporary = key.file + "." + std::to_string(writes.fetch_add(1)) + ".tmp";
+
+    {
+        std::ofstream output(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if(!output.is_open()) {
+            return false;
+        }
+
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(stored, (std::streamsize)header.storedSize);
+        output.close();
+
+        if(output.fail()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+
+    // Renaming onto an existing file fails on Windows, so the old entry goes first.
+    std::remove(key.file.c_str());
+
+    if(std::rename(temporary.c_str(), key.file.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    return true;
+}
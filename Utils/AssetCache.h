@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class AssetData;
+
+// "TCOK" read as a little endian integer.
+#define ASSET_CACHE_MAGIC 0x4B4F4354
+
+// Version of the cache file layout itself. Each loader versions its own cooked format on top of this.
+#define ASSET_CACHE_FORMAT_VERSION 1
+
+/**
+ * Identifies the cooked form of one source file
+ * Made from the source's path, its contents and the version of the loader that cooks it,
+ * so editing the source or changing the loader both turn the cached entry into a miss
+ * */
+struct AssetCacheKey {
+    AssetCacheKey()
+        :sourceHash(0),
+        sourceSize(0),
+        version(0)
+    {
+    }
+
+    std::string file;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint32_t version;
+};
+
+/**
+ * On disk cache of cooked assets: the result of parsing or decoding a source file, in a form that is ready to use
+ * The first load of a source cooks it as usual and stores the result. Later loads hash the source, find the entry
+ * still matches and read the cooked bytes back instead of parsing again
+ * Each source has one entry, named after its path, which is overwritten when the source changes
+ * Cooked data is compressed with BlockCompression when that pays off
+ * Disabled until a folder is set. Set the folder at startup, before anything is loaded; loading is then safe from any thread
+ * */
+class AssetCache {
+    public:
+        /**
+         * Sets the folder entries are kept in and creates it if needed. An empty folder disables the cache
+         * */
+        static bool setFolder(const std::string& folder);
+
+        static const std::string& getFolder() {
+            return getFolderPath();
+        }
+
+        static bool isEnabled() {
+            return !getFolderPath().empty();
+        }
+
+        /**
+         * Builds the key for a source file
+         * @param type short name of the cooked format, such as "obj", and the extension of the entry's file
+         * @param version the loader's cooked format version. Bump it whenever the loader's output changes
+         * */
+        static AssetCacheKey makeKey(const std::string& sourcePath, const AssetData& source, const char* type, uint32_t version);
+
+        /**
+         * Reads a source's cooked data into cooked
+         * Returns false when the cache is disabled, there is no entry or the entry is stale or damaged
+         * */
+        static bool load(const AssetCacheKey& key, AssetData& cooked);
+
+        /**
+         * Writes a source's cooked data, replacing any older entry
+         * The entry only appears once it is complete, so a load running at the same time never sees half of it
+         * */
+        static bool store(const AssetCacheKey& key, const char* cooked, size_t size);
+
+    private:
+        static std::string& getFolderPath();
+};
@@ -0,0 +1,379 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+
+#include "BlockCompression.h"
+#include "Hash.h"
+
+/**
+ * True if [offset, offset + length) lies within a file of the given size
+ * */
+static bool isInFile(uint64_t offset, uint64_t length, uint64_t fileSize) {
+    return offset <= fileSize && length <= fileSize - offset;
+}
+
+bool AssetPack::mount(const std::string& packPath) {
+    header = nullptr;
+    entries = nullptr;
+    names = nullptr;
+
+    if(!file.open(packPath)) {
+        return false;
+    }
+
+    const char* data = file.getData();
+    uint64_t fileSize = file.getSize();
+    const AssetPackHeader* packHeader = reinterpret_cast<const AssetPackHeader*>(data);
+
+    bool valid = fileSize >= sizeof(AssetPackHeader)
+        && packHeader->magic == ASSET_PACK_MAGIC
+        && packHeader->version == ASSET_PACK_VERSION
+        && packHeader->alignment >= alignof(AssetPackEntry)
+        && (packHeader->alignment & (packHeader->alignment - 1)) == 0
+        && packHeader->tocOffset % alignof(AssetPackEntry) == 0
+        && isInFile(packHeader->tocOffset, (uint64_t)packHeader->entryCount * sizeof(AssetPackEntry), fileSize)
+        && isInFile(packHeader->namesOffset, packHeader->namesSize, fileSize)
+        && packHeader->namesSize > 0
+        && data[packHeader->namesOffset + packHeader->namesSize - 1] == 0;
+
+    if(!valid) {
+        file.close();
+        return false;
+    }
+
+    const AssetPackEntry* packEntries = reinterpret_cast<const AssetPackEntry*>(data + packHeader->tocOffset);
+
+    // Checked once here so reads never have to.
+    for(uint32_t i = 0; i < packHeader->entryCount; ++i) {
+        const AssetPackEntry& entry = packEntries[i];
+
+        bool entryValid = isInFile(entry.offset, entry.storedSize, fileSize)
+            && entry.nameOffset < packHeader->namesSize
+            && (i == 0 || packEntries[i - 1].hash <= entry.hash);
+
+        if((entry.flags & ASSET_ENTRY_COMPRESSED) != 0) {
+            // Rejected here rather than when read allocates the claimed size.
+            entryValid = entryValid && entry.size <= BlockCompression::getDecompressBound(entry.storedSize)
+                && entry.size <= SIZE_MAX - 1;
+        }
+        else {
+            // Read in place, so the zero byte that lets text be parsed there has to be in the file too.
+            entryValid = entryValid && entry.storedSize == entry.size
+                && entry.storedSize < fileSize - entry.offset
+                && data[entry.offset + entry.storedSize] == 0;
+        }
+
+        if(!entryValid) {
+            file.close();
+            return false;
+        }
+    }
+
+    path = packPath;
+    header = packHeader;
+    entries = packEntries;
+    names = data + packHeader->namesOffset;
+    return true;
+}
+
+const AssetPackEntry* AssetPack::find(const std::string& name) const {
+    if(header == nullptr) {
+        return nullptr;
+    }
+
+    std::string normalized = normalizeName(name);
+    uint64_t hash = hashName(normalized);
+
+    const AssetPackEntry* end = entries + header->entryCount;
+    const AssetPackEntry* entry = std::lower_bound(entries, end, hash,
+        [](const AssetPackEntry& candidate, uint64_t value) { return candidate.hash < value; });
+
+    for(; entry != end && entry->hash == hash; ++entry) {
+        if(normalized == getName(*entry)) {
+            return entry;
+        }
+    }
+
+    return nullptr;
+}
+
+bool AssetPack::read(const AssetPackEntry& entry, AssetData& data) const {
+    const char* stored = file.getData() + entry.offset;
+
+    if((entry.flags & ASSET_ENTRY_COMPRESSED) == 0) {
+        data.reference(stored, (size_t)entry.size);
+        return true;
+    }
+
+    char* output = data.allocate((size_t)entry.size);
+
+    if(!BlockCompression::decompress(stored, (size_t)entry.storedSize, output, (size_t)entry.size)) {
+        data.reference(nullptr, 0);
+        return false;
+    }
+
+    return true;
+}
+
+std::string AssetPack::normalizeName(const std::string& name) {
+    std::string normalized = name;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+
+    size_t start = 0;
+
+    while(true) {
+        if(normalized.compare(start, 2, "./") == 0) {
+            start += 2;
+        }
+        else if(normalized.compare(start, 1, "/") == 0) {
+            start++;
+        }
+        else {
+            break;
+        }
+    }
+
+    return normalized.substr(start);
+}
+
+uint64_t AssetPack::hashName(const std::string& normalizedName) {
+    return fnv1a64(normalizedName);
+}
+
+bool AssetPackWriter::add(const std::string& name, const char* data, size_t size, bool compress) {
+    Asset asset;
+    asset.name = AssetPack::normalizeName(name);
+    asset.hash = AssetPack::hashName(asset.name);
+    asset.size = size;
+    asset.flags = 0;
+
+    // Two names with the same hash would still be found, but it is far more likely the same file was added twice.
+    if(asset.name.empty() || hashes.find(asset.hash) != hashes.end()) {
+        return false;
+    }
+
+    if(compress && BlockCompression::compress(data, size, asset.stored) && asset.stored.size() <= size - size / 8) {
+        asset.flags |= ASSET_ENTRY_COMPRESSED;
+    }
+    else {
+        asset.stored.assign(data, data + size);
+    }
+
+    hashes[asset.hash] = assets.size();
+    assets.push_back(std::move(asset));
+    return true;
+}
+
+static void writePadding(std::ofstream& output, uint64_t& position, uint64_t alignment) {
+    static const char zeros[ASSET_PACK_ALIGNMENT] = {};
+    uint64_t padding = (alignment - position % alignment) % alignment;
+
+    output.write(zeros, (std::streamsize)padding);
+    position += padding;
+}
+
+bool AssetPackWriter::write(const std::string& path) const {
+    std::ofstream output(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!output.is_open()) {
+        return false;
+    }
+
+    AssetPackHeader header = {};
+    header.magic = ASSET_PACK_MAGIC;
+    header.version = ASSET_PACK_VERSION;
+    header.entryCount = (uint32_t)assets.size();
+    header.alignment = ASSET_PACK_ALIGNMENT;
+
+    // Filled in once the offsets are known.
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t position = sizeof(header);
+
+    std::vector<AssetPackEntry> toc;
+    std::string nameTable;
+    toc.reserve(assets.size());
+
+    for(size_t i = 0; i < assets.size(); ++i) {
+        const Asset& asset = assets[i];
+        writePadding(output, position, ASSET_PACK_ALIGNMENT);
+
+        AssetPackEntry entry = {};
+        entry.hash = asset.hash;
+        entry.offset = position;
+        entry.storedSize = asset.stored.size();
+        entry.size = asset.size;
+        entry.nameOffset = (uint32_t)nameTable.size();
+        entry.flags = asset.flags;
+        toc.push_back(entry);
+
+        output.write(asset.stored.data(), (std::streamsize)asset.stored.size());
+
+        // Lets text entries be parsed in place.
+        output.put(0);
+        position += asset.stored.size() + 1;
+
+        nameTable.append(asset.name);
+        nameTable.push_back(0);
+    }
+
+    std::sort(toc.begin(), toc.end(), [](const AssetPackEntry& a, const AssetPackEntry& b) { return a.hash < b.hash; });
+
+    writePadding(output, position, ASSET_PACK_ALIGNMENT);
+    header.tocOffset = position;
+    output.write(reinterpret_cast<const char*>(toc.data()), (std::streamsize)(toc.size() * sizeof(AssetPackEntry)));
+    position += toc.size() * sizeof(AssetPackEntry);
+
+    // An empty pack still gets a name table, so every pack has at least one byte of names.
+    if(nameTable.empty()) {
+        nameTable.push_back(0);
+    }
+
+    header.namesOffset = position;
+    header.namesSize = nameTable.size();
+    output.write(nameTable.data(), (std::streamsize)nameTable.size());
+
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.close();
+
+    return !output.fail();
+}
+
+uint64_t AssetPackWriter::getSize() const {
+    uint64_t total = 0;
+
+    for(size_t i = 0; i < assets.size(); ++i) {
+        total += assets[i].size;
+    }
+
+    return total;
+}
+
+uint64_t AssetPackWriter::getStoredSize() const {
+    uint64_t total = 0;
+
+    for(size_t i = 0; i < assets.size(); ++i) {
+        total += assets[i].stored.size();
+    }
+
+    return total;
+}
+
+/**
+ * A pack and the folder it was built from
+ * */
+struct AssetMount {
+    std::string root;
+    std::unique_ptr<AssetPack> pack;
+};
+
+struct AssetMountTable {
+    std::mutex lock;
+    std::vector<AssetMount> mounts;
+};
+
+static AssetMountTable& getMountTable() {
+    static AssetMountTable table;
+    return table;
+}
+
+/**
+ * Turns backslashes into forward slashes so a path can be matched against a mount's root
+ * */
+static std::string toForwardSlashes(const std::string& path) {
+    std::string converted = path;
+    std::replace(converted.begin(), converted.end(), '\\', '/');
+    return converted;
+}
+
+bool AssetFiles::mount(const std::string& packPath, const std::string& root) {
+    AssetMount added;
+    added.root = toForwardSlashes(root);
+    added.pack.reset(new AssetPack());
+
+    if(!added.root.empty() && added.root.back() != '/') {
+        added.root.push_back('/');
+    }
+
+    if(!added.pack->mount(packPath)) {
+        return false;
+    }
+
+    AssetMountTable& table = getMountTable();
+    std::lock_guard<std::mutex> guard(table.lock);
+    table.mounts.push_back(std::move(added));
+    return true;
+}
+
+const AssetPack* AssetFiles::findEntry(const std::string& path, const AssetPackEntry*& entry) {
+    AssetMountTable& table = getMountTable();
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    if(table.mounts.empty()) {
+        return nullptr;
+    }
+
+    std::string converted = toForwardSlashes(path);
+
+    for(size_t i = table.mounts.size(); i-- > 0;) {
+        const AssetMount& mount = table.mounts[i];
+
+        if(converted.compare(0, mount.root.size(), mount.root) != 0) {
+            continue;
+        }
+
+        entry = mount.pack->find(converted.substr(mount.root.size()));
+
+        if(entry != nullptr) {
+            // Packs are never unmounted, so the pointer stays good once the lock is released.
+            return mount.pack.get();
+        }
+    }
+
+    return nullptr;
+}
+
+bool AssetFiles::read(const std::string& path, AssetData& data) {
+    const AssetPackEntry* entry = nullptr;
+    const AssetPack* pack = findEntry(path, entry);
+
+    if(pack != nullptr) {
+        return pack->read(*entry, data);
+    }
+
+    return readFile(path, data);
+}
+
+bool AssetFiles::readFile(const std::string& path, AssetData& data) {
+    std::ifstream input(path, std::ios::in | std::ios::binary | std::ios::ate);
+
+    if(!input.is_open()) {
+        return false;
+    }
+
+    std::streamoff size = input.tellg();
+
+    if(size < 0) {
+        return false;
+    }
+
+    input.seekg(0, std::ios::beg);
+    char* buffer = data.allocate((size_t)size);
+    input.read(buffer, size);
+
+    return input.gcount() == size;
+}
+
+bool AssetFiles::isPacked(const std::string& path) {
+    const AssetPackEntry* entry = nullptr;
+    return findEntry(path, entry) != nullptr;
+}
+
+uint32_t AssetFiles::getMountCount() {
+    AssetMountTable& table = getMountTable();
+    std::lock_guard<std::mutex> guard(table.lock);
+    return (uint32_t)table.mounts.size();
+}
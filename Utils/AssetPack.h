@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+
+// "TPAK" read as a little endian integer. Packs are written in the byte order of the machine that builds them.
+#define ASSET_PACK_MAGIC 0x4B415054
+#define ASSET_PACK_VERSION 1
+
+// Alignment of every entry's data in the pack, enough for any type to be read from it in place.
+#define ASSET_PACK_ALIGNMENT 64
+
+// The entry is stored compressed with BlockCompression.
+#define ASSET_ENTRY_COMPRESSED 0x1
+
+/**
+ * First bytes of a pack file
+ * Layout: header, entry data aligned to the header's alignment, table of contents, entry names
+ * */
+struct AssetPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t alignment;
+    uint64_t tocOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+/**
+ * A table of contents entry
+ * The table is sorted by hash so an entry is found with a binary search and no string compares until the hash matches
+ * Stored entries are followed by at least one zero byte, so text can be parsed in place
+ * */
+struct AssetPackEntry {
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t storedSize;
+    uint64_t size;
+    uint32_t nameOffset;
+    uint32_t flags;
+};
+
+/**
+ * The bytes of an asset
+ * Either points straight into a mounted pack, or owns a buffer for assets that were decompressed or read from a loose file
+ * Owned buffers are followed by a zero byte just like stored pack entries
+ * */
+class AssetData {
+    public:
+        AssetData()
+            :data(nullptr),
+            size(0)
+        {
+        }
+
+        AssetData(const AssetData&) = delete;
+        AssetData& operator=(const AssetData&) = delete;
+
+        const char* getData() const {
+            return data;
+        }
+
+        size_t getSize() const {
+            return size;
+        }
+
+        /**
+         * True when the data points into a pack rather than into a buffer of its own
+         * */
+        bool isMapped() const {
+            return data != nullptr && buffer.empty();
+        }
+
+        /**
+         * Points at bytes that outlive this object
+         * */
+        void reference(const char* bytes, size_t length) {
+            buffer.clear();
+            data = bytes;
+            size = length;
+        }
+
+        /**
+         * Replaces the data with a zero filled buffer of its own and returns it for writing
+         * */
+        char* allocate(size_t length) {
+            buffer.assign(length + 1, 0);
+            data = buffer.data();
+            size = length;
+            return buffer.data();
+        }
+
+    private:
+        const char* data;
+        size_t size;
+        std::vector<char> buffer;
+};
+
+/**
+ * A read only archive of assets, memory mapped when mounted
+ * Entry names are paths relative to the folder the pack was built from, using forward slashes
+ * Stored entries are read with no copy at all; pointers into the pack stay valid for as long as it is mounted
+ * */
+class AssetPack {
+    public:
+        AssetPack()
+            :header(nullptr),
+            entries(nullptr),
+            names(nullptr)
+        {
+        }
+
+        AssetPack(const AssetPack&) = delete;
+        AssetPack& operator=(const AssetPack&) = delete;
+
+        /**
+         * Maps a pack file and validates its table of contents
+         * Returns false and leaves the pack empty if the file is missing, truncated or not a pack
+         * */
+        bool mount(const std::string& path);
+
+        bool isMounted() const {
+            return header != nullptr;
+        }
+
+        /**
+         * Returns the entry with the given name, or null
+         * */
+        const AssetPackEntry* find(const std::string& name) const;
+
+        /**
+         * Reads an entry, decompressing it if it was stored compressed
+         * */
+        bool read(const AssetPackEntry& entry, AssetData& data) const;
+
+        bool read(const std::string& name, AssetData& data) const {
+            const AssetPackEntry* entry = find(name);
+            return entry != nullptr && read(*entry, data);
+        }
+
+        uint32_t getEntryCount() const {
+            return header == nullptr ? 0 : header->entryCount;
+        }
+
+        /**
+         * Entries in table of contents order
+         * */
+        const AssetPackEntry& getEntry(uint32_t index) const {
+            return entries[index];
+        }
+
+        const char* getName(const AssetPackEntry& entry) const {
+            return names + entry.nameOffset;
+        }
+
+        const std::string& getPath() const {
+            return path;
+        }
+
+        /**
+         * Converts a path to the form names are stored in: forward slashes and no leading "./" or "/"
+         * */
+        static std::string normalizeName(const std::string& name);
+
+        static uint64_t hashName(const std::string& normalizedName);
+
+    private:
+        MappedFile file;
+        std::string path;
+
+        const AssetPackHeader* header;
+        const AssetPackEntry* entries;
+        const char* names;
+};
+
+/**
+ * Builds a pack file
+ * Assets are added with their names and data, then written out in one go
+ * */
+class AssetPackWriter {
+    public:
+        AssetPackWriter() {}
+
+        /**
+         * Adds an asset
+         * When compress is set the asset is stored compressed, but only if that saves at least an eighth of its size
+         * Returns false if the name is already in the pack or collides with another name's hash
+         * */
+        bool add(const std::string& name, const char* data, size_t size, bool compress);
+
+        /**
+         * Writes the pack, overwriting the file if it exists
+         * */
+        bool write(const std::string& path) const;
+
+        size_t getEntryCount() const {
+            return assets.size();
+        }
+
+        /**
+         * Total size of the assets before and after compression
+         * */
+        uint64_t getSize() const;
+        uint64_t getStoredSize() const;
+
+    private:
+        struct Asset {
+            std::string name;
+            uint64_t hash;
+            uint64_t size;
+            uint32_t flags;
+            std::vector<char> stored;
+        };
+
+        std::vector<Asset> assets;
+
+        // Index into assets by name hash.
+        std::unordered_map<uint64_t, size_t> hashes;
+};
+
+/**
+ * Where the engine's loaders read their files from
+ * Packs are mounted over a folder: a file under that folder is looked up in the pack first, newest mount first,
+ * and read from disk only if no pack has it. Files outside every mounted folder are always read from disk
+ * Safe to call from any thread. Packs stay mounted until the program exits
+ * */
+class AssetFiles {
+    public:
+        /**
+         * Mounts a pack built from the contents of root, normally the res folder
+         * */
+        static bool mount(const std::string& packPath, const std::string& root);
+
+        /**
+         * Reads a file from a mounted pack, or from disk
+         * */
+        static bool read(const std::string& path, AssetData& data);
+
+        /**
+         * Reads a file from disk with a single read into the data's own buffer
+         * */
+        static bool readFile(const std::string& path, AssetData& data);
+
+        /**
+         * Returns true if a mounted pack has the file
+         * */
+        static bool isPacked(const std::string& path);
+
+        static uint32_t getMountCount();
+
+    private:
+        static const AssetPack* findEntry(const std::string& path, const AssetPackEntry*& entry);
+};
@@ -0,0 +1,205 @@
+#include "BlockCompression.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 16
+
+// The format requires the last five bytes to be literals and the last match to start at least twelve bytes from the end.
+#define LZ_LAST_LITERALS 5
+#define LZ_MATCH_FIND_LIMIT 12
+
+#define LZ_NO_POSITION 0xFFFFFFFF
+
+static uint32_t read32(const char* source) {
+    uint32_t value;
+    memcpy(&value, source, sizeof(value));
+    return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/**
+ * Lengths that do not fit in a token nibble continue as bytes of 255 followed by the remainder
+ * */
+static void writeLength(std::vector<char>& output, size_t length) {
+    while(length >= 255) {
+        output.push_back((char)255);
+        length -= 255;
+    }
+
+    output.push_back((char)length);
+}
+
+static void writeSequence(std::vector<char>& output, const char* literals, size_t literalCount, size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength - LZ_MIN_MATCH;
+    unsigned char token = (unsigned char)(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+    output.push_back((char)token);
+
+    if(literalCount >= 15) {
+        writeLength(output, literalCount - 15);
+    }
+
+    output.insert(output.end(), literals, literals + literalCount);
+    output.push_back((char)(offset & 0xFF));
+    output.push_back((char)(offset >> 8));
+
+    if(matchCode >= 15) {
+        writeLength(output, matchCode - 15);
+    }
+}
+
+static void writeLastLiterals(std::vector<char>& output, const char* literals, size_t literalCount) {
+    output.push_back((char)((literalCount < 15 ? literalCount : 15) << 4));
+
+    if(literalCount >= 15) {
+        writeLength(output, literalCount - 15);
+    }
+
+    output.insert(output.end(), literals, literals + literalCount);
+}
+
+bool BlockCompression::compress(const char* input, size_t size, std::vector<char>& output) {
+    output.clear();
+
+    if((uint64_t)size >= 0xFFFFFFFFull) {
+        return false;
+    }
+
+    output.reserve(getCompressBound(size));
+    size_t anchor = 0;
+
+    if(size > LZ_MATCH_FIND_LIMIT) {
+        // Most recent position of each hashed four byte sequence.
+        std::unique_ptr<uint32_t[]> table(new uint32_t[1 << LZ_HASH_BITS]);
+
+        for(size_t i = 0; i < (1 << LZ_HASH_BITS); ++i) {
+            table[i] = LZ_NO_POSITION;
+        }
+
+        size_t matchLimit = size - LZ_LAST_LITERALS;
+        size_t position = 0;
+
+        while(position + LZ_MATCH_FIND_LIMIT <= size) {
+            uint32_t sequence = read32(input + position);
+            uint32_t hash = hashSequence(sequence);
+            uint32_t candidate = table[hash];
+            table[hash] = (uint32_t)position;
+
+            if(candidate == LZ_NO_POSITION || position - candidate > LZ_MAX_OFFSET || read32(input + candidate) != sequence) {
+                position++;
+                continue;
+            }
+
+            size_t start = position;
+            size_t match = candidate;
+
+            // Grow the match backwards into bytes that would otherwise be literals.
+            while(start > anchor && match > 0 && input[start - 1] == input[match - 1]) {
+                start--;
+                match--;
+            }
+
+            size_t length = position - start + LZ_MIN_MATCH;
+
+            while(start + length < matchLimit && input[start + length] == input[match + length]) {
+                length++;
+            }
+
+            writeSequence(output, input + anchor, start - anchor, start - match, length);
+            position = start + length;
+            anchor = position;
+        }
+    }
+
+    writeLastLiterals(output, input + anchor, size - anchor);
+    return true;
+}
+
+bool BlockCompression::decompress(const char* input, size_t size, char* output, size_t outputSize) {
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(input);
+    size_t in = 0;
+    size_t out = 0;
+
+    while(in < size) {
+        unsigned char token = source[in++];
+        size_t literalCount = token >> 4;
+
+        if(literalCount == 15) {
+            unsigned char next;
+
+            do {
+                if(in >= size) {
+                    return false;
+                }
+
+                next = source[in++];
+                literalCount += next;
+            } while(next == 255);
+        }
+
+        if(literalCount > size - in || literalCount > outputSize - out) {
+            return false;
+        }
+
+        memcpy(output + out, input + in, literalCount);
+        in += literalCount;
+        out += literalCount;
+
+        // The last sequence has no match.
+        if(in == size) {
+            break;
+        }
+
+        if(size - in < 2) {
+            return false;
+        }
+
+        size_t offset = (size_t)source[in] | ((size_t)source[in + 1] << 8);
+        in += 2;
+
+        if(offset == 0 || offset > out) {
+            return false;
+        }
+
+        size_t matchLength = token & 15;
+
+        if(matchLength == 15) {
+            unsigned char next;
+
+            do {
+                if(in >= size) {
+                    return false;
+                }
+
+                next = source[in++];
+                matchLength += next;
+            } while(next == 255);
+        }
+
+        matchLength += LZ_MIN_MATCH;
+
+        if(matchLength > outputSize - out) {
+            return false;
+        }
+
+        // Matches may overlap the bytes they produce, so copy forwards one byte at a time unless they are far enough apart.
+        if(offset >= matchLength) {
+            memcpy(output + out, output + out - offset, matchLength);
+        }
+        else {
+            for(size_t i = 0; i < matchLength; ++i) {
+                output[out + i] = output[out + i - offset];
+            }
+        }
+
+        out += matchLength;
+    }
+
+    return out == outputSize;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Fast byte oriented LZ compression using the LZ4 block format
+ * Favors decompression speed over ratio: decoding is little more than a series of copies,
+ * so compressed assets load about as fast as stored ones while taking less disk to read
+ * Blocks carry no header, the caller keeps track of the uncompressed size
+ * */
+class BlockCompression {
+    public:
+        /**
+         * Largest compressed size an input of the given size can produce
+         * */
+        static size_t getCompressBound(size_t size) {
+            return size + size / 255 + 16;
+        }
+
+        /**
+         * Largest size a block of the given compressed size can decompress to
+         * Each extra length byte adds at most 255 bytes of output, so sizes claimed beyond this are corrupt
+         * */
+        static uint64_t getDecompressBound(uint64_t size) {
+            return size * 255;
+        }
+
+        /**
+         * Compresses a block, replacing the contents of output
+         * Inputs of 4 GiB or more are rejected
+         * */
+        static bool compress(const char* input, size_t size, std::vector<char>& output);
+
+        /**
+         * Decompresses a block into exactly outputSize bytes
+         * Returns false on malformed input or if the block does not decode to exactly outputSize bytes,
+         * never reading or writing out of bounds
+         * */
+        static bool decompress(const char* input, size_t size, char* output, size_t outputSize);
+};
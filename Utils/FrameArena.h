@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Size of each block a linear arena allocates from the heap.
+#define ARENA_DEFAULT_CHUNK_SIZE (256 * 1024)
+
+// Arenas each thread cycles through. Data allocated in frame N is released by the beginFrame that starts frame N + 2.
+#define FRAME_ARENA_BUFFERS 2
+
+/**
+ * Bump allocator: each allocation moves a pointer forward, nothing is freed on its own and reset frees everything at once
+ * When the current chunk is full another one is added. Reset folds all chunks into one large enough for the whole
+ * of the last use, so after a few frames a steady workload is served from a single chunk with no heap traffic at all
+ * Not thread safe, every thread uses its own arena
+ * */
+class LinearArena {
+    public:
+        /**
+         * Marks a point in the arena to rewind to
+         * */
+        struct Marker {
+            size_t chunk;
+            size_t offset;
+        };
+
+        LinearArena(size_t chunkSize = ARENA_DEFAULT_CHUNK_SIZE)
+            :chunkSize(chunkSize),
+            current(0),
+            offset(0),
+            used(0),
+            peak(0)
+        {
+        }
+
+        ~LinearArena() {}
+
+        LinearArena(const LinearArena&) = delete;
+        LinearArena& operator=(const LinearArena&) = delete;
+
+        /**
+         * @param alignment must be a power of two
+         * */
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+            while(true) {
+                if(current < chunks.size()) {
+                    Chunk& chunk = chunks[current];
+                    size_t start = align(chunk.data.get() + offset, alignment) - chunk.data.get();
+
+                    if(start + size <= chunk.size) {
+                        used += start + size - offset;
+                        offset = start + size;
+
+                        if(used > peak) {
+                            peak = used;
+                        }
+
+                        return chunk.data.get() + start;
+                    }
+
+                    // Skip to the next chunk, the tail of this one is lost until reset.
+                    used += chunk.size - offset;
+                    current++;
+                    offset = 0;
+                    continue;
+                }
+
+                addChunk(size + alignment > chunkSize ? size + alignment : chunkSize);
+            }
+        }
+
+        /**
+         * Gives memory back only if it was the last allocation, so a container that grows
+         * and frees its old buffer right away does not leave the old buffer behind
+         * */
+        void deallocate(void* memory, size_t size) {
+            if(current >= chunks.size()) {
+                return;
+            }
+
+            unsigned char* start = static_cast<unsigned char*>(memory);
+            unsigned char* top = chunks[current].data.get() + offset;
+
+            if(start + size == top) {
+                offset -= size;
+                used -= size;
+            }
+        }
+
+        Marker getMarker() const {
+            return { current, offset };
+        }
+
+        /**
+         * Frees everything allocated since the marker was taken
+         * */
+        void rewind(const Marker& marker) {
+            if(marker.chunk > current || (marker.chunk == current && marker.offset >= offset)) {
+                return;
+            }
+
+            current = marker.chunk;
+            offset = marker.offset;
+            used = 0;
+
+            for(size_t i = 0; i < current; ++i) {
+                used += chunks[i].size;
+            }
+
+            used += offset;
+        }
+
+        /**
+         * Frees every allocation. Anything still pointing into the arena is left dangling
+         * */
+        void reset() {
+            // Spilled into more than one chunk: replace them with a single chunk that fits the whole frame.
+            if(chunks.size() > 1) {
+                size_t total = 0;
+
+                for(size_t i = 0; i < chunks.size(); ++i) {
+                    total += chunks[i].size;
+                }
+
+                chunks.clear();
+                addChunk(total);
+            }
+
+            current = 0;
+            offset = 0;
+            used = 0;
+        }
+
+        size_t getBytesUsed() const {
+            return used;
+        }
+
+        size_t getPeakBytesUsed() const {
+            return peak;
+        }
+
+        size_t getCapacity() const {
+            size_t total = 0;
+
+            for(size_t i = 0; i < chunks.size(); ++i) {
+                total += chunks[i].size;
+            }
+
+            return total;
+        }
+
+    private:
+        struct Chunk {
+            std::unique_ptr<unsigned char[]> data;
+            size_t size;
+        };
+
+        static unsigned char* align(unsigned char* pointer, size_t alignment) {
+            uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+            return pointer + (((address + alignment - 1) & ~(uintptr_t)(alignment - 1)) - address);
+        }
+
+        void addChunk(size_t size) {
+            Chunk chunk;
+            chunk.data.reset(new unsigned char[size]);
+            chunk.size = size;
+            chunks.push_back(std::move(chunk));
+        }
+
+        const size_t chunkSize;
+        std::vector<Chunk> chunks;
+
+        // Chunk being allocated from and the next free byte in it.
+        size_t current;
+        size_t offset;
+
+        size_t used;
+        size_t peak;
+};
+
+/**
+ * The calling thread's frame arenas
+ * A thread with a frame loop calls beginFrame once per frame: the update thread once per tick, the render thread once per frame
+ * Each call moves to the next of FRAME_ARENA_BUFFERS arenas and resets it: an allocation made in frame N stays valid through
+ * frame N + 1 and is freed by the beginFrame call that starts frame N + 2 on the allocating thread
+ * Only that thread's frame count decides this, so another thread may only read frame data if the owner waits for it to be
+ * done before beginning frame N + 2, for example by waiting on the job reading it. Nothing here checks that
+ * On job system workers the arena is rewound after every job, so allocations there last only as long as the job
+ * */
+class FrameArena {
+    public:
+        /**
+         * This thread's arena for the current frame
+         * */
+        static LinearArena& get() {
+            ThreadArenas& arenas = getThreadArenas();
+            return arenas.arenas[arenas.current];
+        }
+
+        static void beginFrame() {
+            ThreadArenas& arenas = getThreadArenas();
+            arenas.current = (arenas.current + 1) % FRAME_ARENA_BUFFERS;
+            arenas.arenas[arenas.current].reset();
+            arenas.frame++;
+        }
+
+        /**
+         * Frames begun on this thread
+         * */
+        static uint64_t getFrameIndex() {
+            return getThreadArenas().frame;
+        }
+
+    private:
+        struct ThreadArenas {
+            ThreadArenas()
+                :current(0),
+                frame(0)
+            {
+            }
+
+            LinearArena arenas[FRAME_ARENA_BUFFERS];
+            uint32_t current;
+            uint64_t frame;
+        };
+
+        static ThreadArenas& getThreadArenas() {
+            static thread_local ThreadArenas arenas;
+            return arenas;
+        }
+};
+
+/**
+ * Rewinds the current frame arena when it goes out of scope, freeing everything allocated inside the scope
+ * Lets code without a frame loop use arena containers for scratch work
+ * */
+class ArenaScope {
+    public:
+        ArenaScope()
+            :arena(FrameArena::get()),
+            marker(arena.getMarker())
+        {
+        }
+
+        ~ArenaScope() {
+            arena.rewind(marker);
+        }
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+
+    private:
+        LinearArena& arena;
+        LinearArena::Marker marker;
+};
+
+/**
+ * Standard library allocator over a linear arena
+ * Default constructed allocators use the calling thread's current frame arena
+ * Containers using one must not outlive the arena's frame, and must not be resized from another thread
+ * */
+template<typename T>
+class ArenaAllocator {
+    public:
+        typedef T value_type;
+
+        ArenaAllocator()
+            :arena(&FrameArena::get())
+        {
+        }
+
+        ArenaAllocator(LinearArena& arena)
+            :arena(&arena)
+        {
+        }
+
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other)
+            :arena(other.arena)
+        {
+        }
+
+        T* allocate(size_t count) {
+            return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* memory, size_t count) {
+            arena->deallocate(memory, count * sizeof(T));
+        }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>& other) const {
+            return arena == other.arena;
+        }
+
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const {
+            return arena != other.arena;
+        }
+
+    private:
+        template<typename U>
+        friend class ArenaAllocator;
+
+        LinearArena* arena;
+};
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+// Buckets per power of two. A bucketed value is within 2 / FRAME_HISTOGRAM_SUB_BUCKETS of the real value (~3%).
+#define FRAME_HISTOGRAM_SUB_BUCKETS 64
+
+// Largest power of two tracked, in nanoseconds. 2^40ns is about 18 minutes, anything longer lands in the last bucket.
+#define FRAME_HISTOGRAM_MAX_EXPONENT 40
+
+/**
+ * Percentiles and spikes of the frames recorded in a histogram, times in nanoseconds
+ * */
+struct FrameStats {
+    uint64_t frames;
+    uint64_t meanNanos;
+    uint64_t p50Nanos;
+    uint64_t p95Nanos;
+    uint64_t p99Nanos;
+    uint64_t maxNanos;
+    uint64_t spikes;
+    uint64_t spikeThresholdNanos;
+};
+
+/**
+ * HDR style histogram of frame times
+ * Buckets are linear within each power of two, so precision is relative to the value: a 100us frame and a 100ms frame
+ * are both resolved to ~3% with a fixed, small number of buckets and no allocation
+ * One thread records, any thread may read. Counters are relaxed atomics, so a read taken while frames are being
+ * recorded may be off by the frames in flight
+ * */
+class FrameTimeHistogram {
+    public:
+        /**
+         * @param spikeThresholdNanos frames longer than this count as spikes, 0 disables spike detection
+         * */
+        explicit FrameTimeHistogram(uint64_t spikeThresholdNanos = 0)
+            :spikeThreshold(spikeThresholdNanos)
+        {
+            reset();
+        }
+
+        ~FrameTimeHistogram() {}
+
+        FrameTimeHistogram(const FrameTimeHistogram&) = delete;
+        FrameTimeHistogram& operator=(const FrameTimeHistogram&) = delete;
+
+        /**
+         * Adds one frame
+         * @return true if the frame is a spike
+         * */
+        inline bool record(uint64_t frameNanos) {
+            buckets[getBucket(frameNanos)].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            total.fetch_add(frameNanos, std::memory_order_relaxed);
+
+            if(frameNanos > max.load(std::memory_order_relaxed)) {
+                max.store(frameNanos, std::memory_order_relaxed);
+            }
+
+            uint64_t threshold = spikeThreshold.load(std::memory_order_relaxed);
+            if(threshold != 0 && frameNanos > threshold) {
+                spikes.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+         * Drops every recorded frame, keeping the spike threshold
+         * */
+        void reset() {
+            for(uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+                buckets[i].store(0, std::memory_order_relaxed);
+            }
+
+            count.store(0, std::memory_order_relaxed);
+            total.store(0, std::memory_order_relaxed);
+            max.store(0, std::memory_order_relaxed);
+            spikes.store(0, std::memory_order_relaxed);
+        }
+
+        inline void setSpikeThreshold(uint64_t thresholdNanos) {
+            spikeThreshold.store(thresholdNanos, std::memory_order_relaxed);
+        }
+
+        inline uint64_t getSpikeThreshold() const {
+            return spikeThreshold.load(std::memory_order_relaxed);
+        }
+
+        inline uint64_t getSpikeCount() const {
+            return spikes.load(std::memory_order_relaxed);
+        }
+
+        inline uint64_t getFrameCount() const {
+            return count.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Returns the frame time below which the given fraction of frames fall, 0.99 for p99
+         * Reported as the upper edge of the bucket holding that frame, clamped to the largest frame seen
+         * */
+        uint64_t getPercentile(double fraction) const {
+            uint64_t frames = count.load(std::memory_order_relaxed);
+            if(frames == 0) {
+                return 0;
+            }
+
+            // Rank of the frame we are after, 1 based.
+            uint64_t rank = (uint64_t)(fraction * frames + 0.5);
+            rank = (rank < 1)? 1 : ((rank > frames)? frames : rank);
+
+            uint64_t seen = 0;
+            uint64_t largest = max.load(std::memory_order_relaxed);
+
+            for(uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+                seen += buckets[i].load(std::memory_order_relaxed);
+
+                if(seen >= rank) {
+                    uint64_t upper = getBucketUpper(i);
+                    return (upper < largest)? upper : largest;
+                }
+            }
+
+            return largest;
+        }
+
+        FrameStats getStats() const {
+            FrameStats stats;
+            stats.frames = count.load(std::memory_order_relaxed);
+            stats.meanNanos = (stats.frames != 0)? total.load(std::memory_order_relaxed) / stats.frames : 0;
+            stats.p50Nanos = getPercentile(0.50);
+            stats.p95Nanos = getPercentile(0.95);
+            stats.p99Nanos = getPercentile(0.99);
+            stats.maxNanos = max.load(std::memory_order_relaxed);
+            stats.spikes = spikes.load(std::memory_order_relaxed);
+            stats.spikeThresholdNanos = spikeThreshold.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        /**
+         * Writes every non empty bucket as a CSV row: label,lower_ms,upper_ms,frames
+         * The caller writes the header, so several histograms can share one table
+         * */
+        void writeCsv(std::ostream& output, const char* label) const {
+            for(uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+                uint64_t frames = buckets[i].load(std::memory_order_relaxed);
+
+                if(frames != 0) {
+                    output << label << ',' << getBucketLower(i) / 1e6 << ',' << getBucketUpper(i) / 1e6 << ',' << frames << '\n';
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t SUB_BUCKET_BITS = 6;
+        static constexpr uint32_t HALF_SUB_BUCKETS = FRAME_HISTOGRAM_SUB_BUCKETS / 2;
+
+        // The first FRAME_HISTOGRAM_SUB_BUCKETS values get a bucket each, every power of two above that gets half as many.
+        static constexpr uint32_t BUCKET_COUNT = FRAME_HISTOGRAM_SUB_BUCKETS
+            + (FRAME_HISTOGRAM_MAX_EXPONENT - SUB_BUCKET_BITS) * HALF_SUB_BUCKETS;
+
+        static_assert((1u << SUB_BUCKET_BITS) == FRAME_HISTOGRAM_SUB_BUCKETS, "Sub bucket count must match its bit count");
+
+        static inline uint32_t highestBit(uint64_t value) {
+            uint32_t bit = 0;
+            while(value >>= 1) {
+                bit++;
+            }
+            return bit;
+        }
+
+        static inline uint32_t getBucket(uint64_t value) {
+            if(value < FRAME_HISTOGRAM_SUB_BUCKETS) {
+                return (uint32_t)value;
+            }
+
+            // Keep the top SUB_BUCKET_BITS bits of the value, the rest only decide which power of two it is in.
+            uint32_t shift = highestBit(value) - SUB_BUCKET_BITS + 1;
+            uint32_t index = FRAME_HISTOGRAM_SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS
+                + (uint32_t)(value >> shift) - HALF_SUB_BUCKETS;
+
+            return (index < BUCKET_COUNT)? index : BUCKET_COUNT - 1;
+        }
+
+        static inline uint64_t getBucketLower(uint32_t index) {
+            if(index < FRAME_HISTOGRAM_SUB_BUCKETS) {
+                return index;
+            }
+
+            uint32_t shift = (index - FRAME_HISTOGRAM_SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+            uint64_t sub = (index - FRAME_HISTOGRAM_SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+            return sub << shift;
+        }
+
+        static inline uint64_t getBucketUpper(uint32_t index) {
+            if(index < FRAME_HISTOGRAM_SUB_BUCKETS) {
+                return index;
+            }
+
+            uint32_t shift = (index - FRAME_HISTOGRAM_SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+            return getBucketLower(index) + ((uint64_t)1 << shift) - 1;
+        }
+
+        std::atomic<uint64_t> buckets[BUCKET_COUNT];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> total;
+        std::atomic<uint64_t> max;
+        std::atomic<uint64_t> spikes;
+        std::atomic<uint64_t> spikeThreshold;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ull
+#define FNV1A_64_PRIME 0x100000001b3ull
+
+/**
+ * 64 bit FNV-1a over a block of bytes
+ * Stable across runs and platforms, so it can be written to disk
+ * Pass the result of a previous call as the seed to hash data that arrives in pieces
+ * */
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = FNV1A_64_OFFSET_BASIS) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+
+    for(size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV1A_64_PRIME;
+    }
+
+    return hash;
+}
+
+inline uint64_t fnv1a64(const std::string& text, uint64_t seed = FNV1A_64_OFFSET_BASIS) {
+    return fnv1a64(text.data(), text.size(), seed);
+}
@@ -0,0 +1,212 @@
+#include "JobSystem.h"
+
+#include <string>
+
+#include "FrameArena.h"
+#include "Profiler.h"
+
+thread_local const JobSystem* JobSystem::threadOwner = nullptr;
+thread_local uint32_t JobSystem::threadIndex = 0;
+
+JobSystem::JobSystem(uint32_t workerCount)
+    :queuedJobs(0),
+    stopping(false)
+{
+    if(workerCount == 0) {
+        uint32_t cores = std::thread::hardware_concurrency();
+        workerCount = (cores > 1)? cores - 1 : 1;
+    }
+
+    // Slot 0 is shared by every thread that is not a worker.
+    for(uint32_t i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for(uint32_t i = 1; i <= workerCount; ++i) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepLock);
+        stopping.store(true);
+    }
+
+    wakeCondition.notify_all();
+
+    for(size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+}
+
+void JobSystem::schedule(std::function<void()> work, JobCounter* counter, JobCounter* dependency) {
+    if(counter != nullptr) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Job job;
+    job.work = std::move(work);
+    job.counter = counter;
+
+    if(dependency != nullptr) {
+        std::lock_guard<std::mutex> lock(dependency->lock);
+
+        if(!dependency->isDone()) {
+            dependency->continuations.push_back(std::move(job));
+            return;
+        }
+    }
+
+    push(std::move(job));
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while(!counter.isDone()) {
+        if(!tryRunJob()) {
+            std::this_thread::yield();
+        }
+    }
+
+    // The job that finished the counter may still be releasing its lock, do not let the caller free it before then.
+    std::lock_guard<std::mutex> lock(counter.lock);
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& body) {
+    if(count == 0) {
+        return;
+    }
+
+    if(grainSize == 0) {
+        grainSize = 1;
+    }
+
+    if(count <= grainSize) {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter;
+
+    // Queue every range but the first, which the calling thread runs itself.
+    for(size_t begin = grainSize; begin < count; begin += grainSize) {
+        size_t end = (begin + grainSize < count)? begin + grainSize : count;
+        schedule([&body, begin, end]() { body(begin, end); }, &counter);
+    }
+
+    body(0, grainSize);
+    wait(counter);
+}
+
+uint32_t JobSystem::getThreadIndex() const {
+    return (threadOwner == this)? threadIndex : 0;
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    threadOwner = this;
+    threadIndex = index;
+    Profiler::setThreadName("Worker " + std::to_string(index));
+
+    while(true) {
+        if(tryRunJob()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepLock);
+        wakeCondition.wait(lock, [this]() {
+            return stopping.load() || queuedJobs.load() > 0;
+        });
+
+        if(stopping.load() && queuedJobs.load() == 0) {
+            return;
+        }
+    }
+}
+
+void JobSystem::push(Job&& job) {
+    WorkQueue& queue = *queues[getThreadIndex()];
+
+    {
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    queuedJobs.fetch_add(1);
+
+    // Taking the sleep lock makes sure a worker between checking for work and sleeping sees the new job.
+    { std::lock_guard<std::mutex> lock(sleepLock); }
+    wakeCondition.notify_one();
+}
+
+bool JobSystem::tryRunJob() {
+    uint32_t index = getThreadIndex();
+    Job job;
+
+    if(!popJob(index, job) && !stealJob(index, job)) {
+        return false;
+    }
+
+    queuedJobs.fetch_sub(1);
+    runJob(job);
+    return true;
+}
+
+bool JobSystem::popJob(uint32_t index, Job& job) {
+    WorkQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.lock);
+
+    if(queue.jobs.empty()) {
+        return false;
+    }
+
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::stealJob(uint32_t thief, Job& job) {
+    uint32_t queueCount = (uint32_t)queues.size();
+
+    for(uint32_t offset = 1; offset < queueCount; ++offset) {
+        WorkQueue& queue = *queues[(thief + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.lock);
+
+        if(!queue.jobs.empty()) {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::runJob(Job& job) {
+    {
+        // Scratch memory a job takes from the frame arena is freed when it finishes.
+        ArenaScope scratch;
+        job.work();
+    }
+
+    finishJob(job.counter);
+}
+
+void JobSystem::finishJob(JobCounter* counter) {
+    if(counter == nullptr) {
+        return;
+    }
+
+    std::vector<Job> ready;
+
+    {
+        std::lock_guard<std::mutex> lock(counter->lock);
+
+        if(counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(counter->continuations);
+        }
+    }
+
+    for(size_t i = 0; i < ready.size(); ++i) {
+        push(std::move(ready[i]));
+    }
+}
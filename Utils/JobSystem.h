@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+/**
+ * A unit of work and the counter to decrement once it has run
+ * */
+struct Job {
+    std::function<void()> work;
+    JobCounter* counter;
+};
+
+/**
+ * Counts the jobs that still have to finish before something can continue
+ * Pass one to JobSystem::schedule to track a job, then wait on it or use it as another job's dependency
+ * A counter must outlive its jobs and must not be reused until JobSystem::wait has returned for it
+ * */
+class JobCounter {
+    public:
+        JobCounter()
+            :pending(0)
+        {
+        }
+
+        ~JobCounter() {}
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        inline bool isDone() const {
+            return pending.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<int32_t> pending;
+
+        // Guards the zero transition and the jobs parked until it happens.
+        std::mutex lock;
+        std::vector<Job> continuations;
+};
+
+/**
+ * Work stealing job system
+ * Every worker owns a deque: it pushes and pops its own jobs at the back while idle workers steal from the front
+ * of the others, so fork/join work stays on the core that created it until someone runs out
+ * Threads that are not workers (the update thread) share slot 0 and help run jobs while they wait
+ * */
+class JobSystem {
+    public:
+        /**
+         * @param workerCount number of worker threads to spawn, 0 picks one less than the number of cores
+         * */
+        explicit JobSystem(uint32_t workerCount = 0);
+        ~JobSystem();
+
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        /**
+         * Queues a job
+         * @param counter incremented now and decremented once the job has run, may be null
+         * @param dependency the job is held back until this counter reaches zero, may be null
+         * */
+        void schedule(std::function<void()> work, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+        /**
+         * Runs queued jobs on the calling thread until the counter reaches zero
+         * */
+        void wait(JobCounter& counter);
+
+        /**
+         * Splits [0, count) into ranges of at most grainSize and runs body(begin, end) on each across every thread
+         * The calling thread takes part and the call returns once every range has finished
+         * */
+        void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)>& body);
+
+        /**
+         * Number of threads that can run jobs, including the slot shared by non-worker threads
+         * Use it to size per-thread scratch data indexed by getThreadIndex()
+         * */
+        inline uint32_t getThreadCount() const {
+            return (uint32_t)queues.size();
+        }
+
+        /**
+         * 1 to getThreadCount() - 1 on worker threads, 0 everywhere else
+         * */
+        uint32_t getThreadIndex() const;
+
+    private:
+        struct WorkQueue {
+            std::mutex lock;
+            std::deque<Job> jobs;
+        };
+
+        void workerLoop(uint32_t index);
+        void push(Job&& job);
+        bool tryRunJob();
+        bool popJob(uint32_t index, Job& job);
+        bool stealJob(uint32_t thief, Job& job);
+        void runJob(Job& job);
+        void finishJob(JobCounter* counter);
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> threads;
+
+        std::atomic<int32_t> queuedJobs;
+        std::atomic<bool> stopping;
+
+        // Idle workers sleep here until a job is pushed.
+        std::mutex sleepLock;
+        std::condition_variable wakeCondition;
+
+        // Which system spawned the current thread and its queue in that system.
+        static thread_local const JobSystem* threadOwner;
+        static thread_local uint32_t threadIndex;
+};
@@ -0,0 +1,99 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if(file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping == nullptr ? nullptr : MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    // The view keeps the mapping and the file open on its own.
+    if(mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+
+    CloseHandle(file);
+
+    if(view == nullptr) {
+        return false;
+    }
+
+    data = static_cast<const char*>(view);
+    size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::close() {
+    if(data != nullptr) {
+        UnmapViewOfFile(data);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY);
+
+    if(file < 0) {
+        return false;
+    }
+
+    struct stat status;
+
+    if(fstat(file, &status) != 0 || status.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps the file open on its own.
+    ::close(file);
+
+    if(view == MAP_FAILED) {
+        return false;
+    }
+
+    data = static_cast<const char*>(view);
+    size = (size_t)status.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if(data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+#endif
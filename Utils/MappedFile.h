@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A file mapped read only into memory
+ * Pages are read in by the OS the first time they are touched, so opening a file costs one system call no matter
+ * how large it is and reading it costs no copy through a stream buffer
+ * */
+class MappedFile {
+    public:
+        MappedFile()
+            :data(nullptr),
+            size(0)
+        {
+        }
+
+        ~MappedFile() {
+            close();
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * Maps the whole file, closing whatever was mapped before
+         * Empty files cannot be mapped and fail to open
+         * */
+        bool open(const std::string& path);
+
+        /**
+         * Unmaps the file. Pointers into it are left dangling
+         * */
+        void close();
+
+        bool isOpen() const {
+            return data != nullptr;
+        }
+
+        const char* getData() const {
+            return data;
+        }
+
+        size_t getSize() const {
+            return size;
+        }
+
+    private:
+        const char* data;
+        size_t size;
+};
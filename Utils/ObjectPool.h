@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Occupancy of a pool. Slots are only ever added, so capacity never shrinks
+ * */
+struct ObjectPoolStats {
+    size_t capacity;
+    size_t inUse;
+    size_t peakInUse;
+    size_t blocks;
+    uint64_t acquires;
+    uint64_t releases;
+};
+
+/**
+ * Hands out fixed size slots carved from large blocks, recycling freed slots through an intrusive free list
+ * Slots never move, so pointers stay valid until the slot is freed. When every slot is taken another block is added
+ * Safe to use from several threads: bullets are spawned from systems running on workers and freed on the update thread
+ * */
+class PoolAllocator {
+    public:
+        /**
+         * @param slotSize bytes per slot, rounded up to the alignment
+         * @param slotsPerBlock slots added each time the pool runs out
+         * @param initialSlots slots allocated up front
+         * */
+        PoolAllocator(size_t slotSize, size_t slotsPerBlock, size_t initialSlots = 0)
+            :slotSize(roundUp(slotSize < sizeof(FreeSlot) ? sizeof(FreeSlot) : slotSize)),
+            slotsPerBlock(slotsPerBlock > 0 ? slotsPerBlock : 1),
+            freeList(nullptr),
+            stats()
+        {
+            reserve(initialSlots);
+        }
+
+        ~PoolAllocator() {}
+
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        /**
+         * Takes a free slot, growing the pool if there is none
+         * */
+        void* allocate() {
+            std::lock_guard<std::mutex> guard(lock);
+
+            if(freeList == nullptr) {
+                addBlock(slotsPerBlock);
+            }
+
+            FreeSlot* slot = freeList;
+            freeList = slot->next;
+
+            stats.inUse++;
+            stats.acquires++;
+
+            if(stats.inUse > stats.peakInUse) {
+                stats.peakInUse = stats.inUse;
+            }
+
+            return slot;
+        }
+
+        /**
+         * Returns a slot taken from this pool
+         * */
+        void deallocate(void* memory) {
+            std::lock_guard<std::mutex> guard(lock);
+
+            FreeSlot* slot = static_cast<FreeSlot*>(memory);
+            slot->next = freeList;
+            freeList = slot;
+
+            stats.inUse--;
+            stats.releases++;
+        }
+
+        /**
+         * Grows the pool to at least count slots
+         * */
+        void reserve(size_t count) {
+            std::lock_guard<std::mutex> guard(lock);
+
+            if(count > stats.capacity) {
+                addBlock(count - stats.capacity);
+            }
+        }
+
+        size_t getSlotSize() const {
+            return slotSize;
+        }
+
+        ObjectPoolStats getStats() const {
+            std::lock_guard<std::mutex> guard(lock);
+            return stats;
+        }
+
+    private:
+        struct FreeSlot {
+            FreeSlot* next;
+        };
+
+        static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+        static size_t roundUp(size_t size) {
+            return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        }
+
+        /**
+         * Caller holds the lock
+         * */
+        void addBlock(size_t count) {
+            // operator new[] on unsigned char only guarantees the default new alignment, which is max_align_t.
+            std::unique_ptr<unsigned char[]> block(new unsigned char[slotSize * count]);
+
+            // Thread the new slots onto the free list in address order.
+            for(size_t i = count; i > 0; --i) {
+                FreeSlot* slot = reinterpret_cast<FreeSlot*>(block.get() + slotSize * (i - 1));
+                slot->next = freeList;
+                freeList = slot;
+            }
+
+            blocks.push_back(std::move(block));
+            stats.capacity += count;
+            stats.blocks = blocks.size();
+        }
+
+        const size_t slotSize;
+        const size_t slotsPerBlock;
+
+        mutable std::mutex lock;
+        std::vector<std::unique_ptr<unsigned char[]>> blocks;
+        FreeSlot* freeList;
+        ObjectPoolStats stats;
+};
+
+/**
+ * Typed pool: constructs objects in pooled slots and destroys them back into the pool
+ * For objects the pool hands out and takes back itself. Entities use EntityPool, which lets the scene free them
+ * */
+template<typename T>
+class ObjectPool {
+    public:
+        ObjectPool(size_t initialCapacity, size_t growBy = 0)
+            :allocator(sizeof(T), growBy > 0 ? growBy : (initialCapacity > 0 ? initialCapacity : 64), initialCapacity)
+        {
+            static_assert(alignof(T) <= alignof(std::max_align_t), "ObjectPool does not support over-aligned types");
+        }
+
+        template<typename... Args>
+        T* acquire(Args&&... args) {
+            void* memory = allocator.allocate();
+            return new(memory) T(std::forward<Args>(args)...);
+        }
+
+        void release(T* object) {
+            if(object == nullptr) {
+                return;
+            }
+
+            object->~T();
+            allocator.deallocate(object);
+        }
+
+        void reserve(size_t count) {
+            allocator.reserve(count);
+        }
+
+        ObjectPoolStats getStats() const {
+            return allocator.getStats();
+        }
+
+    private:
+        PoolAllocator allocator;
+};
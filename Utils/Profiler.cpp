@@ -0,0 +1,303 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * Events recorded by one thread
+ * Only the owning thread writes. count is published with release so readers on other threads
+ * see complete events up to it
+ * */
+struct Profiler::ThreadBuffer {
+    ThreadBuffer(uint32_t threadId)
+        :threadId(threadId),
+        count(0),
+        generation(0),
+        dropped(0)
+    {
+        for(uint32_t i = 0; i < PROFILER_MAX_DEPTH; ++i) {
+            childNanos[i] = 0;
+        }
+    }
+
+    uint32_t threadId;
+    std::string threadName;
+    // Allocated on the first event so naming a thread that never records stays cheap.
+    std::vector<ProfileEvent> events;
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> generation;
+    std::atomic<uint64_t> dropped;
+
+    // Time spent in finished children of the scope open at each depth. Owner only.
+    uint64_t childNanos[PROFILER_MAX_DEPTH];
+};
+
+namespace {
+    // Buffers stay alive after their thread exits so its events can still be exported.
+    std::mutex registryLock;
+    std::vector<std::unique_ptr<Profiler::ThreadBuffer>>& getBuffers() {
+        static std::vector<std::unique_ptr<Profiler::ThreadBuffer>> buffers;
+        return buffers;
+    }
+
+    std::mutex namesLock;
+    std::deque<std::string> names;
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    void writeJsonString(std::ostream& output, const char* value) {
+        output << '"';
+
+        for(const char* c = value; *c != '\0'; ++c) {
+            switch(*c) {
+                case '"': output << "\\\""; break;
+                case '\\': output << "\\\\"; break;
+                case '\n': output << "\\n"; break;
+                case '\t': output << "\\t"; break;
+                default:
+                    if((unsigned char)*c >= 0x20) {
+                        output << *c;
+                    }
+                    break;
+            }
+        }
+
+        output << '"';
+    }
+}
+
+std::atomic<bool> Profiler::enabled(false);
+std::atomic<uint32_t> Profiler::generation(1);
+thread_local Profiler::ThreadBuffer* Profiler::threadBuffer = nullptr;
+thread_local uint32_t Profiler::threadDepth = 0;
+
+void Profiler::setEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+void Profiler::clear() {
+    generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    std::lock_guard<std::mutex> guard(registryLock);
+    buffer.threadName = name;
+}
+
+const char* Profiler::internName(const std::string& name) {
+    std::lock_guard<std::mutex> guard(namesLock);
+
+    for(size_t i = 0; i < names.size(); ++i) {
+        if(names[i] == name) {
+            return names[i].c_str();
+        }
+    }
+
+    names.push_back(name);
+    return names.back().c_str();
+}
+
+uint64_t Profiler::now() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+Profiler::ThreadBuffer& Profiler::getThreadBuffer() {
+    if(threadBuffer == nullptr) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        std::vector<std::unique_ptr<ThreadBuffer>>& buffers = getBuffers();
+
+        buffers.push_back(std::make_unique<ThreadBuffer>((uint32_t)buffers.size()));
+        threadBuffer = buffers.back().get();
+    }
+
+    return *threadBuffer;
+}
+
+void Profiler::record(const char* name, uint64_t startNanos, uint64_t endNanos, uint32_t depth) {
+    ThreadBuffer& buffer = getThreadBuffer();
+    uint32_t currentGeneration = generation.load(std::memory_order_acquire);
+
+    // The profiler was cleared since this thread last recorded, start over.
+    if(buffer.generation.load(std::memory_order_relaxed) != currentGeneration) {
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.generation.store(currentGeneration, std::memory_order_release);
+    }
+
+    uint64_t duration = endNanos - startNanos;
+    uint64_t self = duration;
+
+    if(depth < PROFILER_MAX_DEPTH) {
+        uint64_t children = buffer.childNanos[depth];
+        self = (children < duration)? duration - children : 0;
+        buffer.childNanos[depth] = 0;
+
+        if(depth > 0) {
+            buffer.childNanos[depth - 1] += duration;
+        }
+    }
+
+    if(buffer.events.empty()) {
+        buffer.events.resize(PROFILER_EVENTS_PER_THREAD);
+    }
+
+    uint32_t index = buffer.count.load(std::memory_order_relaxed);
+
+    if(index >= buffer.events.size()) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ProfileEvent& event = buffer.events[index];
+    event.name = name;
+    event.startNanos = startNanos;
+    event.durationNanos = duration;
+    event.selfNanos = self;
+    event.depth = depth;
+
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+namespace {
+    /**
+     * Calls visit(buffer, count) for every buffer holding events from the current generation
+     * */
+    template<typename Visitor>
+    void forEachBuffer(uint32_t currentGeneration, Visitor visit) {
+        std::lock_guard<std::mutex> guard(registryLock);
+        std::vector<std::unique_ptr<Profiler::ThreadBuffer>>& buffers = getBuffers();
+
+        for(size_t i = 0; i < buffers.size(); ++i) {
+            Profiler::ThreadBuffer& buffer = *buffers[i];
+
+            if(buffer.generation.load(std::memory_order_acquire) != currentGeneration) {
+                continue;
+            }
+
+            visit(buffer, buffer.count.load(std::memory_order_acquire));
+        }
+    }
+}
+
+std::vector<ProfileSummary> Profiler::summarize() {
+    // Keyed by text, the same literal can have a different address in every translation unit.
+    std::unordered_map<std::string, ProfileSummary> byName;
+    std::vector<ProfileSummary> summaries;
+
+    forEachBuffer(generation.load(std::memory_order_acquire), [&](ThreadBuffer& buffer, uint32_t count) {
+        for(uint32_t i = 0; i < count; ++i) {
+            const ProfileEvent& event = buffer.events[i];
+            auto found = byName.find(event.name);
+
+            if(found == byName.end()) {
+                ProfileSummary summary = { event.name, 0, 0, 0, 0 };
+                found = byName.emplace(event.name, summary).first;
+            }
+
+            ProfileSummary& summary = found->second;
+            summary.calls++;
+            summary.totalNanos += event.durationNanos;
+            summary.selfNanos += event.selfNanos;
+            summary.maxNanos = std::max(summary.maxNanos, event.durationNanos);
+        }
+    });
+
+    for(auto& entry : byName) {
+        summaries.push_back(entry.second);
+    }
+
+    std::sort(summaries.begin(), summaries.end(), [](const ProfileSummary& a, const ProfileSummary& b) {
+        return a.totalNanos > b.totalNanos;
+    });
+
+    return summaries;
+}
+
+void Profiler::writeSummary(std::ostream& output) {
+    std::vector<ProfileSummary> summaries = summarize();
+
+    output << std::left << std::setw(40) << "scope" << std::right
+        << std::setw(10) << "calls"
+        << std::setw(14) << "total ms"
+        << std::setw(14) << "self ms"
+        << std::setw(12) << "avg ms"
+        << std::setw(12) << "max ms" << '\n';
+
+    output << std::fixed << std::setprecision(3);
+
+    for(size_t i = 0; i < summaries.size(); ++i) {
+        const ProfileSummary& summary = summaries[i];
+
+        output << std::left << std::setw(40) << summary.name << std::right
+            << std::setw(10) << summary.calls
+            << std::setw(14) << summary.totalNanos / 1e6
+            << std::setw(14) << summary.selfNanos / 1e6
+            << std::setw(12) << summary.totalNanos / 1e6 / summary.calls
+            << std::setw(12) << summary.maxNanos / 1e6 << '\n';
+    }
+
+    uint64_t dropped = getDroppedCount();
+    if(dropped != 0) {
+        output << dropped << " events dropped, buffers were full\n";
+    }
+}
+
+bool Profiler::exportChromeTrace(const std::string& path) {
+    std::ofstream output(path, std::ios::out | std::ios::trunc);
+
+    if(!output.is_open()) {
+        return false;
+    }
+
+    writeChromeTrace(output);
+    return output.good();
+}
+
+void Profiler::writeChromeTrace(std::ostream& output) {
+    bool first = true;
+
+    output << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    output << std::fixed << std::setprecision(3);
+
+    forEachBuffer(generation.load(std::memory_order_acquire), [&](ThreadBuffer& buffer, uint32_t count) {
+        if(!buffer.threadName.empty()) {
+            output << (first? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer.threadId
+                << ",\"args\":{\"name\":";
+            writeJsonString(output, buffer.threadName.c_str());
+            output << "}}";
+            first = false;
+        }
+
+        // Trace event times are in microseconds.
+        for(uint32_t i = 0; i < count; ++i) {
+            const ProfileEvent& event = buffer.events[i];
+
+            output << (first? "" : ",") << "\n{\"name\":";
+            writeJsonString(output, event.name);
+            output << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer.threadId
+                << ",\"ts\":" << event.startNanos / 1e3
+                << ",\"dur\":" << event.durationNanos / 1e3 << '}';
+            first = false;
+        }
+    });
+
+    output << "\n]}\n";
+}
+
+uint64_t Profiler::getDroppedCount() {
+    uint64_t dropped = 0;
+
+    forEachBuffer(generation.load(std::memory_order_acquire), [&](ThreadBuffer& buffer, uint32_t) {
+        dropped += buffer.dropped.load(std::memory_order_relaxed);
+    });
+
+    return dropped;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Scoped CPU profiling markers
+ * PROFILE_SCOPE("name") times the enclosing scope, nested scopes on the same thread form a hierarchy
+ * Names must outlive the capture: pass string literals, or keep the pointer from Profiler::internName
+ * Define DISABLE_PROFILER to compile every marker out, otherwise markers cost one relaxed load while
+ * the profiler is disabled at runtime
+ * */
+#ifndef DISABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
+
+// Events kept per thread between clears. Once full, further events on that thread are dropped and counted.
+#define PROFILER_EVENTS_PER_THREAD 65536
+
+// Deepest nesting tracked for self time. Deeper scopes are still recorded.
+#define PROFILER_MAX_DEPTH 64
+
+/**
+ * One finished scope
+ * */
+struct ProfileEvent {
+    const char* name;
+    uint64_t startNanos;
+    uint64_t durationNanos;
+
+    // Duration minus the time spent in scopes nested directly inside this one.
+    uint64_t selfNanos;
+    uint32_t depth;
+};
+
+/**
+ * Totals for every scope sharing a name, across all threads
+ * */
+struct ProfileSummary {
+    const char* name;
+    uint64_t calls;
+    uint64_t totalNanos;
+    uint64_t selfNanos;
+    uint64_t maxNanos;
+};
+
+/**
+ * Collects the events recorded by PROFILE_SCOPE
+ * Every thread writes to its own buffer with no locks: only registering a thread's buffer the first time it
+ * records takes a mutex. Reading (summarize, export) may run while other threads keep recording, it sees
+ * every event that finished before the read started. Do not clear while reading
+ * */
+class Profiler {
+    public:
+        /**
+         * Starts or stops recording. Scopes already open when the profiler is disabled still record
+         * */
+        static void setEnabled(bool enabled);
+
+        static inline bool isEnabled() {
+            return enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Drops every recorded event. Threads discard their old events the next time they record
+         * */
+        static void clear();
+
+        /**
+         * Names the calling thread in exported traces
+         * */
+        static void setThreadName(const std::string& name);
+
+        /**
+         * Returns a pointer to a copy of the name that lives as long as the program
+         * Use for scope names built at runtime. Takes a lock, so intern once and keep the pointer
+         * */
+        static const char* internName(const std::string& name);
+
+        /**
+         * Totals per scope name, most expensive first
+         * */
+        static std::vector<ProfileSummary> summarize();
+
+        /**
+         * Writes the summary as a table, times in milliseconds
+         * */
+        static void writeSummary(std::ostream& output);
+
+        /**
+         * Writes every event in Chrome trace event format, viewable in chrome://tracing or Perfetto
+         * @return false if the file could not be written
+         * */
+        static bool exportChromeTrace(const std::string& path);
+        static void writeChromeTrace(std::ostream& output);
+
+        /**
+         * Number of events dropped because a thread's buffer was full
+         * */
+        static uint64_t getDroppedCount();
+
+        /**
+         * Nanoseconds since the profiler's epoch, the time base of every event
+         * */
+        static uint64_t now();
+
+        // Per-thread event storage, defined in Profiler.cpp.
+        struct ThreadBuffer;
+
+    private:
+        friend class ProfileScope;
+
+        /**
+         * Records a finished scope on the calling thread
+         * */
+        static void record(const char* name, uint64_t startNanos, uint64_t endNanos, uint32_t depth);
+
+        static ThreadBuffer& getThreadBuffer();
+
+        static std::atomic<bool> enabled;
+
+        // Bumped by clear(). A buffer recorded under an older generation is treated as empty.
+        static std::atomic<uint32_t> generation;
+
+        static thread_local ThreadBuffer* threadBuffer;
+        static thread_local uint32_t threadDepth;
+};
+
+/**
+ * Times its own lifetime. Use through PROFILE_SCOPE
+ * */
+class ProfileScope {
+    public:
+        explicit ProfileScope(const char* name)
+            :name(name),
+            startNanos(0),
+            active(Profiler::isEnabled())
+        {
+            if(active) {
+                depth = Profiler::threadDepth++;
+                startNanos = Profiler::now();
+            }
+        }
+
+        ~ProfileScope() {
+            if(active) {
+                Profiler::threadDepth--;
+                Profiler::record(name, startNanos, Profiler::now(), depth);
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* name;
+        uint64_t startNanos;
+        uint32_t depth;
+        bool active;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Lock-free single producer, single consumer ring buffer with a fixed capacity
+ * One thread pushes, one thread pops, neither ever blocks: push fails when the ring is full and pop fails when it is empty
+ * The two indexes live on separate cache lines so the threads do not fight over one line
+ * Capacity must be a power of two
+ * */
+template<typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    public:
+        SpscQueue()
+            :head(0),
+            tail(0)
+        {
+        }
+
+        ~SpscQueue() {}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /**
+         * Producer only. Copies the value into the ring
+         * @return false if the ring is full, the value is not queued
+         * */
+        inline bool push(const T& value) {
+            size_t writeIndex = tail.load(std::memory_order_relaxed);
+
+            if(writeIndex - head.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+
+            slots[writeIndex & MASK] = value;
+            tail.store(writeIndex + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Consumer only. Takes the oldest value
+         * @return false if the ring is empty
+         * */
+        inline bool pop(T& value) {
+            size_t readIndex = head.load(std::memory_order_relaxed);
+
+            if(readIndex == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            value = slots[readIndex & MASK];
+            head.store(readIndex + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * Number of queued values. Exact only on the producer or consumer thread while the other is idle
+         * */
+        inline size_t size() const {
+            return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+        }
+
+        static constexpr size_t capacity() {
+            return Capacity;
+        }
+
+    private:
+        static constexpr size_t MASK = Capacity - 1;
+
+        // Next slot to read, written by the consumer.
+        alignas(64) std::atomic<size_t> head;
+
+        // Next slot to write, written by the producer.
+        alignas(64) std::atomic<size_t> tail;
+
+        alignas(64) T slots[Capacity];
+};
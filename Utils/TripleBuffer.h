@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Lock-free single producer, single consumer triple buffer
+ * The producer fills the write buffer and publishes it, the consumer picks up the most recently published buffer
+ * Neither side ever waits on the other: the producer never blocks and the consumer simply keeps its current buffer
+ * until a newer one has been published
+ * Buffers are reused, so anything with capacity (vectors) stops allocating once it reaches a steady size
+ * */
+template<typename T>
+class TripleBuffer {
+    public:
+        TripleBuffer()
+            :writeIndex(0),
+            shared(1),
+            readIndex(2)
+        {
+        }
+
+        ~TripleBuffer() {}
+
+        /**
+         * The buffer owned by the producer. Only valid until the next call to publish()
+         * */
+        inline T& getWriteBuffer() {
+            return buffers[writeIndex];
+        }
+
+        /**
+         * Hands the write buffer to the consumer and takes back the buffer it is not using
+         * */
+        inline void publish() {
+            uint8_t previous = shared.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+            writeIndex = previous & INDEX_MASK;
+        }
+
+        /**
+         * Swaps in the latest published buffer if there is one
+         * @return true if the read buffer changed
+         * */
+        inline bool consume() {
+            if((shared.load(std::memory_order_relaxed) & FRESH_BIT) == 0) {
+                return false;
+            }
+
+            uint8_t previous = shared.exchange(readIndex, std::memory_order_acq_rel);
+            readIndex = previous & INDEX_MASK;
+            return true;
+        }
+
+        /**
+         * The buffer owned by the consumer. Only valid until the next call to consume()
+         * */
+        inline const T& getReadBuffer() const {
+            return buffers[readIndex];
+        }
+
+    private:
+        static constexpr uint8_t INDEX_MASK = 0x3;
+        static constexpr uint8_t FRESH_BIT = 0x4;
+
+        T buffers[3];
+
+        // Only touched by the producer.
+        uint8_t writeIndex;
+
+        // Index of the buffer in flight between the two threads, plus whether it is newer than the read buffer.
+        std::atomic<uint8_t> shared;
+
+        // Only touched by the consumer.
+        uint8_t readIndex;
+};